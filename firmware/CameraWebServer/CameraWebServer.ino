@@ -1,5 +1,6 @@
 // 카메라 관련 기능을 사용하기 위한 헤더 파일 포함
 #include "esp_camera.h"
+#include "esp_timer.h"
 
 // WiFi 기능을 사용하기 위한 헤더 파일 포함
 #include <WiFi.h>
@@ -8,18 +9,16 @@
 #define CAMERA_MODEL_AI_THINKER
 #include "camera_pins.h"
 
-#include "DHT.h"
-#define DHTPIN  15          // DHT22 신호선 연결 핀
-#define DHTTYPE DHT22
-DHT dht(DHTPIN, DHTTYPE);
-// 캐시된 센서 값과 갱신 시간
-float cachedHumidity   = NAN;
-float cachedTemperature = NAN;
-int   cachedFlame = -1;
-unsigned long dhtLastRead = 0;
-const unsigned long DHT_INTERVAL = 2000; // 2초
+#include "dht_sensor.h"
+#include "flame_sensor.h"
+#include "sensor_snapshot.h"  // 핸들러가 읽는 센서 값 (dht 태스크와 불꽃 인터럽트가 갱신)
+#include "sensor_history.h"   // /history 용 센서 시계열 기록
+#include "wifi_link.h"        // 캐시한 채널/BSSID 로 빠른 재접속
+#include "boot_stats.h"       // /boot 용 부팅 단계 시각
+#include "trace.h"            // /trace 용 구간 타임라인
+#define DHTPIN  15          // DHT22 신호선 연결 핀 (RMT 로 읽음, dht_sensor.h 참고)
 
-#define FLAME_PIN 14 // Flame sensor 신호선 연결 핀
+#define FLAME_PIN 14 // Flame sensor 신호선 연결 핀 (에지 인터럽트로 읽음, flame_sensor.h 참고)
 
 // WiFi credentials are loaded from wifi_config.h
 #include "wifi_config.h"
@@ -41,6 +40,13 @@ void setup() {
   Serial.begin(115200);
   Serial.setDebugOutput(true);
   Serial.println();
+  // 구간 기록은 부팅 단계부터 남기도록 가장 먼저 시작한다.
+  trace_init();
+
+  // WiFi 연결 시작 (연결은 별도 태스크가 기다리고, 그동안 아래 초기화를 진행한다)
+  if (wifi_link_begin(ssid, password) != ESP_OK) {
+    Serial.println("WiFi task start failed");
+  }
 
   // 카메라 설정을 위한 구조체 변수 생성
   camera_config_t config;
@@ -67,9 +73,10 @@ void setup() {
   config.pin_pwdn = PWDN_GPIO_NUM;
   config.pin_reset = RESET_GPIO_NUM;
 
-  // 불꽃 센서 입력 핀 설정
-  pinMode(FLAME_PIN, INPUT);
-  cachedFlame = digitalRead(FLAME_PIN);
+  // 불꽃 센서 입력 핀 설정 및 에지 인터럽트 등록
+  if (flame_sensor_init(FLAME_PIN, sensor_snapshot_update_flame) != ESP_OK) {
+    Serial.println("Flame sensor init failed");
+  }
   
   // XCLK 주파수 설정 (20MHz)
   config.xclk_freq_hz = 20000000;
@@ -105,12 +112,14 @@ void setup() {
   }
 
   // 카메라 초기화
+  int64_t stage_start = esp_timer_get_time();
   esp_err_t err = esp_camera_init(&config);
   if (err != ESP_OK) {
     // 초기화 실패 시 에러 코드 출력 후 함수 종료
     Serial.printf("Camera init failed with error 0x%x", err);
     return;
   }
+  boot_mark(BOOT_CAMERA, stage_start);
 
   // 카메라 센서 정보 획득
   sensor_t *s = esp_camera_sensor_get();
@@ -125,43 +134,31 @@ void setup() {
   setupLedFlash(LED_GPIO_NUM);
 #endif
 
-  // WiFi 연결 시작
-  WiFi.begin(ssid, password);
-  // WiFi 슬립 모드 비활성화 (연결 안정성 향상)
-  WiFi.setSleep(false);
-
-  // WiFi 연결 상태를 확인하며 연결될 때까지 대기
-  Serial.print("WiFi connecting");
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
+  // DHT22 는 전용 태스크가 RMT 로 읽는다.
+  stage_start = esp_timer_get_time();
+  if (dht_sensor_start(DHTPIN, sensor_snapshot_update_dht, tskNO_AFFINITY) != ESP_OK) {
+    Serial.println("DHT sensor init failed");
   }
-  Serial.println("");
-  Serial.println("WiFi connected");
-
-  dht.begin();
+  if (sensor_history_start() != ESP_OK) {
+    Serial.println("Sensor history init failed");
+  }
+  boot_mark(BOOT_SENSORS, stage_start);
 
-  // 카메라 서버 실행 함수 호출 (웹 인터페이스 등)
+  // 카메라 서버 실행 함수 호출 (웹 인터페이스 등). 접속 주소는 WiFi 가 연결되면 wifi_link 가 출력한다.
+  stage_start = esp_timer_get_time();
   startCameraServer();
-
-  // 연결된 IP 주소를 출력하여 접속 방법 안내
-  Serial.print("Camera Ready! Use 'http://");
-  Serial.print(WiFi.localIP());
-  Serial.println("' to connect");
+  boot_mark(BOOT_SERVER, stage_start);
+
+  // 첫 프레임까지의 시간을 남긴다 (해상도 변경 직후의 프레임이라도 센서가 동작함을 확인하는 용도).
+  stage_start = esp_timer_get_time();
+  camera_fb_t *fb = esp_camera_fb_get();
+  if (fb) {
+    boot_mark(BOOT_FIRST_FRAME, stage_start);
+    esp_camera_fb_return(fb);
+  }
 }
 
 void loop() {
-   unsigned long now = millis();
-  if (now - dhtLastRead >= DHT_INTERVAL) {
-    float h = dht.readHumidity();
-    float t = dht.readTemperature();
-    if (!isnan(h) && !isnan(t)) {
-      cachedHumidity = h;
-      cachedTemperature = t;
-    }
-    dhtLastRead = now;
-  }
-  // flame 센서 값도 주기적으로 갱신한다.
-  cachedFlame = digitalRead(FLAME_PIN);
-  delay(10);  // 다른 작업에 CPU를 양보
+  // 센서는 dht 태스크와 불꽃 인터럽트가 처리하므로 loopTask 는 더 할 일이 없다.
+  vTaskDelete(NULL);
 }
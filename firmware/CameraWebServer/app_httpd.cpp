@@ -17,9 +17,31 @@
 #include "sdkconfig.h"          // SDK 설정 관련 헤더
 #include "camera_index.h"       // 웹 서버용 HTML 인덱스 페이지 데이터 포함
 #include <Arduino.h>    // isnan(), String 등 Arduino 함수들을 사용하기 위해
-#include "DHT.h"        // DHT 클래스 선언
-extern DHT dht;         // CameraWebServer.ino 에 정의된 전역 DHT 인스턴스를 참조
-#define FLAME_PIN 14    // flame 핀 정의
+#include "frame_broadcaster.h"  // /stream 클라이언트들이 공유하는 캡처 태스크
+#include "rate_ctrl.h"          // 전송 상태에 따른 품질/해상도 자동 조절
+#include "flame_sensor.h"       // 불꽃 센서 에지 인터럽트와 에지 기록
+#include "sensor_snapshot.h"    // 센서 값 스냅샷 (잠금 없이 일관되게 읽음)
+#include "sensor_history.h"     // 센서 시계열 기록 (/history)
+#include "boot_stats.h"         // 부팅 단계 시각 (/boot)
+#include "wifi_link.h"          // WiFi 접속 방식 (/boot)
+#include "esp_system.h"         // esp_reset_reason()
+#include "trace.h"              // 구간 타임라인 (/trace)
+#include "metrics.h"            // 성능 지표 (/metrics)
+#include "conv_pool.h"          // 변환 버퍼 풀 (JPEG 변환에 malloc 을 쓰지 않음)
+#include "bmp_stream.h"         // /bmp 를 띠 단위로 변환하며 전송
+#include "capture_cache.h"      // /capture 요청 합치기와 최근 프레임 캐시
+#include "burst.h"              // /burst 연속 캡처
+#include "event_clip.h"         // 사건 전 영상 기록 (/event)
+#include "frame_analysis.h"     // 온보드 불꽃 후보 분석 (/fire)
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>            // writev (스트림 파트를 한 번에 전송)
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>        // TCP_NODELAY
 
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"      // ESP32 Arduino 로그 함수 제공 (정보 출력)
@@ -28,20 +50,21 @@ extern DHT dht;         // CameraWebServer.ino 에 정의된 전역 DHT 인스
 // LED FLASH 기능을 활성화 (0: 비활성, 1: 활성)
 #define CONFIG_LED_ILLUMINATOR_ENABLED 0
 
-// HTTP 응답을 위한 JPEG 청크 정보를 저장하는 구조체
-typedef struct {
-  httpd_req_t *req;  // HTTP 요청 핸들
-  size_t len;        // 전송한 데이터 길이
-} jpg_chunking_t;
-
 // 스트림용 경계(boundary) 문자열과 콘텐츠 타입 등 설정
 #define PART_BOUNDARY "123456789000000000000987654321"
 static const char *_STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
 static const char *_STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
 static const char *_STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\nX-Timestamp: %d.%06d\r\n\r\n";
+// /burst 와 /event/clip 은 같은 경계로 나눈 multipart/mixed 응답 하나로 보낸다.
+static const char *_MULTI_CONTENT_TYPE = "multipart/mixed;boundary=" PART_BOUNDARY;
+static const char *_MULTI_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\nX-Timestamp: %lld.%06ld\r\nX-Index: %d\r\n\r\n";
+
+// 스트림 서버, 브로드캐스터, 스트림 전송 태스크를 고정할 코어.
+// Arduino-ESP32 는 WiFi/LwIP 태스크를 코어 0 에 두므로 스트림 쪽은 코어 1 을 쓴다.
+#define STREAM_CORE 1
 
 // HTTP 서버 핸들러 변수
-httpd_handle_t stream_httpd = NULL;   // 스트림 서버
+httpd_handle_t stream_httpd = NULL;   // 스트림 서버 (포트 81, /stream 전용)
 httpd_handle_t camera_httpd = NULL;   // 카메라 제어 서버
 
 // 값 필터링을 위한 구조체 (프레임 간 시간 평균 계산 등에 사용)
@@ -53,8 +76,7 @@ typedef struct {
   int *values;    // 샘플 값을 저장할 배열
 } ra_filter_t;
 
-static ra_filter_t ra_filter;   // 전역 필터 변수
-
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
 // 필터 초기화 함수: sample_size 만큼의 배열을 할당하고 0으로 초기화
 static ra_filter_t *ra_filter_init(ra_filter_t *filter, size_t sample_size) {
   memset(filter, 0, sizeof(ra_filter_t));
@@ -67,7 +89,6 @@ static ra_filter_t *ra_filter_init(ra_filter_t *filter, size_t sample_size) {
   return filter;
 }
 
-#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
 // 필터를 이용해 새 값(value)을 추가하고 평균값을 계산한다.
 static int ra_filter_run(ra_filter_t *filter, int value) {
   if (!filter->values) {
@@ -91,6 +112,24 @@ static int ra_filter_run(ra_filter_t *filter, int value) {
 }
 #endif
 
+// 프레임을 하나 받되, /control 일괄 설정 전이나 도중에 찍힌 프레임이면 버리고 다시 받는다.
+static camera_fb_t *camera_fb_get_settled(void) {
+  int64_t t0 = esp_timer_get_time();
+  camera_fb_t *fb = esp_camera_fb_get();
+  for (int i = 0; fb && i < 2 && broadcast_frame_stale(&fb->timestamp); i++) {
+    esp_camera_fb_return(fb);
+    fb = esp_camera_fb_get();
+  }
+  trace_span("fb_get", t0, fb ? fb->len : 0);
+  metrics_observe(METRIC_CAPTURE_WAIT, esp_timer_get_time() - t0);
+  return fb;
+}
+
+// bmp_stream() 이 넘기는 조각을 HTTP 청크로 전송
+static esp_err_t bmp_send_chunk(void *arg, const uint8_t *data, size_t len) {
+  return httpd_resp_send_chunk((httpd_req_t *)arg, (const char *)data, len);
+}
+
 // BMP 포맷 이미지를 HTTP 응답으로 전송하는 핸들러 함수
 static esp_err_t bmp_handler(httpd_req_t *req) {
   camera_fb_t *fb = NULL;
@@ -99,7 +138,7 @@ static esp_err_t bmp_handler(httpd_req_t *req) {
   uint64_t fr_start = esp_timer_get_time();   // 처리 시작 시간 기록
 #endif
   // 카메라에서 프레임 버퍼 캡처
-  fb = esp_camera_fb_get();
+  fb = camera_fb_get_settled();
   if (!fb) {
     log_e("Camera capture failed");
     httpd_resp_send_500(req);
@@ -115,19 +154,18 @@ static esp_err_t bmp_handler(httpd_req_t *req) {
   snprintf(ts, 32, "%lld.%06ld", fb->timestamp.tv_sec, fb->timestamp.tv_usec);
   httpd_resp_set_hdr(req, "X-Timestamp", (const char *)ts);
 
-  // BMP 포맷으로 변환
-  uint8_t *buf = NULL;
+  // 헤더부터 띠 단위로 변환하면서 곧바로 청크로 전송
+  int64_t t0 = esp_timer_get_time();
   size_t buf_len = 0;
-  bool converted = frame2bmp(fb, &buf, &buf_len);
+  res = bmp_stream(fb, bmp_send_chunk, req, &buf_len);
+  trace_span("frame2bmp_send", t0, buf_len);
   esp_camera_fb_return(fb);
-  if (!converted) {
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(req, NULL, 0);
+  } else {
+    // 헤더가 이미 나갔을 수 있으므로 500 대신 연결을 끊는다.
     log_e("BMP Conversion failed");
-    httpd_resp_send_500(req);
-    return ESP_FAIL;
   }
-  // 변환된 이미지 데이터를 HTTP 응답으로 전송
-  res = httpd_resp_send(req, (const char *)buf, buf_len);
-  free(buf);
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
   uint64_t fr_end = esp_timer_get_time();   // 처리 종료 시간 기록
   log_i("BMP: %llums, %uB", (uint64_t)((fr_end - fr_start) / 1000), buf_len);
@@ -135,66 +173,79 @@ static esp_err_t bmp_handler(httpd_req_t *req) {
   return res;
 }
 
-// JPEG 인코딩 시 콜백 함수: 인코딩된 데이터를 HTTP 청크 응답으로 전송
-static size_t jpg_encode_stream(void *arg, size_t index, const void *data, size_t len) {
-  jpg_chunking_t *j = (jpg_chunking_t *)arg;
-  if (!index) {
-    j->len = 0;
-  }
-  if (httpd_resp_send_chunk(j->req, (const char *)data, len) != ESP_OK) {
-    return 0;
-  }
-  j->len += len;
-  return len;
-}
+// /capture 를 처리하는 작업 태스크 수와 대기열 길이.
+// httpd 태스크는 요청을 넘기기만 하므로 동시에 들어온 요청이 겹쳐 capture_cache 에서 한 번의 캡처로 합쳐진다.
+#define CAPTURE_WORKERS 3
+#define CAPTURE_QUEUE   8
 
-// 단일 캡처(정지된 이미지)를 처리하여 JPEG 이미지로 HTTP 응답 전송하는 핸들러
-static esp_err_t capture_handler(httpd_req_t *req) {
-  camera_fb_t *fb = NULL;
+typedef struct {
+  httpd_req_t *req;  // httpd_req_async_handler_begin() 으로 떼어 낸 요청
+  int64_t start;     // 요청을 받은 시각
+} capture_job_t;
+
+static capture_job_t capture_jobs[CAPTURE_QUEUE];
+static int capture_head, capture_count;         // capture_lock 으로 보호
+static SemaphoreHandle_t capture_lock = NULL;
+static SemaphoreHandle_t capture_work = NULL;   // 대기열에 넣을 때마다 give
+static int capture_metric = -1;                 // 작업 태스크에서 끝난 시각까지 재므로 register_timed 를 쓰지 않음
+
+// 단일 캡처(정지된 이미지)를 JPEG 이미지로 HTTP 응답 전송
+// ?max_age=<ms> 이내에 찍은 프레임이 캐시에 있으면 새로 캡처하지 않는다 (기본 0: 항상 새 프레임).
+// 동시에 들어온 요청은 한 번의 캡처를 나눠 받고, If-None-Match 가 보낼 프레임의 ETag 와 같으면 304.
+static esp_err_t capture_send(httpd_req_t *req) {
   esp_err_t res = ESP_OK;
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
   int64_t fr_start = esp_timer_get_time();
 #endif
+  uint32_t max_age = 0;
+  char query[32];
+  char value[12];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "max_age", value, sizeof(value)) == ESP_OK) {
+    max_age = strtoul(value, NULL, 10);
+  }
 
-fb = esp_camera_fb_get();  //바로 프레임 캡처
-
-
-  if (!fb) {
-    log_e("Camera capture failed");
+  capture_frame_t *f = capture_cache_get(max_age);
+  if (!f) {
     httpd_resp_send_500(req);
     return ESP_FAIL;
   }
 
-  // HTTP 응답 헤더 설정 (JPEG 이미지)
-  httpd_resp_set_type(req, "image/jpeg");
-  httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  // ETag 는 캡처 시각이므로 같은 프레임이면 같다.
+  char etag[40];
+  snprintf(etag, sizeof(etag), "\"%lld.%06ld\"", (long long)f->timestamp.tv_sec, (long)f->timestamp.tv_usec);
+  char inm[64];
+  bool not_modified = httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+                      (strstr(inm, etag) || !strcmp(inm, "*"));
 
+  httpd_resp_set_hdr(req, "ETag", etag);
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   // 타임스탬프 헤더 설정
   char ts[32];
-  snprintf(ts, 32, "%lld.%06ld", fb->timestamp.tv_sec, fb->timestamp.tv_usec);
+  snprintf(ts, 32, "%lld.%06ld", f->timestamp.tv_sec, f->timestamp.tv_usec);
   httpd_resp_set_hdr(req, "X-Timestamp", (const char *)ts);
 
-#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-  size_t fb_len = 0;
-#endif
-  // 만약 프레임 포맷이 JPEG이면 그대로 전송
-  if (fb->format == PIXFORMAT_JPEG) {
-#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-    fb_len = fb->len;
-#endif
-    res = httpd_resp_send(req, (const char *)fb->buf, fb->len);
+  int64_t t0 = esp_timer_get_time();
+  if (not_modified) {
+    capture_cache_not_modified();
+    httpd_resp_set_status(req, "304 Not Modified");
+    res = httpd_resp_send(req, NULL, 0);
   } else {
-    // JPEG가 아니라면 JPEG 인코딩 후 청크 전송
-    jpg_chunking_t jchunk = {req, 0};
-    res = frame2jpg_cb(fb, 80, jpg_encode_stream, &jchunk) ? ESP_OK : ESP_FAIL;
-    // 전송 종료 청크 전송
-    httpd_resp_send_chunk(req, NULL, 0);
+    // HTTP 응답 헤더 설정 (JPEG 이미지)
+    httpd_resp_set_type(req, "image/jpeg");
+    httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
+    res = httpd_resp_send(req, (const char *)f->buf, f->len);
+    trace_span("send", t0, f->len);
+    metrics_observe(METRIC_JPEG_SIZE, f->len);
+  }
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-    fb_len = jchunk.len;
+  size_t fb_len = not_modified ? 0 : f->len;
 #endif
+  capture_cache_release(f);
+  if (res != ESP_OK) {
+    metrics_add(METRIC_SEND_FAILED, 1);
   }
-  esp_camera_fb_return(fb);
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
   int64_t fr_end = esp_timer_get_time();
   log_i("JPG: %uB %ums", (uint32_t)(fb_len), (uint32_t)((fr_end - fr_start) / 1000));
@@ -202,92 +253,372 @@ fb = esp_camera_fb_get();  //바로 프레임 캡처
   return res;
 }
 
-// 연속 스트리밍 모드에서 캡처한 프레임들을 HTTP 멀티파트 스트림으로 전송하는 핸들러
-static esp_err_t stream_handler(httpd_req_t *req) {
-  camera_fb_t *fb = NULL;
-  struct timeval _timestamp;
-  esp_err_t res = ESP_OK;
-  size_t _jpg_buf_len = 0;
-  uint8_t *_jpg_buf = NULL;
-  char *part_buf[128];
+static void capture_task(void *arg) {
+  for (;;) {
+    xSemaphoreTake(capture_work, portMAX_DELAY);
+    xSemaphoreTake(capture_lock, portMAX_DELAY);
+    capture_job_t job = capture_jobs[capture_head];
+    capture_head = (capture_head + 1) % CAPTURE_QUEUE;
+    capture_count--;
+    xSemaphoreGive(capture_lock);
+    capture_send(job.req);
+    metrics_endpoint_observe(capture_metric, esp_timer_get_time() - job.start);
+    httpd_req_async_handler_complete(job.req);
+  }
+}
 
-  // 이전 프레임 시간 초기화 (프레임 간 시간 측정을 위함)
-  static int64_t last_frame = 0;
-  if (!last_frame) {
-    last_frame = esp_timer_get_time();
+static esp_err_t capture_workers_init(void) {
+  if (capture_lock) {
+    return ESP_OK;
+  }
+  capture_lock = xSemaphoreCreateMutex();
+  capture_work = xSemaphoreCreateCounting(CAPTURE_QUEUE, 0);
+  if (!capture_lock || !capture_work) {
+    return ESP_ERR_NO_MEM;
   }
+  capture_metric = metrics_endpoint_register("/capture", "GET");
+  for (int i = 0; i < CAPTURE_WORKERS; i++) {
+    if (xTaskCreate(capture_task, "capture", 4096, NULL, 5, NULL) != pdPASS) {
+      return ESP_FAIL;
+    }
+  }
+  return ESP_OK;
+}
 
-  // HTTP 응답 타입과 헤더 설정
-  res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
-  if (res != ESP_OK) {
-    return res;
+// /capture 핸들러: 요청을 떼어 내 작업 태스크에 넘긴다. 넘기지 못하면 여기서 바로 보낸다.
+static esp_err_t capture_handler(httpd_req_t *req) {
+  int64_t start = esp_timer_get_time();
+  esp_err_t res = ESP_OK;
+  httpd_req_t *async_req = NULL;
+  if (capture_work && httpd_req_async_handler_begin(req, &async_req) == ESP_OK) {
+    bool queued = false;
+    xSemaphoreTake(capture_lock, portMAX_DELAY);
+    if (capture_count < CAPTURE_QUEUE) {
+      capture_jobs[(capture_head + capture_count) % CAPTURE_QUEUE] = {async_req, start};
+      capture_count++;
+      queued = true;
+    }
+    xSemaphoreGive(capture_lock);
+    if (queued) {
+      xSemaphoreGive(capture_work);
+      return ESP_OK;
+    }
+    capture_send(async_req);  // 대기열이 차 있음
+    httpd_req_async_handler_complete(async_req);
+  } else {
+    res = capture_send(req);
   }
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  httpd_resp_set_hdr(req, "X-Framerate", "60");
+  metrics_endpoint_observe(capture_metric, esp_timer_get_time() - start);
+  return res;
+}
 
-  // 무한 루프로 프레임을 캡처 및 전송 (스트림 종료 조건은 외부에서 연결 종료)
-  while (true) {
-    fb = esp_camera_fb_get();
-    if (!fb) {
-      log_e("Camera capture failed");
-      res = ESP_FAIL;
-    } else {
-      // 프레임 캡처 시간 저장
-      _timestamp.tv_sec = fb->timestamp.tv_sec;
-      _timestamp.tv_usec = fb->timestamp.tv_usec;
-      if (fb->format != PIXFORMAT_JPEG) {
-        // JPEG가 아닌 포맷이면 JPEG로 변환
-        bool jpeg_converted = frame2jpg(fb, 80, &_jpg_buf, &_jpg_buf_len);
-        esp_camera_fb_return(fb);
-        fb = NULL;
-        if (!jpeg_converted) {
-          log_e("JPEG compression failed");
-          res = ESP_FAIL;
-        }
-      } else {
-        // 이미 JPEG 포맷이면 바로 사용
-        _jpg_buf_len = fb->len;
-        _jpg_buf = fb->buf;
+// 스트림 전송 방식 기본값. 요청마다 /stream?mode=chunked&nodelay=0&sndbuf=16384 처럼 바꿀 수 있다.
+#define STREAM_NODELAY_DEFAULT 1   // TCP_NODELAY (1: 파트를 모으지 않고 바로 내보냄)
+#define STREAM_SNDBUF_DEFAULT 0    // SO_SNDBUF 바이트 수 (0: 스택 기본값 유지)
+#define STREAM_IDLE_MS_DEFAULT 0    // 장면이 그대로일 때 프레임 간격 (0: 솎지 않음, 클라이언트가 ?idle= 로 켠다)
+
+// raw 모드는 응답 헤더를 직접 쓰고 청크 인코딩 없이 보낸다. 본문 길이가 없으므로 연결 종료로 끝낸다.
+static const char *_STREAM_RAW_HEADER = "HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: multipart/x-mixed-replace;boundary=" PART_BOUNDARY "\r\n"
+                                        "Access-Control-Allow-Origin: *\r\n"
+                                        "X-Framerate: 60\r\n"
+                                        "Connection: close\r\n"
+                                        "\r\n";
+
+// 스트림 클라이언트 하나의 상태
+typedef struct {
+  httpd_req_t *req;      // httpd_req_async_handler_begin() 으로 떼어 낸 요청
+  broadcast_sub_t *sub;  // 이 클라이언트의 브로드캐스터 구독
+  bool raw;              // true: 소켓에 직접 writev, false: httpd_resp_send_chunk
+  int fd;                // raw 모드에서 쓰는 소켓
+  bool header_sent;      // raw 모드의 응답 헤더를 보냈는지
+  uint32_t writes;       // 소켓 쓰기 호출 수 (프레임당 비용 확인용, chunked 모드는 stream_chunk_send 가 센다)
+  uint32_t idle_ms;      // 장면이 그대로일 때 프레임 간격 (0: 솎지 않음)
+  ra_filter_t ra_filter;      // 프레임 간 시간 평균 (스트림 태스크마다 따로 둔다)
+  ra_filter_t jitter_filter;  // 연속한 프레임 간격 차이(us)의 평균 (스트림 지터)
+} stream_ctx_t;
+
+// iov 전체를 다 쓸 때까지 writev 를 반복한다. 일부만 쓰였으면 남은 부분부터 다시 쓴다.
+static esp_err_t sock_writev_all(int fd, struct iovec *iov, int iovcnt, uint32_t *writes) {
+  while (iovcnt > 0) {
+    ssize_t n = writev(fd, iov, iovcnt);
+    (*writes)++;
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
       }
+      return ESP_FAIL;
     }
-    // 멀티파트 경계 전송
-    if (res == ESP_OK) {
-      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+    while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+      n -= iov->iov_len;
+      iov++;
+      iovcnt--;
     }
-    // 각 파트의 헤더 전송 (Content-Type, Content-Length, Timestamp)
-    if (res == ESP_OK) {
-      size_t hlen = snprintf((char *)part_buf, 128, _STREAM_PART, _jpg_buf_len, _timestamp.tv_sec, _timestamp.tv_usec);
-      res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + n;
+      iov->iov_len -= n;
     }
-    // JPEG 이미지 데이터 전송
-    if (res == ESP_OK) {
-      res = httpd_resp_send_chunk(req, (const char *)_jpg_buf, _jpg_buf_len);
+  }
+  return ESP_OK;
+}
+
+// chunked 모드 세션의 송신 함수. httpd 기본 송신과 같고, transport ctx 에 둔 writes 로 호출 수를 센다.
+static int stream_chunk_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags) {
+  uint32_t *writes = (uint32_t *)httpd_sess_get_transport_ctx(hd, sockfd);
+  if (writes) {
+    (*writes)++;
+  }
+  int n = send(sockfd, buf, buf_len, flags);
+  if (n < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+  }
+  return n;
+}
+
+// ?idle=<ms> 를 읽는다. 없으면 STREAM_IDLE_MS_DEFAULT.
+static uint32_t stream_idle_option(httpd_req_t *req) {
+  char query[64];
+  char value[16];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "idle", value, sizeof(value)) == ESP_OK) {
+    return (uint32_t)atoi(value);
+  }
+  return STREAM_IDLE_MS_DEFAULT;
+}
+
+// 장면이 그대로면(frame_analysis.h) idle_ms 마다 한 장만 보낸다. 이 프레임을 건너뛸 거면 true.
+// 첫 프레임(last_sent_us 0)은 항상 보낸다.
+static bool stream_thin(uint32_t idle_ms, int64_t last_sent_us, int64_t now) {
+  if (!idle_ms || !last_sent_us || now - last_sent_us >= idle_ms * 1000LL) {
+    return false;
+  }
+  return !analysis_scene_changed();
+}
+
+// 구독을 끝낸다. 마지막 스트림이었으면 (기록용 구독자만 남았으면) 레이트 컨트롤러가 바꿔 둔 설정을 되돌린다.
+static void stream_unsubscribe(broadcast_sub_t *sub) {
+  rate_ctrl_forget(sub);
+  broadcast_unsubscribe(sub);
+  broadcast_stats_t stats;
+  broadcast_get_stats(&stats);
+  if (stats.subscribers == stats.recorders) {
+    rate_ctrl_idle();
+  }
+}
+
+// 멀티파트 파트 하나(경계, 파트 헤더, JPEG)를 보낸다.
+static esp_err_t stream_send_part(stream_ctx_t *ctx, const char *part, size_t part_len, const uint8_t *jpg, size_t jpg_len) {
+  if (ctx->raw) {
+    // 경계/헤더/본문을 한 번의 writev 로 보낸다. 첫 파트에는 HTTP 응답 헤더도 함께 싣는다.
+    struct iovec iov[4];
+    int n = 0;
+    if (!ctx->header_sent) {
+      iov[n].iov_base = (void *)_STREAM_RAW_HEADER;
+      iov[n++].iov_len = strlen(_STREAM_RAW_HEADER);
+      ctx->header_sent = true;
+    }
+    iov[n].iov_base = (void *)_STREAM_BOUNDARY;
+    iov[n++].iov_len = strlen(_STREAM_BOUNDARY);
+    iov[n].iov_base = (void *)part;
+    iov[n++].iov_len = part_len;
+    iov[n].iov_base = (void *)jpg;
+    iov[n++].iov_len = jpg_len;
+    return sock_writev_all(ctx->fd, iov, n, &ctx->writes);
+  }
+  // httpd_resp_send_chunk 는 호출마다 길이 줄, 데이터, CRLF 를 따로 보낸다. 쓰기 수는 stream_chunk_send 가 센다.
+  esp_err_t res = httpd_resp_send_chunk(ctx->req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(ctx->req, part, part_len);
+  }
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(ctx->req, (const char *)jpg, jpg_len);
+  }
+  return res;
+}
+
+// 스트림 클라이언트 하나를 맡는 전송 태스크.
+// 캡처는 프레임 브로드캐스터가 한 번만 하고, 여기서는 받은 최신 프레임을 보내기만 한다.
+static void stream_task(void *arg) {
+  stream_ctx_t *ctx = (stream_ctx_t *)arg;
+  esp_err_t res = ESP_OK;
+  char part_buf[128];
+  uint32_t sent = 0;
+  uint32_t thinned = 0;
+  int64_t last_sent = 0;
+
+  // 이전 프레임 시간 초기화 (프레임 간 시간 측정을 위함, 클라이언트마다 따로)
+  int64_t last_frame = esp_timer_get_time();
+  int64_t last_frame_us = -1;  // 직전 프레임 간격 (지터 계산용)
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+  // 프레임 간 시간 평균을 위한 필터 초기화 (20개 샘플, 할당에 실패하면 평균 없이 현재 값을 찍는다)
+  ra_filter_init(&ctx->ra_filter, 20);
+  ra_filter_init(&ctx->jitter_filter, 20);
+#endif
+
+  // 무한 루프로 프레임을 전송 (스트림 종료 조건은 외부에서 연결 종료)
+  while (res == ESP_OK) {
+    broadcast_frame_t *frame = broadcast_wait_frame(ctx->sub, pdMS_TO_TICKS(5000));
+    if (!frame) {
+      log_e("Camera capture failed");
+      res = ESP_FAIL;
+      break;
     }
-    // 프레임 버퍼 반환 및 할당 해제
-    if (fb) {
-      esp_camera_fb_return(fb);
-      fb = NULL;
-      _jpg_buf = NULL;
-    } else if (_jpg_buf) {
-      free(_jpg_buf);
-      _jpg_buf = NULL;
+    if (stream_thin(ctx->idle_ms, last_sent, esp_timer_get_time())) {
+      broadcast_release(frame);
+      thinned++;
+      metrics_add(METRIC_FRAMES_THINNED, 1);
+      continue;
     }
+    // 각 파트의 헤더 (Content-Type, Content-Length, Timestamp)
+    size_t hlen = snprintf(part_buf, sizeof(part_buf), _STREAM_PART, frame->len, frame->timestamp.tv_sec, frame->timestamp.tv_usec);
+    int64_t send_start = esp_timer_get_time();
+    last_sent = send_start;
+    res = stream_send_part(ctx, part_buf, hlen, frame->buf, frame->len);
+    trace_span("stream_send", send_start, frame->len);
+    size_t frame_len = frame->len;
+    broadcast_release(frame);
     if (res != ESP_OK) {
       log_e("Send frame failed");
+      metrics_add(METRIC_SEND_FAILED, 1);
       break;
     }
+    sent++;
+    metrics_add(METRIC_FRAMES_SENT, 1);
+    metrics_observe(METRIC_FRAME_SEND, esp_timer_get_time() - send_start);
+    // 소켓이 막혀 있던 시간을 레이트 컨트롤러에 알린다.
+    rate_ctrl_report(ctx->sub, esp_timer_get_time() - send_start, frame_len);
     // 프레임 간 시간 계산 및 평균 프레임 시간 업데이트 (필터 사용)
     int64_t fr_end = esp_timer_get_time();
     int64_t frame_time = fr_end - last_frame;
     last_frame = fr_end;
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+    // 지터: 프레임 간격이 직전 간격과 얼마나 다른지의 평균 (센서 읽기 등이 끼어들면 커진다)
+    uint32_t jitter = 0;
+    if (last_frame_us >= 0) {
+      jitter = ra_filter_run(&ctx->jitter_filter, (int)llabs(frame_time - last_frame_us));
+    }
+    last_frame_us = frame_time;
+#endif
     frame_time /= 1000;  // 밀리초 단위 변환
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
-    uint32_t avg_frame_time = ra_filter_run(&ra_filter, frame_time);
-    log_i("MJPG: %uB %ums (%.1ffps), AVG: %ums (%.1ffps)", (uint32_t)(_jpg_buf_len), (uint32_t)frame_time, 1000.0 / (uint32_t)frame_time, avg_frame_time, 1000.0 / avg_frame_time);
+    uint32_t avg_frame_time = ra_filter_run(&ctx->ra_filter, frame_time);
+    log_i("MJPG: %uB %ums (%.1ffps), AVG: %ums (%.1ffps), jitter %uus", (uint32_t)(frame_len), (uint32_t)frame_time, 1000.0 / (uint32_t)frame_time, avg_frame_time, 1000.0 / avg_frame_time, jitter);
+#else
+    (void)frame_len;
+    (void)last_frame_us;
 #endif
   }
 
-  return res;
+  log_i("Stream closed: sent %u, thinned %u, dropped %u, writes %u", sent, thinned, broadcast_dropped(ctx->sub),
+        ctx->writes);
+  stream_unsubscribe(ctx->sub);
+  httpd_handle_t hd = ctx->req->handle;
+  if (!ctx->raw) {
+    // 세션은 ctx 보다 오래 남으므로 카운터를 떼어 낸다.
+    httpd_sess_set_transport_ctx(hd, ctx->fd, NULL, NULL);
+  }
+  httpd_req_async_handler_complete(ctx->req);
+  if (ctx->raw) {
+    // 청크 종료 표시 없이 보냈으므로 연결을 닫아야 응답이 끝난다.
+    httpd_sess_trigger_close(hd, ctx->fd);
+  }
+  free(ctx->ra_filter.values);
+  free(ctx->jitter_filter.values);
+  free(ctx);
+  vTaskDelete(NULL);
+}
+
+// /stream 쿼리로 전송 방식을 고른다. 쿼리가 없으면 기본값을 쓴다.
+static void stream_parse_options(httpd_req_t *req, stream_ctx_t *ctx) {
+  char query[64];
+  char value[16];
+  int nodelay = STREAM_NODELAY_DEFAULT;
+  int sndbuf = STREAM_SNDBUF_DEFAULT;
+
+  ctx->raw = true;
+  ctx->idle_ms = stream_idle_option(req);
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+    if (httpd_query_key_value(query, "mode", value, sizeof(value)) == ESP_OK) {
+      ctx->raw = strcmp(value, "chunked") != 0;
+    }
+    if (httpd_query_key_value(query, "nodelay", value, sizeof(value)) == ESP_OK) {
+      nodelay = atoi(value) ? 1 : 0;
+    }
+    if (httpd_query_key_value(query, "sndbuf", value, sizeof(value)) == ESP_OK) {
+      sndbuf = atoi(value);
+    }
+  }
+
+  int fd = httpd_req_to_sockfd(req);
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) != 0) {
+    log_e("TCP_NODELAY failed: %d", errno);
+  }
+  if (sndbuf > 0 && setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) != 0) {
+    // lwIP 빌드에 따라 SO_SNDBUF 를 지원하지 않을 수 있다. 이 경우 스택 기본값으로 보낸다.
+    log_e("SO_SNDBUF failed: %d", errno);
+  }
+}
+
+// 연속 스트리밍 요청을 받아 전송 태스크에 넘기는 핸들러.
+// 핸들러가 루프를 돌면 서버 태스크가 묶여 두 번째 클라이언트를 받지 못하므로,
+// 요청을 비동기로 떼어 내 클라이언트마다 전송 태스크를 하나씩 둔다.
+static esp_err_t stream_handler(httpd_req_t *req) {
+  esp_err_t res = ESP_OK;
+
+  // 구독 자리가 없으면 스트림을 시작하기 전에 거절한다.
+  broadcast_sub_t *sub = broadcast_subscribe();
+  if (!sub) {
+    log_e("Too many streams");
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, "Too many streams", HTTPD_RESP_USE_STRLEN);
+  }
+
+  stream_ctx_t *ctx = (stream_ctx_t *)calloc(1, sizeof(stream_ctx_t));
+  if (!ctx) {
+    broadcast_unsubscribe(sub);
+    httpd_resp_send_500(req);
+    return ESP_FAIL;
+  }
+  ctx->sub = sub;
+  ctx->fd = httpd_req_to_sockfd(req);
+  stream_parse_options(req, ctx);
+
+  // HTTP 응답 타입과 헤더 설정 (chunked 모드에서 httpd 가 보낸다)
+  if (!ctx->raw) {
+    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
+    if (res != ESP_OK) {
+      free(ctx);
+      broadcast_unsubscribe(sub);
+      return res;
+    }
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "X-Framerate", "60");
+  }
+
+  res = httpd_req_async_handler_begin(req, &ctx->req);
+  if (res != ESP_OK) {
+    log_e("Stream handoff failed");
+    free(ctx);
+    broadcast_unsubscribe(sub);
+    return res;
+  }
+  httpd_req_t *async_req = ctx->req;
+  if (!ctx->raw) {
+    httpd_sess_set_transport_ctx(req->handle, ctx->fd, &ctx->writes, NULL);
+    httpd_sess_set_send_override(req->handle, ctx->fd, stream_chunk_send);
+  }
+  if (xTaskCreatePinnedToCore(stream_task, "stream", 4096, ctx, 5, NULL, STREAM_CORE) != pdPASS) {
+    log_e("Stream task create failed");
+    if (!ctx->raw) {
+      httpd_sess_set_transport_ctx(req->handle, ctx->fd, NULL, NULL);
+    }
+    free(ctx);
+    broadcast_unsubscribe(sub);
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
 }
 
 // HTTP GET 방식으로 전달된 쿼리 문자열을 파싱하여 버퍼에 저장하는 함수
@@ -315,7 +646,261 @@ static esp_err_t parse_get(httpd_req_t *req, char **obuf) {
   return ESP_FAIL;
 }
 
+// /status 응답은 설정이 바뀔 때만 다시 만든다. 만들 때마다 OV3660/OV5640 은 레지스터를 50 개 가까이
+// SCCB 로 읽어야 하므로, 대시보드가 폴링하는 동안에는 만들어 둔 JSON 을 그대로 보낸다.
+// 센서 설정을 바꾸는 핸들러는 성공한 뒤 status_invalidate() 를 부른다. 자동 조절(rate_ctrl)이 바꾼
+// quality/framesize 는 adjustments 카운터로 알아챈다.
+// 자동 노출 중인 노출/게인 레지스터(0x3500, 0x350a 등)는 마지막으로 만든 시점의 값이다.
+#define STATUS_JSON_MAX 1536  // OV5640 레지스터 목록까지 넣고도 남는 크기
+
+static char status_json[STATUS_JSON_MAX];
+static size_t status_len;
+static uint32_t status_built_gen;  // status_json 을 만들 때의 status_gen (0: 아직 없음)
+static uint32_t status_built_adj;  // 그때의 rate_ctrl adjustments
+static std::atomic<uint32_t> status_gen(1);
+static SemaphoreHandle_t status_lock = NULL;  // status_json 보호 (만들고 보내는 동안)
+
+static inline void status_invalidate(void) {
+  status_gen.fetch_add(1, std::memory_order_relaxed);
+}
+
+// /control 로 바꿀 수 있는 설정 목록. 이름은 컴파일 시간에 만든 완전 해시 표로 찾는다.
+// 설정 함수는 0 이상이면 성공이다. get 은 현재 값으로, 프로필이 바뀌는 설정만 적용하는 데 쓴다.
+typedef int (*control_setter_t)(sensor_t *s, int val);
+typedef int (*control_getter_t)(sensor_t *s);
+
+typedef struct {
+  const char *name;
+  control_setter_t set;
+  control_getter_t get;
+} control_entry_t;
+
+// s->status 의 같은 이름 항목을 읽고 s->set_<setter> 로 쓰는 설정
+#define CONTROL_SENSOR(name, setter, field)                             \
+  {name, [](sensor_t *s, int val) { return s->setter(s, val); },        \
+   [](sensor_t *s) { return (int)s->status.field; }}
+
+static bool profile_window_on = false;  // 프로필의 창이 framesize 대신 출력 크기를 정하고 있음
+
+static constexpr control_entry_t control_table[] = {
+  {"framesize", [](sensor_t *s, int val) {
+     if (s->pixformat != PIXFORMAT_JPEG) {
+       return 0;
+     }
+     int res = s->set_framesize(s, (framesize_t)val);
+     if (res == 0) {  // 센서가 거부한 값을 기준값으로 삼으면 rate_ctrl 이 되돌려 놓지 못한다
+       profile_window_on = false;  // 창이 걷힌다 (rate_ctrl 의 framesize 잠금도 풀림)
+       rate_ctrl_set_base_framesize((framesize_t)val);
+     }
+     return res;
+   },
+   [](sensor_t *s) { return (int)s->status.framesize; }},
+  {"quality", [](sensor_t *s, int val) {
+     int res = s->set_quality(s, val);
+     if (res == 0) {
+       rate_ctrl_set_base_quality(val);
+     }
+     return res;
+   },
+   [](sensor_t *s) { return (int)s->status.quality; }},
+  {"adaptive", [](sensor_t *s, int val) { rate_ctrl_set_enabled(val); return 0; },
+   [](sensor_t *s) {
+     rate_ctrl_state_t rc;
+     rate_ctrl_get(&rc);
+     return (int)rc.enabled;
+   }},
+  {"rc_fps", [](sensor_t *s, int val) { rate_ctrl_set_target_fps(val); return 0; },
+   [](sensor_t *s) {
+     rate_ctrl_state_t rc;
+     rate_ctrl_get(&rc);
+     return rc.target_fps;
+   }},
+  {"rc_kbps", [](sensor_t *s, int val) { rate_ctrl_set_max_kbps(val); return 0; },
+   [](sensor_t *s) {
+     rate_ctrl_state_t rc;
+     rate_ctrl_get(&rc);
+     return rc.max_kbps;
+   }},
+  CONTROL_SENSOR("contrast", set_contrast, contrast),
+  CONTROL_SENSOR("brightness", set_brightness, brightness),
+  CONTROL_SENSOR("saturation", set_saturation, saturation),
+  {"gainceiling", [](sensor_t *s, int val) { return s->set_gainceiling(s, (gainceiling_t)val); },
+   [](sensor_t *s) { return (int)s->status.gainceiling; }},
+  CONTROL_SENSOR("colorbar", set_colorbar, colorbar),
+  CONTROL_SENSOR("awb", set_whitebal, awb),
+  CONTROL_SENSOR("agc", set_gain_ctrl, agc),
+  CONTROL_SENSOR("aec", set_exposure_ctrl, aec),
+  CONTROL_SENSOR("hmirror", set_hmirror, hmirror),
+  CONTROL_SENSOR("vflip", set_vflip, vflip),
+  CONTROL_SENSOR("awb_gain", set_awb_gain, awb_gain),
+  CONTROL_SENSOR("agc_gain", set_agc_gain, agc_gain),
+  CONTROL_SENSOR("aec_value", set_aec_value, aec_value),
+  CONTROL_SENSOR("aec2", set_aec2, aec2),
+  CONTROL_SENSOR("dcw", set_dcw, dcw),
+  CONTROL_SENSOR("bpc", set_bpc, bpc),
+  CONTROL_SENSOR("wpc", set_wpc, wpc),
+  CONTROL_SENSOR("raw_gma", set_raw_gma, raw_gma),
+  CONTROL_SENSOR("lenc", set_lenc, lenc),
+  CONTROL_SENSOR("special_effect", set_special_effect, special_effect),
+  CONTROL_SENSOR("wb_mode", set_wb_mode, wb_mode),
+  CONTROL_SENSOR("ae_level", set_ae_level, ae_level),
+#if CONFIG_LED_ILLUMINATOR_ENABLED
+  {"led_intensity", [](sensor_t *s, int val) {
+     // LED 밝기 조절 명령 처리 (스트리밍 중이면 즉시 적용)
+     led_duty = val;
+     if (isStreaming) {
+       enable_led(true);
+     }
+     return 0;
+   },
+   [](sensor_t *s) { return (int)led_duty; }},
+#endif
+};
+
+#define CONTROL_COUNT (sizeof(control_table) / sizeof(control_table[0]))
+#define CONTROL_SLOTS 128  // 2 의 거듭제곱. 항목 수의 4 배쯤이면 충돌 없는 seed 를 금방 찾는다.
+
+static constexpr uint32_t control_hash(const char *name, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;  // FNV-1a
+  for (; *name; name++) {
+    h = (h ^ (uint8_t)*name) * 16777619u;
+  }
+  return h & (CONTROL_SLOTS - 1);
+}
+
+static constexpr bool control_seed_ok(uint32_t seed) {
+  bool used[CONTROL_SLOTS] = {};
+  for (size_t i = 0; i < CONTROL_COUNT; i++) {
+    uint32_t slot = control_hash(control_table[i].name, seed);
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}
+
+static constexpr uint32_t control_find_seed(void) {
+  for (uint32_t seed = 0; seed < 10000; seed++) {
+    if (control_seed_ok(seed)) {
+      return seed;
+    }
+  }
+  return UINT32_MAX;
+}
+
+static constexpr uint32_t CONTROL_SEED = control_find_seed();
+static_assert(CONTROL_SEED != UINT32_MAX, "no collision-free seed for control_table; raise CONTROL_SLOTS");
+
+typedef struct {
+  int8_t index[CONTROL_SLOTS];  // 슬롯 -> control_table 번호 (-1: 빈 슬롯)
+} control_slots_t;
+
+static constexpr control_slots_t control_build_slots(void) {
+  control_slots_t t = {};
+  for (size_t i = 0; i < CONTROL_SLOTS; i++) {
+    t.index[i] = -1;
+  }
+  for (size_t i = 0; i < CONTROL_COUNT; i++) {
+    t.index[control_hash(control_table[i].name, CONTROL_SEED)] = i;
+  }
+  return t;
+}
+
+static constexpr control_slots_t control_slots = control_build_slots();
+
+static const control_entry_t *control_find(const char *name) {
+  int i = control_slots.index[control_hash(name, CONTROL_SEED)];
+  return i >= 0 && !strcmp(control_table[i].name, name) ? &control_table[i] : NULL;
+}
+
+#define CONTROL_BATCH_MAX 16  // 한 요청에 담을 수 있는 설정 수
+
+typedef struct {
+  const control_entry_t *entry;
+  const char *name;  // 쿼리 문자열 안을 가리킴
+  int val;
+  int res;
+} control_item_t;
+
+// 쿼리 문자열을 "이름=값" 쌍으로 잘라 items 에 채운다 (buf 를 고쳐 씀). 쌍의 수를 돌려주고,
+// 너무 많으면 -1.
+static int control_parse_batch(char *buf, control_item_t *items) {
+  int n = 0;
+  for (char *save = NULL, *pair = strtok_r(buf, "&", &save); pair; pair = strtok_r(NULL, "&", &save)) {
+    char *eq = strchr(pair, '=');
+    if (!eq) {
+      continue;
+    }
+    if (n == CONTROL_BATCH_MAX) {
+      return -1;
+    }
+    *eq = 0;
+    items[n].name = pair;
+    items[n].val = atoi(eq + 1);
+    items[n].entry = control_find(pair);
+    items[n].res = 0;
+    n++;
+  }
+  return n;
+}
+
+// 여러 설정을 한 번에 적용한다. /control?quality=10&framesize=8&aec=1
+// 이름을 모두 확인한 뒤 (모르는 이름이 있으면 아무것도 바꾸지 않고 400) 스트림 캡처를 멈춘 채
+// 순서대로 적용하므로, 설정이 절반만 바뀐 프레임은 나가지 않는다. 응답은 설정별 결과다.
+static esp_err_t control_batch(httpd_req_t *req, char *buf) {
+  control_item_t items[CONTROL_BATCH_MAX];
+  int n = control_parse_batch(buf, items);
+  bool known = n > 0;
+  for (int i = 0; i < n; i++) {
+    known = known && items[i].entry;
+  }
+
+  char json[CONTROL_BATCH_MAX * 32 + 32];
+  int len = 0;
+  if (n < 0) {
+    len = snprintf(json, sizeof(json), "{\"error\":\"too many settings (max %d)\"}", CONTROL_BATCH_MAX);
+  } else if (!known) {
+    len = snprintf(json, sizeof(json), "{\"unknown\":[");
+    for (int i = 0, first = 1; i < n; i++) {
+      if (!items[i].entry) {
+        len += snprintf(json + len, sizeof(json) - len, "%s\"%.24s\"", first ? "" : ",", items[i].name);
+        first = 0;
+      }
+    }
+    len += snprintf(json + len, sizeof(json) - len, "]}");
+  }
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  if (n < 0 || !known) {
+    httpd_resp_set_status(req, "400 Bad Request");
+    return httpd_resp_send(req, json, len);
+  }
+
+  sensor_t *s = esp_camera_sensor_get();
+  int failed = 0;
+  broadcast_settings_begin();
+  for (int i = 0; i < n; i++) {
+    items[i].res = items[i].entry->set(s, items[i].val);
+    failed += items[i].res < 0;
+  }
+  broadcast_settings_end();
+  status_invalidate();
+
+  len = snprintf(json, sizeof(json), "{\"failed\":%d,\"results\":{", failed);
+  for (int i = 0; i < n; i++) {
+    len += snprintf(json + len, sizeof(json) - len, "%s\"%s\":%d", i ? "," : "", items[i].entry->name, items[i].res);
+  }
+  len += snprintf(json + len, sizeof(json) - len, "}}");
+  log_i("Control batch: %d settings, %d failed", n, failed);
+  if (failed) {
+    httpd_resp_set_status(req, "500 Internal Server Error");
+  }
+  return httpd_resp_send(req, json, len);
+}
+
 // 카메라 제어 명령 처리 핸들러 (여러 센서 파라미터 제어)
+// /control?var=<이름>&val=<값> 은 설정 하나를, var 없이 이름=값 쌍을 나열하면 일괄 설정을 처리한다.
 static esp_err_t cmd_handler(httpd_req_t *req) {
   char *buf = NULL;
   char variable[32];
@@ -325,8 +910,12 @@ static esp_err_t cmd_handler(httpd_req_t *req) {
   if (parse_get(req, &buf) != ESP_OK) {
     return ESP_FAIL;
   }
-  if (httpd_query_key_value(buf, "var", variable, sizeof(variable)) != ESP_OK ||
-      httpd_query_key_value(buf, "val", value, sizeof(value)) != ESP_OK) {
+  if (httpd_query_key_value(buf, "var", variable, sizeof(variable)) != ESP_OK) {
+    esp_err_t res = control_batch(req, buf);
+    free(buf);
+    return res;
+  }
+  if (httpd_query_key_value(buf, "val", value, sizeof(value)) != ESP_OK) {
     free(buf);
     httpd_resp_send_404(req);
     return ESP_FAIL;
@@ -335,161 +924,351 @@ static esp_err_t cmd_handler(httpd_req_t *req) {
 
   int val = atoi(value);
   log_i("%s = %d", variable, val);
-  sensor_t *s = esp_camera_sensor_get();
-  int res = 0;
-
-  // 각각의 센서 파라미터에 따라 처리
-  if (!strcmp(variable, "framesize")) {
-    if (s->pixformat == PIXFORMAT_JPEG) {
-      res = s->set_framesize(s, (framesize_t)val);
-    }
-  } else if (!strcmp(variable, "quality")) {
-    res = s->set_quality(s, val);
-  } else if (!strcmp(variable, "contrast")) {
-    res = s->set_contrast(s, val);
-  } else if (!strcmp(variable, "brightness")) {
-    res = s->set_brightness(s, val);
-  } else if (!strcmp(variable, "saturation")) {
-    res = s->set_saturation(s, val);
-  } else if (!strcmp(variable, "gainceiling")) {
-    res = s->set_gainceiling(s, (gainceiling_t)val);
-  } else if (!strcmp(variable, "colorbar")) {
-    res = s->set_colorbar(s, val);
-  } else if (!strcmp(variable, "awb")) {
-    res = s->set_whitebal(s, val);
-  } else if (!strcmp(variable, "agc")) {
-    res = s->set_gain_ctrl(s, val);
-  } else if (!strcmp(variable, "aec")) {
-    res = s->set_exposure_ctrl(s, val);
-  } else if (!strcmp(variable, "hmirror")) {
-    res = s->set_hmirror(s, val);
-  } else if (!strcmp(variable, "vflip")) {
-    res = s->set_vflip(s, val);
-  } else if (!strcmp(variable, "awb_gain")) {
-    res = s->set_awb_gain(s, val);
-  } else if (!strcmp(variable, "agc_gain")) {
-    res = s->set_agc_gain(s, val);
-  } else if (!strcmp(variable, "aec_value")) {
-    res = s->set_aec_value(s, val);
-  } else if (!strcmp(variable, "aec2")) {
-    res = s->set_aec2(s, val);
-  } else if (!strcmp(variable, "dcw")) {
-    res = s->set_dcw(s, val);
-  } else if (!strcmp(variable, "bpc")) {
-    res = s->set_bpc(s, val);
-  } else if (!strcmp(variable, "wpc")) {
-    res = s->set_wpc(s, val);
-  } else if (!strcmp(variable, "raw_gma")) {
-    res = s->set_raw_gma(s, val);
-  } else if (!strcmp(variable, "lenc")) {
-    res = s->set_lenc(s, val);
-  } else if (!strcmp(variable, "special_effect")) {
-    res = s->set_special_effect(s, val);
-  } else if (!strcmp(variable, "wb_mode")) {
-    res = s->set_wb_mode(s, val);
-  } else if (!strcmp(variable, "ae_level")) {
-    res = s->set_ae_level(s, val);
-  }
-#if CONFIG_LED_ILLUMINATOR_ENABLED
-  else if (!strcmp(variable, "led_intensity")) {
-    // LED 밝기 조절 명령 처리 (스트리밍 중이면 즉시 적용)
-    led_duty = val;
-    if (isStreaming) {
-      enable_led(true);
-    }
-  }
-#endif
-  else {
+  const control_entry_t *entry = control_find(variable);
+  int res = -1;
+  if (entry) {
+    // 일괄 설정과 같이 펜스 안에서 바꾼다. rate_ctrl 은 펜스를 잡은 채 불린다고 보고 센서를 건드린다.
+    broadcast_settings_begin();
+    res = entry->set(esp_camera_sensor_get(), val);
+    broadcast_settings_end();
+  } else {
     log_i("Unknown command: %s", variable);
-    res = -1;
   }
 
   if (res < 0) {
     return httpd_resp_send_500(req);
   }
+  status_invalidate();
 
   // CORS 헤더 추가 후 응답 전송
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, NULL, 0);
 }
 
-// 센서 레지스터 값을 읽어 문자열 형태로 출력하기 위한 헬퍼 함수
-static int print_reg(char *p, sensor_t *s, uint16_t reg, uint32_t mask) {
-  return sprintf(p, "\"0x%x\":%u,", reg, s->get_reg(s, reg, mask));
+// ===========================
+// 카메라 설정 프로필 (/profile?name=)
+// ===========================
+// 용도별로 자주 쓰는 설정 묶음. 설정 이름은 control_table 의 것을 쓰며 컴파일할 때 확인한다.
+// 적용할 때는 지금 값과 다른 설정만 부르고, /control 일괄 설정처럼 스트림 캡처를 멈춘 채 적용한다.
+#define PROFILE_SETTINGS_MAX 12
+
+typedef struct {
+  const char *name;
+  int val;
+} profile_setting_t;
+
+// set_res_raw 창. 좌표의 뜻이 센서마다 달라 pid 가 같은 센서에서만 쓴다.
+typedef struct {
+  uint16_t pid;  // 0: 창 없음
+  int sx, sy, ex, ey, offx, offy, tx, ty, ox, oy;
+  bool scale, binning;
+} profile_window_t;
+
+typedef struct {
+  const char *name;
+  int xclk_mhz;  // 0: 그대로
+  profile_setting_t settings[PROFILE_SETTINGS_MAX];  // name 이 NULL 인 항목에서 끝남
+  profile_window_t window;
+} camera_profile_t;
+
+static constexpr camera_profile_t camera_profiles[] = {
+  // 감시 대기: 작은 해상도, 낮은 XCLK 로 전력과 대역폭을 줄인다.
+  {"idle-lowpower", 10,
+   {{"framesize", FRAMESIZE_QVGA}, {"quality", 20}, {"aec", 1}, {"agc", 1}, {"gainceiling", GAINCEILING_2X},
+    {"aec2", 0}, {"adaptive", 1}, {"rc_fps", 5}}},
+  // 불꽃 추적: OV2640 의 SVGA 모드(빠른 읽기)에서 가운데 600x444 를 잘라 CIF 로 내보낸다.
+  {"fire-hunt-highfps", 20,
+   {{"framesize", FRAMESIZE_CIF}, {"quality", 12}, {"aec", 1}, {"agc", 1}, {"gainceiling", GAINCEILING_4X},
+    {"aec2", 0}, {"ae_level", -1}, {"adaptive", 1}, {"rc_fps", 25}},
+   {OV2640_PID, 1, 0, 0, 0, 100, 76, 600, 444, 400, 296, false, false}},
+  // 야간: 노출 시간을 늘리도록 XCLK 를 낮추고 DSP 야간 모드(aec2)와 높은 게인 상한을 쓴다.
+  {"night", 10,
+   {{"framesize", FRAMESIZE_VGA}, {"quality", 12}, {"aec", 1}, {"aec2", 1}, {"ae_level", 2}, {"agc", 1},
+    {"gainceiling", GAINCEILING_64X}, {"adaptive", 1}, {"rc_fps", 5}}},
+  // 증거 기록: 최대 해상도, 높은 화질. 자동 조절이 화질을 낮추지 않도록 끈다.
+  {"evidence-hires", 20,
+   {{"framesize", FRAMESIZE_UXGA}, {"quality", 8}, {"aec", 1}, {"aec2", 0}, {"agc", 1},
+    {"gainceiling", GAINCEILING_2X}, {"adaptive", 0}}},
+};
+
+static constexpr bool control_name_equal(const char *a, const char *b) {
+  for (; *a && *a == *b; a++, b++) {
+  }
+  return *a == *b;
 }
 
-// 센서 상태 정보를 JSON 형식으로 생성하여 응답하는 핸들러 함수
-static esp_err_t status_handler(httpd_req_t *req) {
-  static char json_response[1024];  // JSON 응답 버퍼
+static constexpr bool profiles_valid(void) {
+  for (const camera_profile_t &p : camera_profiles) {
+    for (const profile_setting_t &ps : p.settings) {
+      bool found = !ps.name;
+      for (size_t i = 0; i < CONTROL_COUNT && !found; i++) {
+        found = control_name_equal(ps.name, control_table[i].name);
+      }
+      if (!found) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(profiles_valid(), "camera_profiles uses a setting missing from control_table");
+static_assert(control_name_equal(control_table[0].name, "framesize"), "profile_apply expects framesize first");
+
+static const camera_profile_t *active_profile = NULL;
 
+typedef struct {
+  int changed;
+  int skipped;   // 이미 같은 값이라 건너뛴 설정 수
+  int failed;
+  int64_t apply_us;
+} profile_result_t;
+
+static void profile_apply(const camera_profile_t *p, profile_result_t *r) {
   sensor_t *s = esp_camera_sensor_get();
-  char *p = json_response;
-  *p++ = '{';
+  bool window = p->window.pid && p->window.pid == s->id.PID;
+  bool framesize_set = false;
+  *r = {};
+  int64_t start = esp_timer_get_time();
+  broadcast_settings_begin();
+  if (p->xclk_mhz && s->xclk_freq_hz != p->xclk_mhz * 1000000) {
+    r->failed += s->set_xclk(s, LEDC_TIMER_0, p->xclk_mhz) != 0;
+    r->changed++;
+  }
+  for (const profile_setting_t *ps = p->settings; ps < p->settings + PROFILE_SETTINGS_MAX && ps->name; ps++) {
+    const control_entry_t *e = control_find(ps->name);
+    bool framesize = e == &control_table[0];
+    // 창이 덮고 있던 framesize 는 값이 같아도 다시 적용해야 창이 걷힌다.
+    if (e->get(s) == ps->val && !(framesize && profile_window_on)) {
+      r->skipped++;
+      continue;
+    }
+    r->failed += e->set(s, ps->val) < 0;
+    r->changed++;
+    framesize_set = framesize_set || framesize;
+  }
+  if (profile_window_on && !window && !framesize_set) {
+    r->failed += control_table[0].set(s, s->status.framesize) < 0;
+    r->changed++;
+  }
+  if (window) {
+    const profile_window_t *w = &p->window;
+    window = s->set_res_raw(s, w->sx, w->sy, w->ex, w->ey, w->offx, w->offy, w->tx, w->ty, w->ox, w->oy,
+                            w->scale, w->binning) == 0;
+    r->failed += !window;
+    r->changed++;
+  }
+  // 창이 있는 동안 레이트 컨트롤러는 quality 만 조절한다 (framesize 를 바꾸면 창이 걷힘).
+  profile_window_on = window;
+  rate_ctrl_lock_framesize(window);
+  broadcast_settings_end();
+  r->apply_us = esp_timer_get_time() - start;
+  status_invalidate();
+  active_profile = p;
+}
+
+// /profile?name=<이름> 으로 프로필을 적용한다. 이름 없이 부르면 프로필 목록과 현재 프로필,
+// 마지막 전환 뒤 스트림에 첫 프레임이 나가기까지 걸린 시간(settle_us)을 돌려준다.
+static esp_err_t profile_handler(httpd_req_t *req) {
+  char query[64];
+  char name[32] = "";
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+    httpd_query_key_value(query, "name", name, sizeof(name));
+  }
+
+  char json[256];
+  int len;
+  if (!name[0]) {
+    broadcast_stats_t bs;
+    broadcast_get_stats(&bs);
+    len = snprintf(json, sizeof(json), "{\"active\":\"%s\",\"settle_us\":%lld,\"profiles\":[",
+                   active_profile ? active_profile->name : "", (long long)bs.settle_us);
+    for (size_t i = 0; i < sizeof(camera_profiles) / sizeof(camera_profiles[0]); i++) {
+      len += snprintf(json + len, sizeof(json) - len, "%s\"%s\"", i ? "," : "", camera_profiles[i].name);
+    }
+    len += snprintf(json + len, sizeof(json) - len, "]}");
+  } else {
+    const camera_profile_t *p = NULL;
+    for (const camera_profile_t &c : camera_profiles) {
+      if (!strcmp(c.name, name)) {
+        p = &c;
+      }
+    }
+    if (!p) {
+      httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown profile");
+      return ESP_FAIL;
+    }
+    profile_result_t r;
+    profile_apply(p, &r);
+    log_i("Profile %s: %d changed, %d skipped, %d failed, %lldus", p->name, r.changed, r.skipped, r.failed,
+          (long long)r.apply_us);
+    len = snprintf(json, sizeof(json), "{\"profile\":\"%s\",\"changed\":%d,\"skipped\":%d,\"failed\":%d,\"apply_us\":%lld}",
+                   p->name, r.changed, r.skipped, r.failed, (long long)r.apply_us);
+    if (r.failed) {
+      httpd_resp_set_status(req, "500 Internal Server Error");
+    }
+  }
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, json, len);
+}
+
+// 고정 크기 버퍼에 JSON 객체를 쓰는 writer. 할당하지 않고, 넘치면 더 쓰지 않은 채 overflow 만 남긴다.
+typedef struct {
+  char *buf;
+  size_t cap;
+  size_t len;
+  bool overflow;
+  bool first;  // 아직 쓴 항목이 없음 (쉼표 생략)
+} json_writer_t;
+
+static void jw_raw(json_writer_t *w, const char *s, size_t n) {
+  if (w->overflow || w->len + n > w->cap) {
+    w->overflow = true;
+    return;
+  }
+  memcpy(w->buf + w->len, s, n);
+  w->len += n;
+}
+
+static void jw_int(json_writer_t *w, int32_t v) {
+  char tmp[12];
+  char *p = tmp + sizeof(tmp);
+  uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+  do {
+    *--p = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  if (v < 0) {
+    *--p = '-';
+  }
+  jw_raw(w, p, tmp + sizeof(tmp) - p);
+}
+
+// ,"key":v
+static void jw_field(json_writer_t *w, const char *key, int32_t v) {
+  if (w->first) {
+    jw_raw(w, "\"", 1);
+    w->first = false;
+  } else {
+    jw_raw(w, ",\"", 2);
+  }
+  jw_raw(w, key, strlen(key));
+  jw_raw(w, "\":", 2);
+  jw_int(w, v);
+}
+
+// ,"0x3500":v (레지스터 주소를 소문자 16 진수 키로)
+static void jw_reg(json_writer_t *w, sensor_t *s, uint16_t reg, uint32_t mask) {
+  static const char hex[] = "0123456789abcdef";
+  char key[7] = {'0', 'x'};
+  int n = 2;
+  for (int shift = 12; shift >= 0; shift -= 4) {
+    if (reg >> shift || shift == 0) {
+      key[n++] = hex[(reg >> shift) & 0xF];
+    }
+  }
+  key[n] = 0;
+  jw_field(w, key, s->get_reg(s, reg, mask));
+}
+
+static size_t status_build(char *buf, size_t cap, const rate_ctrl_state_t *rc) {
+  sensor_t *s = esp_camera_sensor_get();
+  json_writer_t w = {buf, cap, 0, false, true};
+  jw_raw(&w, "{", 1);
 
   // 센서 종류에 따라 각종 레지스터 값들을 JSON에 추가
   if (s->id.PID == OV5640_PID || s->id.PID == OV3660_PID) {
     for (int reg = 0x3400; reg < 0x3406; reg += 2) {
-      p += print_reg(p, s, reg, 0xFFF);  // 12비트 값
+      jw_reg(&w, s, reg, 0xFFF);  // 12비트 값
     }
-    p += print_reg(p, s, 0x3406, 0xFF);
-    p += print_reg(p, s, 0x3500, 0xFFFF0);  // 16비트 값
-    p += print_reg(p, s, 0x3503, 0xFF);
-    p += print_reg(p, s, 0x350a, 0x3FF);    // 10비트 값
-    p += print_reg(p, s, 0x350c, 0xFFFF);   // 16비트 값
+    jw_reg(&w, s, 0x3406, 0xFF);
+    jw_reg(&w, s, 0x3500, 0xFFFF0);  // 16비트 값
+    jw_reg(&w, s, 0x3503, 0xFF);
+    jw_reg(&w, s, 0x350a, 0x3FF);    // 10비트 값
+    jw_reg(&w, s, 0x350c, 0xFFFF);   // 16비트 값
 
     for (int reg = 0x5480; reg <= 0x5490; reg++) {
-      p += print_reg(p, s, reg, 0xFF);
+      jw_reg(&w, s, reg, 0xFF);
     }
     for (int reg = 0x5380; reg <= 0x538b; reg++) {
-      p += print_reg(p, s, reg, 0xFF);
+      jw_reg(&w, s, reg, 0xFF);
     }
     for (int reg = 0x5580; reg < 0x558a; reg++) {
-      p += print_reg(p, s, reg, 0xFF);
+      jw_reg(&w, s, reg, 0xFF);
     }
-    p += print_reg(p, s, 0x558a, 0x1FF);  // 9비트 값
+    jw_reg(&w, s, 0x558a, 0x1FF);  // 9비트 값
   } else if (s->id.PID == OV2640_PID) {
-    p += print_reg(p, s, 0xd3, 0xFF);
-    p += print_reg(p, s, 0x111, 0xFF);
-    p += print_reg(p, s, 0x132, 0xFF);
+    jw_reg(&w, s, 0xd3, 0xFF);
+    jw_reg(&w, s, 0x111, 0xFF);
+    jw_reg(&w, s, 0x132, 0xFF);
   }
 
   // 추가 센서 설정 값을 JSON 형식에 추가
-  p += sprintf(p, "\"xclk\":%u,", s->xclk_freq_hz / 1000000);
-  p += sprintf(p, "\"pixformat\":%u,", s->pixformat);
-  p += sprintf(p, "\"framesize\":%u,", s->status.framesize);
-  p += sprintf(p, "\"quality\":%u,", s->status.quality);
-  p += sprintf(p, "\"brightness\":%d,", s->status.brightness);
-  p += sprintf(p, "\"contrast\":%d,", s->status.contrast);
-  p += sprintf(p, "\"saturation\":%d,", s->status.saturation);
-  p += sprintf(p, "\"sharpness\":%d,", s->status.sharpness);
-  p += sprintf(p, "\"special_effect\":%u,", s->status.special_effect);
-  p += sprintf(p, "\"wb_mode\":%u,", s->status.wb_mode);
-  p += sprintf(p, "\"awb\":%u,", s->status.awb);
-  p += sprintf(p, "\"awb_gain\":%u,", s->status.awb_gain);
-  p += sprintf(p, "\"aec\":%u,", s->status.aec);
-  p += sprintf(p, "\"aec2\":%u,", s->status.aec2);
-  p += sprintf(p, "\"ae_level\":%d,", s->status.ae_level);
-  p += sprintf(p, "\"aec_value\":%u,", s->status.aec_value);
-  p += sprintf(p, "\"agc\":%u,", s->status.agc);
-  p += sprintf(p, "\"agc_gain\":%u,", s->status.agc_gain);
-  p += sprintf(p, "\"gainceiling\":%u,", s->status.gainceiling);
-  p += sprintf(p, "\"bpc\":%u,", s->status.bpc);
-  p += sprintf(p, "\"wpc\":%u,", s->status.wpc);
-  p += sprintf(p, "\"raw_gma\":%u,", s->status.raw_gma);
-  p += sprintf(p, "\"lenc\":%u,", s->status.lenc);
-  p += sprintf(p, "\"hmirror\":%u,", s->status.hmirror);
-  p += sprintf(p, "\"dcw\":%u,", s->status.dcw);
-  p += sprintf(p, "\"colorbar\":%u", s->status.colorbar);
+  jw_field(&w, "xclk", s->xclk_freq_hz / 1000000);
+  jw_field(&w, "pixformat", s->pixformat);
+  jw_field(&w, "framesize", s->status.framesize);
+  jw_field(&w, "quality", s->status.quality);
+  jw_field(&w, "brightness", s->status.brightness);
+  jw_field(&w, "contrast", s->status.contrast);
+  jw_field(&w, "saturation", s->status.saturation);
+  jw_field(&w, "sharpness", s->status.sharpness);
+  jw_field(&w, "special_effect", s->status.special_effect);
+  jw_field(&w, "wb_mode", s->status.wb_mode);
+  jw_field(&w, "awb", s->status.awb);
+  jw_field(&w, "awb_gain", s->status.awb_gain);
+  jw_field(&w, "aec", s->status.aec);
+  jw_field(&w, "aec2", s->status.aec2);
+  jw_field(&w, "ae_level", s->status.ae_level);
+  jw_field(&w, "aec_value", s->status.aec_value);
+  jw_field(&w, "agc", s->status.agc);
+  jw_field(&w, "agc_gain", s->status.agc_gain);
+  jw_field(&w, "gainceiling", s->status.gainceiling);
+  jw_field(&w, "bpc", s->status.bpc);
+  jw_field(&w, "wpc", s->status.wpc);
+  jw_field(&w, "raw_gma", s->status.raw_gma);
+  jw_field(&w, "lenc", s->status.lenc);
+  jw_field(&w, "hmirror", s->status.hmirror);
+  jw_field(&w, "dcw", s->status.dcw);
+  jw_field(&w, "colorbar", s->status.colorbar);
+  jw_field(&w, "adaptive", rc->enabled);
+  jw_field(&w, "rc_fps", rc->target_fps);
+  jw_field(&w, "rc_kbps", rc->max_kbps);
 #if CONFIG_LED_ILLUMINATOR_ENABLED
-  p += sprintf(p, ",\"led_intensity\":%u", led_duty);
+  jw_field(&w, "led_intensity", led_duty);
 #else
-  p += sprintf(p, ",\"led_intensity\":%d", -1);
+  jw_field(&w, "led_intensity", -1);
 #endif
-  *p++ = '}';  // JSON 닫는 중괄호
-  *p++ = 0;    // 문자열 종료
-  httpd_resp_set_type(req, "application/json");
-  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-  return httpd_resp_send(req, json_response, strlen(json_response));
+  jw_raw(&w, "}", 1);  // JSON 닫는 중괄호
+  if (w.overflow) {
+    log_e("Status JSON exceeds %u bytes", (unsigned)cap);
+    return 0;
+  }
+  return w.len;
+}
+
+// 센서 상태 정보를 JSON 형식으로 응답하는 핸들러 함수 (바뀐 것이 없으면 만들어 둔 응답을 보냄)
+static esp_err_t status_handler(httpd_req_t *req) {
+  rate_ctrl_state_t rc;
+  rate_ctrl_get(&rc);
+
+  xSemaphoreTake(status_lock, portMAX_DELAY);
+  uint32_t gen = status_gen.load(std::memory_order_relaxed);
+  if (gen != status_built_gen || rc.adjustments != status_built_adj) {
+    // 만드는 동안 설정이 또 바뀌면 gen 이 달라져 다음 요청에서 다시 만든다.
+    status_len = status_build(status_json, sizeof(status_json), &rc);
+    status_built_gen = status_len ? gen : 0;
+    status_built_adj = rc.adjustments;
+  }
+  esp_err_t res;
+  if (status_len) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    res = httpd_resp_send(req, status_json, status_len);
+  } else {
+    res = httpd_resp_send_500(req);
+  }
+  xSemaphoreGive(status_lock);
+  return res;
 }
 
 // XCLK 주파수를 설정하는 핸들러 함수
@@ -517,6 +1296,7 @@ static esp_err_t xclk_handler(httpd_req_t *req) {
   if (res) {
     return httpd_resp_send_500(req);
   }
+  status_invalidate();
 
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, NULL, 0);
@@ -551,6 +1331,7 @@ static esp_err_t reg_handler(httpd_req_t *req) {
   if (res) {
     return httpd_resp_send_500(req);
   }
+  status_invalidate();
 
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, NULL, 0);
@@ -588,13 +1369,320 @@ static esp_err_t greg_handler(httpd_req_t *req) {
   return httpd_resp_send(req, val, strlen(val));
 }
 
+// 여러 레지스터를 한 요청으로 쓰고 읽는다.
+//   /regs?write=<reg>:<mask>:<val>,<reg>:<val>,...&read=<reg>,<reg>,...
+// POST 로 같은 형식의 본문을 보내도 된다 (URI 길이 제한을 넘는 목록용). 숫자는 10 진수나 0x 16 진수,
+// 쓰기의 mask 를 빼면 0xFF. 쓰기를 요청 순서대로 모두 한 뒤 읽는다. 응답의 writes/reads 는 요청 순서의
+// 결과(음수: 실패)이고, calls 는 실제로 부른 get_reg/set_reg 횟수다.
+// OV3660/OV5640 은 주소가 이어진 레지스터를 최대 3 개씩 넓은 마스크의 get_reg/set_reg 한 번으로 묶는다.
+// OV2640 은 읽기를 주소(뱅크 비트 포함) 순으로 정렬해, 드라이버가 뱅크 선택을 뱅크마다 한 번만 쓰게 한다.
+#define REGS_MAX 64           // 쓰기, 읽기 각각
+#define REGS_BODY_MAX 2048
+
+typedef struct {
+  uint16_t reg;
+  uint8_t mask;
+  uint8_t val;
+  int res;
+} reg_op_t;
+
+// "a:b:c,d:e,..." 목록을 ops 에 채운다 (list 를 고쳐 씀). 쓰기는 필드 2~3 개, 읽기는 1 개.
+// 개수를 돌려주고, 형식이 틀렸거나 너무 많으면 -1.
+static int regs_parse(char *list, reg_op_t *ops, bool write) {
+  int n = 0;
+  for (char *save = NULL, *item = strtok_r(list, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+    long f[3];
+    int nf = 0;
+    char *p = item;
+    for (;;) {
+      char *end;
+      long v = strtol(p, &end, 0);
+      if (end == p || v < 0 || nf == 3 || (*end && *end != ':')) {
+        return -1;
+      }
+      f[nf++] = v;
+      if (!*end) {
+        break;
+      }
+      p = end + 1;
+    }
+    if (n == REGS_MAX || f[0] > 0xFFFF || (write ? nf < 2 : nf != 1)) {
+      return -1;
+    }
+    if (write && (f[nf - 1] > 0xFF || (nf == 3 && f[1] > 0xFF))) {
+      return -1;
+    }
+    ops[n].reg = f[0];
+    ops[n].mask = nf == 3 ? f[1] : 0xFF;
+    ops[n].val = write ? f[nf - 1] : 0;
+    ops[n].res = 0;
+    n++;
+  }
+  return n;
+}
+
+// 쓰기를 순서대로 한다. 16 비트 주소 센서는 이어진 레지스터를 set_reg 한 번으로 묶는다.
+static int regs_write(sensor_t *s, reg_op_t *ops, int n, bool wide) {
+  int calls = 0;
+  for (int i = 0; i < n;) {
+    int span = 1;
+    uint32_t mask = ops[i].mask, val = ops[i].val;
+    // 첫 바이트 마스크가 0 이면 넓은 마스크가 1 바이트 쓰기로 읽히므로 묶지 않는다.
+    while (wide && ops[i].mask && span < 3 && i + span < n && ops[i + span].reg == ops[i].reg + span) {
+      mask = mask << 8 | ops[i + span].mask;
+      val = val << 8 | ops[i + span].val;
+      span++;
+    }
+    int res = s->set_reg(s, ops[i].reg, mask, val);
+    calls++;
+    for (int k = i; k < i + span; k++) {
+      ops[k].res = res;
+    }
+    i += span;
+  }
+  return calls;
+}
+
+// 읽기를 주소 순으로 정렬해 읽는다. 16 비트 주소 센서는 이어진 레지스터를 get_reg 한 번으로 묶는다.
+static int regs_read(sensor_t *s, reg_op_t *ops, int n, bool wide) {
+  uint8_t ord[REGS_MAX];
+  for (int i = 0; i < n; i++) {
+    int j = i;
+    for (; j > 0 && ops[ord[j - 1]].reg > ops[i].reg; j--) {
+      ord[j] = ord[j - 1];
+    }
+    ord[j] = i;
+  }
+  int calls = 0;
+  for (int i = 0; i < n;) {
+    uint16_t base = ops[ord[i]].reg;
+    int span = 1;
+    int j = i + 1;
+    // 같은 레지스터가 거듭 나오면 한 번만 읽는다.
+    for (; j < n; j++) {
+      uint16_t reg = ops[ord[j]].reg;
+      if (reg == base + span - 1) {
+        continue;
+      }
+      if (!wide || span == 3 || reg != base + span) {
+        break;
+      }
+      span++;
+    }
+    int v = s->get_reg(s, base, span == 3 ? 0xFFFFFF : span == 2 ? 0xFFFF : 0xFF);
+    calls++;
+    for (int k = i; k < j; k++) {
+      int shift = 8 * (span - 1 - (ops[ord[k]].reg - base));
+      ops[ord[k]].res = v < 0 ? v : (v >> shift) & 0xFF;
+    }
+    i = j;
+  }
+  return calls;
+}
+
+static void regs_write_results(json_writer_t *w, const char *key, const reg_op_t *ops, int n) {
+  jw_raw(w, ",\"", 2);
+  jw_raw(w, key, strlen(key));
+  jw_raw(w, "\":[", 3);
+  for (int i = 0; i < n; i++) {
+    if (i) {
+      jw_raw(w, ",", 1);
+    }
+    jw_int(w, ops[i].res);
+  }
+  jw_raw(w, "]", 1);
+}
+
+static esp_err_t regs_handler(httpd_req_t *req) {
+  char *buf = NULL;
+  if (req->method == HTTP_POST) {
+    if (req->content_len == 0 || req->content_len > REGS_BODY_MAX) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Body empty or too large");
+      return ESP_FAIL;
+    }
+    buf = (char *)malloc(req->content_len + 1);
+    if (!buf) {
+      httpd_resp_send_500(req);
+      return ESP_FAIL;
+    }
+    size_t got = 0;
+    while (got < req->content_len) {
+      int r = httpd_req_recv(req, buf + got, req->content_len - got);
+      if (r <= 0) {
+        free(buf);
+        return ESP_FAIL;
+      }
+      got += r;
+    }
+    buf[got] = 0;
+  } else if (parse_get(req, &buf) != ESP_OK) {
+    return ESP_FAIL;
+  }
+
+  // 쓰기/읽기 목록, 값 버퍼, 응답을 한 번에 잡는다. len 은 홀수일 수 있으므로 정렬이 필요한 reg_op_t
+  // 배열을 블록 맨 앞(malloc 이 정렬해 줌)에 두고 문자열은 그 뒤에 둔다.
+  size_t len = strlen(buf) + 1;
+  size_t out_cap = 2 * REGS_MAX * 12 + 64;
+  char *mem = (char *)malloc(2 * REGS_MAX * sizeof(reg_op_t) + 2 * len + out_cap);
+  if (!mem) {
+    free(buf);
+    httpd_resp_send_500(req);
+    return ESP_FAIL;
+  }
+  reg_op_t *wops = (reg_op_t *)mem, *rops = wops + REGS_MAX;
+  char *wlist = (char *)(rops + REGS_MAX), *rlist = wlist + len, *out = rlist + len;
+  int nw = httpd_query_key_value(buf, "write", wlist, len) == ESP_OK ? regs_parse(wlist, wops, true) : 0;
+  int nr = httpd_query_key_value(buf, "read", rlist, len) == ESP_OK ? regs_parse(rlist, rops, false) : 0;
+  free(buf);
+  if (nw < 0 || nr < 0 || nw + nr == 0) {
+    free(mem);
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Expected write=reg:mask:val,... and/or read=reg,... (max 64 each)");
+    return ESP_FAIL;
+  }
+
+  sensor_t *s = esp_camera_sensor_get();
+  bool wide = s->id.PID == OV5640_PID || s->id.PID == OV3660_PID;
+  int calls = regs_write(s, wops, nw, wide);
+  if (nw) {
+    status_invalidate();
+  }
+  calls += regs_read(s, rops, nr, wide);
+  log_i("Registers: %d writes, %d reads, %d calls", nw, nr, calls);
+
+  json_writer_t w = {out, out_cap, 0, false, true};
+  jw_raw(&w, "{", 1);
+  jw_field(&w, "calls", calls);
+  regs_write_results(&w, "writes", wops, nw);
+  regs_write_results(&w, "reads", rops, nr);
+  jw_raw(&w, "}", 1);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  esp_err_t res = httpd_resp_send(req, out, w.len);
+  free(mem);
+  return res;
+}
+
 // GET 쿼리 문자열에서 정수형 변수 값을 파싱하는 헬퍼 함수
 static int parse_get_var(char *buf, const char *key, int def) {
   char _int[16];
   if (httpd_query_key_value(buf, key, _int, sizeof(_int)) != ESP_OK) {
     return def;
   }
-  return atoi(_int);
+  return atoi(_int);
+}
+
+typedef struct {
+  httpd_req_t *req;  // httpd_req_async_handler_begin() 으로 떼어 낸 요청
+  int n;
+  int interval_ms;
+  int64_t start;     // 요청을 받은 시각
+} burst_ctx_t;
+
+static int burst_metric = -1;  // 태스크에서 끝난 시각까지 재므로 register_timed 를 쓰지 않음
+
+// 찍고 보내는 태스크. 찍는 데 최대 5 초, 보내는 데 그 이상 걸리므로 제어 서버 태스크를 붙잡지 않도록
+// 따로 돈다.
+static void burst_task(void *arg) {
+  burst_ctx_t *ctx = (burst_ctx_t *)arg;
+  httpd_req_t *req = ctx->req;
+  int n = ctx->n;
+  esp_err_t res = ESP_FAIL;
+  int got = 0;
+  size_t total = 0;
+  burst_frame_t *frames = (burst_frame_t *)calloc(n, sizeof(burst_frame_t));
+  if (frames) {
+    got = burst_capture(frames, n, ctx->interval_ms);
+  }
+  if (got < 0) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_sendstr(req, "another burst is in progress");
+  } else if (got == 0) {
+    httpd_resp_send_500(req);
+  } else {
+    char hdr[12];  // 첫 전송 때까지 살아 있어야 한다
+    httpd_resp_set_type(req, _MULTI_CONTENT_TYPE);
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    snprintf(hdr, sizeof(hdr), "%d", got);
+    httpd_resp_set_hdr(req, "X-Frame-Count", hdr);
+
+    int64_t t0 = esp_timer_get_time();
+    char part[160];
+    res = ESP_OK;
+    for (int i = 0; i < got && res == ESP_OK; i++) {
+      burst_frame_t *f = &frames[i];
+      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+      if (res == ESP_OK) {
+        size_t hlen = snprintf(part, sizeof(part), _MULTI_PART, (unsigned)f->len, (long long)f->timestamp.tv_sec,
+                               (long)f->timestamp.tv_usec, i);
+        res = httpd_resp_send_chunk(req, part, hlen);
+      }
+      if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, (const char *)f->buf, f->len);
+        total += f->len;
+      }
+    }
+    if (res == ESP_OK) {
+      res = httpd_resp_sendstr_chunk(req, "\r\n--" PART_BOUNDARY "--\r\n");
+    }
+    if (res == ESP_OK) {
+      res = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    trace_span("send", t0, total);
+    if (res != ESP_OK) {
+      metrics_add(METRIC_SEND_FAILED, 1);
+    }
+    burst_free(frames, got);
+  }
+  free(frames);
+  log_i("Burst: %d/%d frames, %uB", got, n, (uint32_t)total);
+  metrics_endpoint_observe(burst_metric, esp_timer_get_time() - ctx->start);
+  httpd_req_async_handler_complete(req);
+  free(ctx);
+  vTaskDelete(NULL);
+}
+
+// 여러 장을 일정한 간격으로 찍어 multipart 응답 하나로 보내는 핸들러
+// 예: /burst?n=16&interval_ms=50 (기본 n=8, interval_ms=100). 모두 찍은 뒤에 보낸다.
+static esp_err_t burst_handler(httpd_req_t *req) {
+  int64_t start = esp_timer_get_time();
+  int n = 8;
+  int interval_ms = 100;
+  char query[48];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+    n = parse_get_var(query, "n", n);
+    interval_ms = parse_get_var(query, "interval_ms", interval_ms);
+  }
+  if (n < 1 || n > BURST_MAX_FRAMES || interval_ms < 0 || interval_ms > BURST_MAX_SPAN_MS ||
+      n * interval_ms > BURST_MAX_SPAN_MS) {
+    httpd_resp_set_status(req, "400 Bad Request");
+    esp_err_t res = httpd_resp_sendstr(req, "n must be 1..32 and n * interval_ms at most 5000");
+    metrics_endpoint_observe(burst_metric, esp_timer_get_time() - start);
+    return res;
+  }
+
+  burst_ctx_t *ctx = (burst_ctx_t *)calloc(1, sizeof(burst_ctx_t));
+  if (!ctx) {
+    httpd_resp_send_500(req);
+    return ESP_FAIL;
+  }
+  ctx->n = n;
+  ctx->interval_ms = interval_ms;
+  ctx->start = start;
+  esp_err_t res = httpd_req_async_handler_begin(req, &ctx->req);
+  if (res != ESP_OK) {
+    free(ctx);
+    return res;
+  }
+  httpd_req_t *async_req = ctx->req;
+  // 스트림보다 낮은 우선순위로, 스트림 코어가 아닌 곳에서 돈다.
+  if (xTaskCreatePinnedToCore(burst_task, "burst", 4096, ctx, 3, NULL, 1 - STREAM_CORE) != pdPASS) {
+    log_e("Burst task create failed");
+    free(ctx);
+    httpd_resp_send_500(async_req);
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
 }
 
 // PLL(Phase-Locked Loop) 설정을 처리하는 핸들러 함수
@@ -622,6 +1710,7 @@ static esp_err_t pll_handler(httpd_req_t *req) {
   if (res) {
     return httpd_resp_send_500(req);
   }
+  status_invalidate();
 
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, NULL, 0);
@@ -657,6 +1746,7 @@ static esp_err_t win_handler(httpd_req_t *req) {
   if (res) {
     return httpd_resp_send_500(req);
   }
+  status_invalidate();
 
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, NULL, 0);
@@ -675,37 +1765,718 @@ static esp_err_t index_handler(httpd_req_t *req) {
   }
 }
 
-extern float cachedHumidity;
-extern float cachedTemperature;
-extern int   cachedFlame;
-
+// 온도/습도를 JSON으로 반환. seq 는 센서 스냅샷 번호, timestamp_us 는 DHT22 를 읽은 시각이다.
 static esp_err_t dht_handler(httpd_req_t *req) {
-  if (isnan(cachedHumidity) || isnan(cachedTemperature)) {
+  sensor_snapshot_t snap;
+  sensor_snapshot_read(&snap);
+  if (isnan(snap.humidity) || isnan(snap.temperature)) {
     return httpd_resp_send_500(req);
   }
-  char buf[64];
+  char buf[128];
   int len = snprintf(buf, sizeof(buf),
-                     "{\"temperature\":%.2f,\"humidity\":%.2f}",
-                     cachedTemperature, cachedHumidity);
+                     "{\"temperature\":%.2f,\"humidity\":%.2f,\"seq\":%lu,\"timestamp_us\":%lld}",
+                     snap.temperature, snap.humidity, (unsigned long)snap.seq, (long long)snap.dht_us);
   httpd_resp_set_type(req, "application/json");
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, buf, len);
 }
-// 불꽃 센서 상태를 JSON으로 반환 
+// 불꽃 센서 상태를 JSON으로 반환
+// flame 은 0: 불꽃 감지, 1: 정상. edges 는 최근 에지(새것부터), latency_us 는 에지가 일어난 뒤
+// 처음으로 응답에 실리기까지 걸린 시간 통계다. ?n= 으로 에지 개수를 정한다 (기본 8).
+#define FLAME_HTTP_EDGES 8
+#define FLAME_HTTP_EDGES_MAX 16
+
 static esp_err_t flame_handler(httpd_req_t *req) {
-  int flame = cachedFlame;  // 0: 불꽃 감지, 1: 정상
-  char buf[32]; // JSON 포맷으로
-  int len = snprintf(buf, sizeof(buf), "{\"flame\":%d}", flame);
+  int want = FLAME_HTTP_EDGES;
+  char query[32];
+  char value[8];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK
+      && httpd_query_key_value(query, "n", value, sizeof(value)) == ESP_OK) {
+    want = constrain(atoi(value), 0, FLAME_HTTP_EDGES_MAX);
+  }
+
+  sensor_snapshot_t snap;
+  flame_edge_t edges[FLAME_HTTP_EDGES_MAX];
+  flame_stats_t fs;
+  sensor_snapshot_read(&snap);
+  const flame_state_t &st = snap.flame;
+  size_t n = flame_sensor_recent(edges, want);
+  int64_t now = esp_timer_get_time();
+  flame_sensor_mark_served(&st, now);
+  flame_sensor_get_stats(&fs);
+
+  char buf[1024];
+  int len = snprintf(buf, sizeof(buf), "{\"flame\":%d,\"seq\":%lu,\"last_edge_us\":%lld,\"now_us\":%lld,\"edges\":[",
+                     st.state, (unsigned long)st.seq, (long long)st.last_edge_us, (long long)now);
+  for (size_t i = 0; i < n; i++) {
+    len += snprintf(buf + len, sizeof(buf) - len, "%s{\"seq\":%lu,\"v\":%u,\"t\":%lld}", i ? "," : "",
+                    (unsigned long)edges[i].seq, edges[i].level, (long long)edges[i].time_us);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len,
+                  "],\"bounces\":%lu,\"latency_us\":{\"n\":%lu,\"last\":%lld,\"avg\":%lld,\"max\":%lld}}",
+                  (unsigned long)fs.bounces, (unsigned long)fs.latency_samples, (long long)fs.latency_last_us,
+                  (long long)(fs.latency_samples ? fs.latency_sum_us / fs.latency_samples : 0),
+                  (long long)fs.latency_max_us);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, buf, len);
+}
+
+// 센서 기록을 돌려준다. /history?since=<seq>[&format=bin]
+// since 보다 큰 seq 의 기록을 모두 보낸다. 응답의 last_seq 를 다음 요청의 since 로 쓰면 된다.
+// JSON 은 records 의 각 항목이 [dt_ms, type, flame, 온도(0.01°C), 습도(0.01%)] 이고, 첫 기록의 시각이
+// first_ms(부팅 후 ms)이며 그 뒤는 dt_ms 를 더해 구한다. lost 는 덮어써져 받지 못한 기록 수다.
+// format=bin 은 hist_bin_hdr_t 뒤에 hist_record_t(8 바이트)를 이어 붙인다 (리틀 엔디언).
+#define HIST_HTTP_BATCH 32  // 한 번에 읽어 보내는 기록 수 (httpd 스택 4KB 안에 버퍼를 둔다)
+
+typedef struct __attribute__((packed)) {
+  uint32_t first_seq;    // 첫 기록의 seq (기록이 없으면 0)
+  uint32_t lost;
+  int64_t first_us;      // 첫 기록의 시각 (부팅 후 us)
+  int64_t now_us;        // 응답을 만든 시각
+} hist_bin_hdr_t;
+
+static esp_err_t history_handler(httpd_req_t *req) {
+  uint32_t since = 0;
+  bool bin = false;
+  char query[64];
+  char value[16];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+    if (httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+      since = strtoul(value, NULL, 10);
+    }
+    if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+      bin = !strcmp(value, "bin");
+    }
+  }
+
+  hist_record_t recs[HIST_HTTP_BATCH];
+  uint32_t first_seq = 0;
+  int64_t first_us = 0;
+  // 보내는 동안 들어오는 기록까지 따라가지 않도록 시작할 때의 마지막 seq 까지만 보낸다.
+  uint32_t end = sensor_history_last_seq();
+  size_t n = since < end ? sensor_history_read(since, recs, min((uint32_t)HIST_HTTP_BATCH, end - since), &first_seq, &first_us) : 0;
+  uint32_t lost = n && first_seq > since + 1 ? first_seq - since - 1 : 0;
+  int64_t now = esp_timer_get_time();
+
+  httpd_resp_set_type(req, bin ? "application/octet-stream" : "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  char buf[HIST_HTTP_BATCH * 28 + 96];  // 기록 하나는 JSON 으로 최대 27 자
+  int len;
+  if (bin) {
+    hist_bin_hdr_t hdr = { first_seq, lost, first_us, now };
+    memcpy(buf, &hdr, sizeof(hdr));
+    len = sizeof(hdr);
+  } else {
+    len = snprintf(buf, sizeof(buf), "{\"first_seq\":%lu,\"first_ms\":%lld,\"lost\":%lu,\"records\":[",
+                   (unsigned long)first_seq, (long long)(first_us / 1000), (unsigned long)lost);
+  }
+
+  esp_err_t res = ESP_OK;
+  uint32_t next = first_seq;  // 다음에 받을 seq
+  bool first = true;
+  while (n > 0 && res == ESP_OK) {
+    if (bin) {
+      res = httpd_resp_send_chunk(req, buf, len);
+      len = 0;
+      if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, (const char *)recs, n * sizeof(hist_record_t));
+      }
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        len += snprintf(buf + len, sizeof(buf) - len, "%s[%u,%u,%d,%d,%u]", first ? "" : ",", recs[i].dt_ms,
+                        recs[i].type, recs[i].flame, recs[i].temperature, recs[i].humidity);
+        first = false;
+      }
+      res = httpd_resp_send_chunk(req, buf, len);
+      len = 0;
+    }
+    next += n;
+    uint32_t seq;
+    int64_t us;
+    n = next <= end ? sensor_history_read(next - 1, recs, min((uint32_t)HIST_HTTP_BATCH, end - next + 1), &seq, &us) : 0;
+    if (n && seq != next) {
+      // 보내는 사이에 링이 한 바퀴 돌아 이어지지 않는다. 여기까지만 보내고, 나머지는 다음 요청의 lost 로 알린다.
+      n = 0;
+    }
+  }
+  if (res == ESP_OK && !bin) {
+    len += snprintf(buf + len, sizeof(buf) - len, "],\"last_seq\":%lu,\"now_ms\":%lld}",
+                   (unsigned long)(first_seq ? next - 1 : min(since, end)), (long long)(now / 1000));
+    res = httpd_resp_send_chunk(req, buf, len);
+  } else if (res == ESP_OK && len) {
+    res = httpd_resp_send_chunk(req, buf, len);  // 기록이 없을 때의 헤더
+  }
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(req, NULL, 0);
+  }
+  return res;
+}
+
+// 온보드 불꽃 후보 분석 결과. 예:
+// {"seq":812,"frame_ms":81234,"width":40,"height":30,"fire_pixels":37,"fire_ratio":0.0308,"box":[96,64,72,80],
+//  "roi":[88,56,88,96],"flicker":{"samples":64,"rate_hz":24.9,"depth":0.214,"peak_hz":6.23,"flickering":true},...}
+static esp_err_t fire_handler(httpd_req_t *req) {
+  analysis_result_t r;
+  analysis_stats_t st;
+  analysis_get(&r);
+  analysis_get_stats(&st);
+  char buf[512];
+  int len = snprintf(buf, sizeof(buf),
+                     "{\"seq\":%lu,\"frame_ms\":%lld,\"width\":%u,\"height\":%u,\"fire_pixels\":%lu,\"fire_ratio\":%.4f,",
+                     (unsigned long)r.seq, (long long)(r.frame_us / 1000), r.width, r.height,
+                     (unsigned long)r.fire_pixels, r.fire_ratio);
+  if (r.fire_pixels) {
+    len += snprintf(buf + len, sizeof(buf) - len, "\"box\":[%u,%u,%u,%u],", r.box_x, r.box_y, r.box_w, r.box_h);
+  } else {
+    len += snprintf(buf + len, sizeof(buf) - len, "\"box\":null,");
+  }
+  if (r.tracking) {
+    const flicker_result_t &fl = r.flicker;
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    "\"roi\":[%u,%u,%u,%u],\"flicker\":{\"samples\":%u,\"rate_hz\":%.1f,\"depth\":%.3f,"
+                    "\"peak_hz\":%.2f,\"flickering\":%s},",
+                    r.roi_x, r.roi_y, r.roi_w, r.roi_h, fl.samples, fl.rate_hz, fl.depth, fl.peak_hz,
+                    fl.flickering ? "true" : "false");
+  } else {
+    len += snprintf(buf + len, sizeof(buf) - len, "\"roi\":null,\"flicker\":null,");
+  }
+  len += snprintf(buf + len, sizeof(buf) - len,
+                  "\"fire_moving\":%lu,\"motion_pixels\":%lu,\"scene_changed\":%s,",
+                  (unsigned long)r.fire_moving, (unsigned long)r.motion_pixels,
+                  analysis_scene_changed() ? "true" : "false");
+  len += snprintf(buf + len, sizeof(buf) - len,
+                  "\"decode_us\":%lu,\"kernel_us\":%lu,\"frames\":%lu,\"overruns\":%lu,\"budget_us\":%d}",
+                  (unsigned long)r.decode_us, (unsigned long)r.kernel_us, (unsigned long)st.frames,
+                  (unsigned long)st.overruns, ANALYSIS_BUDGET_US);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, buf, len);
+}
+
+static const char *const event_state_names[] = {"off", "recording", "post", "frozen"};
+
+// 사건 전 기록 상태. 예: {"state":"frozen","trigger":"flame","trigger_ms":81234,"events":1,"frames":212,...}
+static esp_err_t event_handler(httpd_req_t *req) {
+  event_status_t st;
+  event_clip_get_status(&st);
+  char buf[256];
+  int len = snprintf(buf, sizeof(buf),
+                     "{\"state\":\"%s\",\"trigger\":\"%s\",\"trigger_ms\":%lld,\"events\":%lu,\"frames\":%lu,"
+                     "\"bytes\":%u,\"capacity\":%u,\"span_ms\":%lld}",
+                     event_state_names[st.state], event_trigger_name(st.trigger), (long long)(st.trigger_us / 1000),
+                     (unsigned long)st.events, (unsigned long)st.frames, (unsigned)st.bytes, (unsigned)st.capacity,
+                     (long long)((st.last_us - st.first_us) / 1000));
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_send(req, buf, len);
+}
+
+static esp_err_t event_trigger_handler(httpd_req_t *req) {
+  event_clip_trigger(EVENT_TRIGGER_MANUAL);
+  return event_handler(req);
+}
+
+static esp_err_t event_rearm_handler(httpd_req_t *req) {
+  if (event_clip_rearm() != ESP_OK) {
+    httpd_resp_set_status(req, "409 Conflict");
+    return httpd_resp_sendstr(req, "clip is being downloaded");
+  }
+  return event_handler(req);
+}
+
+typedef struct {
+  httpd_req_t *req;  // httpd_req_async_handler_begin() 으로 떼어 낸 요청
+  event_clip_t clip;
+  bool avi;
+  char count[12];    // X-Frame-Count 값. httpd 는 헤더 포인터만 들고 있다가 clip_task 의 첫 전송 때 보낸다.
+} clip_ctx_t;
+
+static esp_err_t clip_send_chunk(void *arg, const uint8_t *data, size_t len) {
+  return httpd_resp_send_chunk((httpd_req_t *)arg, (const char *)data, len);
+}
+
+// 언 클립을 보내는 태스크. 클립이 수 MB 일 수 있어 제어 서버 태스크를 붙잡지 않도록 따로 보낸다.
+static void clip_task(void *arg) {
+  clip_ctx_t *ctx = (clip_ctx_t *)arg;
+  httpd_req_t *req = ctx->req;
+  const event_clip_t *clip = &ctx->clip;
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t res = ESP_OK;
+  if (ctx->avi) {
+    res = event_clip_write_avi(clip, clip_send_chunk, req);
+  } else {
+    char part[160];
+    for (uint32_t i = 0; i < clip->count && res == ESP_OK; i++) {
+      const event_frame_t *f = event_clip_frame(clip, i);
+      res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+      if (res == ESP_OK) {
+        size_t hlen = snprintf(part, sizeof(part), _MULTI_PART, (unsigned)f->len, (long long)(f->time_us / 1000000),
+                               (long)(f->time_us % 1000000), (int)i);
+        res = httpd_resp_send_chunk(req, part, hlen);
+      }
+      if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, (const char *)clip->ring + f->off, f->len);
+      }
+    }
+    if (res == ESP_OK) {
+      res = httpd_resp_sendstr_chunk(req, "\r\n--" PART_BOUNDARY "--\r\n");
+    }
+  }
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(req, NULL, 0);
+  } else {
+    metrics_add(METRIC_SEND_FAILED, 1);
+  }
+  trace_span("clip_send", t0, clip->count);
+  event_clip_close(&ctx->clip);
+  httpd_req_async_handler_complete(req);
+  free(ctx);
+  vTaskDelete(NULL);
+}
+
+// 언 클립을 보낸다. ?format=avi 면 MJPEG AVI 파일 하나, 아니면 /burst 와 같은 multipart/mixed.
+static esp_err_t event_clip_handler(httpd_req_t *req) {
+  bool avi = false;
+  char query[32];
+  char value[16];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+    avi = !strcmp(value, "avi");
+  }
+  clip_ctx_t *ctx = (clip_ctx_t *)calloc(1, sizeof(clip_ctx_t));
+  if (!ctx) {
+    httpd_resp_send_500(req);
+    return ESP_FAIL;
+  }
+  if (event_clip_open(&ctx->clip) != ESP_OK) {
+    free(ctx);
+    httpd_resp_send_404(req);
+    return ESP_FAIL;
+  }
+  ctx->avi = avi;
+
+  httpd_resp_set_type(req, avi ? "video/x-msvideo" : _MULTI_CONTENT_TYPE);
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  if (avi) {
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=event.avi");
+  }
+  snprintf(ctx->count, sizeof(ctx->count), "%lu", (unsigned long)ctx->clip.count);
+  httpd_resp_set_hdr(req, "X-Frame-Count", ctx->count);
+
+  esp_err_t res = httpd_req_async_handler_begin(req, &ctx->req);
+  if (res != ESP_OK) {
+    event_clip_close(&ctx->clip);
+    free(ctx);
+    return res;
+  }
+  httpd_req_t *async_req = ctx->req;
+  // 스트림보다 낮은 우선순위로, 스트림 코어가 아닌 곳에서 보낸다.
+  if (xTaskCreatePinnedToCore(clip_task, "clip", 4096, ctx, 3, NULL, 1 - STREAM_CORE) != pdPASS) {
+    log_e("Clip task create failed");
+    event_clip_close(&ctx->clip);
+    free(ctx);
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+// 부팅 단계별 완료 시각(ms, 앱 시작 기준)을 JSON으로 반환. 아직 마치지 않은 단계는 null.
+// wifi 는 이번 부팅의 접속 방식 (scan/bssid, wifi_link.h 참고)
+static esp_err_t boot_handler(httpd_req_t *req) {
+  char buf[256];
+  int len = snprintf(buf, sizeof(buf), "{\"reset_reason\":%d,\"wifi\":\"%s\"", (int)esp_reset_reason(),
+                     wifi_link_mode_name(wifi_link_mode()));
+  for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+    int64_t t = boot_time_us((boot_stage_t)i);
+    const char *name = boot_stage_name((boot_stage_t)i);
+    if (t) {
+      len += snprintf(buf + len, sizeof(buf) - len, ",\"%s_ms\":%lld", name, (long long)(t / 1000));
+    } else {
+      len += snprintf(buf + len, sizeof(buf) - len, ",\"%s_ms\":null", name);
+    }
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "}");
   httpd_resp_set_type(req, "application/json");
   httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
   return httpd_resp_send(req, buf, len);
 }
 
+// 구간 타임라인을 Chrome trace-event JSON 으로 반환 (chrome://tracing, ui.perfetto.dev 에서 열림)
+// ?since=<seq> 를 주면 그 뒤의 기록만 보낸다. otherData.last_seq 를 다음 요청의 since 로 쓰면 된다.
+// ts/dur 는 us, tid 는 태스크, args.arg 는 구간별 값(바이트 수, DHT 는 오류 코드)이다.
+#define TRACE_HTTP_BATCH 8    // 한 번에 복사해 보내는 기록 수 (httpd 스택에 둠)
+#define TRACE_JSON_EVENT 192  // 기록 하나의 JSON 최대 길이
+
+static esp_err_t trace_handler(httpd_req_t *req) {
+  uint32_t since = 0;
+  char query[32];
+  char value[16];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+    since = strtoul(value, NULL, 10);
+  }
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+  trace_event_t evs[TRACE_HTTP_BATCH];
+  char buf[TRACE_HTTP_BATCH * TRACE_JSON_EVENT];
+  int len = snprintf(buf, sizeof(buf), "{\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                                       "\"args\":{\"name\":\"esp32-cam\"}}");
+  // 보내는 동안 들어오는 기록까지 따라가지 않도록 시작할 때의 마지막 seq 까지만 보낸다.
+  uint32_t end = trace_last_seq();
+  uint32_t first_seq = 0;
+  uint32_t next = since;  // 마지막으로 보낸 seq
+  uint32_t lost = 0;
+  esp_err_t res = ESP_OK;
+  size_t n;
+  while (res == ESP_OK && next < end && (n = trace_read(next, evs, min((uint32_t)TRACE_HTTP_BATCH, end - next))) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      const trace_event_t *e = &evs[i];
+      if (!first_seq) {
+        first_seq = e->seq;
+      }
+      lost += e->seq - next - 1;  // 덮어써져 건너뛴 기록
+      next = e->seq;
+      len += snprintf(buf + len, sizeof(buf) - len,
+                      ",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lu,\"pid\":1,\"tid\":%u,"
+                      "\"args\":{\"seq\":%lu,\"arg\":%lu,\"core\":%u}}",
+                      e->name, (long long)e->start_us, (unsigned long)e->dur_us, e->task, (unsigned long)e->seq,
+                      (unsigned long)e->arg, e->core);
+    }
+    res = httpd_resp_send_chunk(req, buf, len);
+    len = 0;
+  }
+  if (res != ESP_OK) {
+    return res;
+  }
+
+  // 태스크 이름은 마지막에 싣는다 (보내는 사이에 처음 기록한 태스크도 포함되도록).
+  const char *name;
+  for (int t = 0; (name = trace_task_name(t)) != NULL; t++) {
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    t, name);
+    if (len > (int)sizeof(buf) - TRACE_JSON_EVENT) {
+      res = httpd_resp_send_chunk(req, buf, len);
+      len = 0;
+      if (res != ESP_OK) {
+        return res;
+      }
+    }
+  }
+  len += snprintf(buf + len, sizeof(buf) - len,
+                  "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"first_seq\":%lu,\"last_seq\":%lu,\"lost\":%lu,"
+                  "\"overhead_ns\":%lu,\"now_us\":%lld}}",
+                  (unsigned long)first_seq, (unsigned long)max(next, min(since, end)), (unsigned long)lost,
+                  (unsigned long)trace_overhead_ns(), (long long)esp_timer_get_time());
+  res = httpd_resp_send_chunk(req, buf, len);
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(req, NULL, 0);
+  }
+  return res;
+}
+
+// 성능 지표를 Prometheus 텍스트 형식으로 반환 (metrics.h 참고)
+static esp_err_t metrics_send_chunk(void *arg, const char *data, size_t len) {
+  return httpd_resp_send_chunk((httpd_req_t *)arg, data, len);
+}
+
+static esp_err_t metrics_handler(httpd_req_t *req) {
+  httpd_resp_set_type(req, "text/plain; version=0.0.4");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  esp_err_t res = metrics_write(metrics_send_chunk, req);
+  if (res == ESP_OK) {
+    res = httpd_resp_send_chunk(req, NULL, 0);
+  }
+  return res;
+}
+
+// 제어 서버 핸들러의 실행 시간을 /metrics 의 엔드포인트별 히스토그램에 남기도록 감싼다.
+// 원래 핸들러는 user_ctx 를 쓰지 않으므로 그 자리에 감싼 정보를 둔다.
+typedef struct {
+  esp_err_t (*handler)(httpd_req_t *req);
+  int metric;  // metrics_endpoint_register() 번호
+} timed_handler_t;
+
+static timed_handler_t timed_handlers[METRICS_ENDPOINTS];
+static size_t timed_count;
+
+static esp_err_t timed_handler(httpd_req_t *req) {
+  const timed_handler_t *t = (const timed_handler_t *)req->user_ctx;
+  int64_t start = esp_timer_get_time();
+  esp_err_t res = t->handler(req);
+  metrics_endpoint_observe(t->metric, esp_timer_get_time() - start);
+  return res;
+}
+
+static esp_err_t register_timed(httpd_handle_t server, httpd_uri_t *uri) {
+  if (timed_count < METRICS_ENDPOINTS) {
+    timed_handler_t *t = &timed_handlers[timed_count++];
+    t->handler = uri->handler;
+    t->metric = metrics_endpoint_register(uri->uri, uri->method == HTTP_POST ? "POST" : "GET");
+    uri->handler = timed_handler;
+    uri->user_ctx = t;
+  }
+  return httpd_register_uri_handler(server, uri);
+}
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+// ===========================
+// /ws: JPEG 프레임과 센서 값을 하나의 WebSocket 으로 보낸다
+// ===========================
+// 모든 메시지는 바이너리이며 첫 바이트가 종류다. 다중 바이트 값은 리틀 엔디언.
+#define WS_MSG_FRAME  0x01   // ws_frame_hdr_t 뒤에 JPEG 데이터
+#define WS_MSG_SENSOR 0x02   // ws_sensor_pkt_t
+#define WS_SENSOR_INTERVAL_MS 1000  // 센서 패킷 주기 (센서 값이 갱신되면 즉시 보냄)
+#define WS_POLL_MS 100              // 프레임이 없을 때 센서/클라이언트 메시지를 확인하는 간격
+
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // WS_MSG_FRAME
+  uint8_t reserved[3];
+  uint32_t seq;          // 브로드캐스터 발행 순번 (건너뛴 번호는 이 클라이언트에서 버려진 프레임)
+  int64_t timestamp_us;  // 캡처 시각
+  uint16_t width;
+  uint16_t height;
+} ws_frame_hdr_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t type;          // WS_MSG_SENSOR
+  int8_t flame;          // /flame 과 같음 (0: 불꽃 감지, 1: 정상, -1: 아직 읽지 않음)
+  int16_t temperature;   // 0.01°C 단위, 읽기 실패면 INT16_MIN
+  uint16_t humidity;     // 0.01% 단위, 읽기 실패면 UINT16_MAX
+  uint16_t flicker;      // 후보 영역의 깜빡임 depth, 0.1% 단위 (후보가 없거나 창이 차기 전이면 0)
+  uint32_t uptime_ms;
+} ws_sensor_pkt_t;
+
+typedef struct {
+  httpd_req_t *req;      // httpd_req_async_handler_begin() 으로 떼어 낸 핸드셰이크 요청
+  broadcast_sub_t *sub;
+  int fd;
+  uint32_t writes;
+  uint32_t idle_ms;      // stream_ctx_t 와 같음
+} ws_ctx_t;
+
+// 바이너리 메시지 하나를 WebSocket 헤더와 함께 writev 한 번으로 보낸다. (서버 프레임은 마스크 없음)
+static esp_err_t ws_send_binary(ws_ctx_t *ctx, const void *head, size_t head_len, const uint8_t *body, size_t body_len) {
+  uint8_t hdr[10];
+  size_t hlen = 2;
+  uint64_t len = head_len + body_len;
+  hdr[0] = 0x80 | HTTPD_WS_TYPE_BINARY;
+  if (len < 126) {
+    hdr[1] = len;
+  } else if (len < 65536) {
+    hdr[1] = 126;
+    hdr[2] = len >> 8;
+    hdr[3] = len;
+    hlen = 4;
+  } else {
+    hdr[1] = 127;
+    for (int i = 0; i < 8; i++) {
+      hdr[2 + i] = len >> (56 - i * 8);
+    }
+    hlen = 10;
+  }
+  struct iovec iov[3] = {
+    { hdr, hlen },
+    { (void *)head, head_len },
+    { (void *)body, body_len },
+  };
+  return sock_writev_all(ctx->fd, iov, body_len ? 3 : 2, &ctx->writes);
+}
+
+static esp_err_t ws_send_sensors(ws_ctx_t *ctx, const sensor_snapshot_t *snap) {
+  ws_sensor_pkt_t pkt = {};
+  float t = snap->temperature;
+  float h = snap->humidity;
+  pkt.type = WS_MSG_SENSOR;
+  pkt.flame = snap->flame.state;
+  pkt.temperature = isnan(t) ? INT16_MIN : (int16_t)lroundf(t * 100);
+  pkt.humidity = isnan(h) ? UINT16_MAX : (uint16_t)lroundf(h * 100);
+  analysis_result_t ar;
+  analysis_get(&ar);
+  pkt.flicker = (uint16_t)min(lroundf(ar.flicker.depth * 1000), 65535L);
+  pkt.uptime_ms = millis();
+  return ws_send_binary(ctx, &pkt, sizeof(pkt), NULL, 0);
+}
+
+// 클라이언트가 보낸 프레임이 있으면 처리한다. PING 에는 PONG, CLOSE 에는 CLOSE 로 답하고 끝낸다.
+// 데이터 프레임은 지금은 쓰지 않으므로 읽고 버린다. 제어 프레임은 본문이 125 바이트를 넘지 않으니
+// payload 보다 긴 프레임은 데이터 프레임이고, 연결을 끊지 않고 payload 크기씩 나눠 읽어 버린다.
+static esp_err_t ws_poll_client(ws_ctx_t *ctx) {
+  fd_set rd;
+  struct timeval tv = { 0, 0 };
+  FD_ZERO(&rd);
+  FD_SET(ctx->fd, &rd);
+  if (select(ctx->fd + 1, &rd, NULL, NULL, &tv) <= 0) {
+    return ESP_OK;
+  }
+  uint8_t payload[128];
+  httpd_ws_frame_t pkt = {};
+  pkt.payload = payload;
+  if (httpd_ws_recv_frame(ctx->req, &pkt, 0) != ESP_OK) {
+    return ESP_FAIL;
+  }
+  if (pkt.len > sizeof(payload)) {
+    // pkt.len 이 0 이 아니면 httpd_ws_recv_frame 은 헤더를 다시 읽지 않고 본문을 그만큼만 읽는다.
+    for (size_t left = pkt.len; left > 0; left -= pkt.len) {
+      pkt.len = min(left, sizeof(payload));
+      if (httpd_ws_recv_frame(ctx->req, &pkt, sizeof(payload)) != ESP_OK) {
+        return ESP_FAIL;
+      }
+    }
+    return ESP_OK;
+  }
+  if (httpd_ws_recv_frame(ctx->req, &pkt, sizeof(payload)) != ESP_OK) {
+    return ESP_FAIL;
+  }
+  if (pkt.type == HTTPD_WS_TYPE_PING) {
+    pkt.type = HTTPD_WS_TYPE_PONG;
+    return httpd_ws_send_frame(ctx->req, &pkt);
+  }
+  if (pkt.type == HTTPD_WS_TYPE_CLOSE) {
+    pkt.len = pkt.len > 2 ? 2 : pkt.len;  // 상태 코드만 돌려준다
+    httpd_ws_send_frame(ctx->req, &pkt);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+static void ws_task(void *arg) {
+  ws_ctx_t *ctx = (ws_ctx_t *)arg;
+  esp_err_t res = ESP_OK;
+  uint32_t sent = 0;
+  uint32_t last_sensor_seq = UINT32_MAX;
+  int64_t next_sensor = 0;
+  int64_t last_frame = esp_timer_get_time();
+  int64_t last_sent = 0;
+
+  while (res == ESP_OK) {
+    broadcast_frame_t *frame = broadcast_wait_frame(ctx->sub, pdMS_TO_TICKS(WS_POLL_MS));
+    int64_t now = esp_timer_get_time();
+    if (frame && stream_thin(ctx->idle_ms, last_sent, now)) {
+      broadcast_release(frame);
+      metrics_add(METRIC_FRAMES_THINNED, 1);
+      last_frame = now;
+    } else if (frame) {
+      last_sent = now;
+      ws_frame_hdr_t hdr = {};
+      hdr.type = WS_MSG_FRAME;
+      hdr.seq = frame->seq;
+      hdr.timestamp_us = (int64_t)frame->timestamp.tv_sec * 1000000 + frame->timestamp.tv_usec;
+      hdr.width = frame->width;
+      hdr.height = frame->height;
+      res = ws_send_binary(ctx, &hdr, sizeof(hdr), frame->buf, frame->len);
+      trace_span("ws_send", now, frame->len);
+      int64_t sent_at = esp_timer_get_time();
+      if (res == ESP_OK) {
+        sent++;
+        rate_ctrl_report(ctx->sub, sent_at - now, frame->len);
+        metrics_add(METRIC_FRAMES_SENT, 1);
+        metrics_observe(METRIC_FRAME_SEND, sent_at - now);
+      } else {
+        metrics_add(METRIC_SEND_FAILED, 1);
+      }
+      broadcast_release(frame);
+      last_frame = now;
+    } else if (now - last_frame > 5000000) {
+      // 센서 값은 계속 보내고, 프레임이 끊긴 것만 알린다.
+      log_e("Camera capture failed");
+      last_frame = now;
+    }
+
+    // 센서 패킷: 주기마다, 그리고 센서 값이 갱신되면(불꽃 에지, DHT 읽기) 바로
+    sensor_snapshot_t snap;
+    sensor_snapshot_read(&snap);
+    if (res == ESP_OK && (snap.seq != last_sensor_seq || now >= next_sensor)) {
+      res = ws_send_sensors(ctx, &snap);
+      if (res == ESP_OK) {
+        flame_sensor_mark_served(&snap.flame, esp_timer_get_time());
+      }
+      last_sensor_seq = snap.seq;
+      next_sensor = now + WS_SENSOR_INTERVAL_MS * 1000LL;
+    }
+    if (res == ESP_OK) {
+      res = ws_poll_client(ctx);
+    }
+  }
+
+  log_i("WebSocket closed: sent %u, dropped %u, writes %u", sent, broadcast_dropped(ctx->sub), ctx->writes);
+  stream_unsubscribe(ctx->sub);
+  httpd_handle_t hd = ctx->req->handle;
+  httpd_req_async_handler_complete(ctx->req);
+  httpd_sess_trigger_close(hd, ctx->fd);
+  free(ctx);
+  vTaskDelete(NULL);
+}
+
+// 핸드셰이크(GET)가 끝나면 세션을 전송 태스크에 넘긴다. 이후 클라이언트 프레임도 그 태스크가 읽으므로
+// 서버 태스크가 이 핸들러를 데이터 프레임으로 부르는 일은 없다.
+static esp_err_t ws_handler(httpd_req_t *req) {
+  if (req->method != HTTP_GET) {
+    return ESP_OK;
+  }
+  broadcast_sub_t *sub = broadcast_subscribe();
+  if (!sub) {
+    // 핸드셰이크 응답은 이미 나갔으므로 1013(Try Again Later)으로 닫는다.
+    log_e("Too many streams");
+    uint8_t code[2] = { 1013 >> 8, 1013 & 0xFF };
+    httpd_ws_frame_t close_frame = {};
+    close_frame.final = true;
+    close_frame.type = HTTPD_WS_TYPE_CLOSE;
+    close_frame.payload = code;
+    close_frame.len = sizeof(code);
+    httpd_ws_send_frame(req, &close_frame);
+    return ESP_FAIL;
+  }
+  ws_ctx_t *ctx = (ws_ctx_t *)calloc(1, sizeof(ws_ctx_t));
+  if (!ctx) {
+    broadcast_unsubscribe(sub);
+    return ESP_FAIL;
+  }
+  ctx->sub = sub;
+  ctx->fd = httpd_req_to_sockfd(req);
+  ctx->idle_ms = stream_idle_option(req);
+  int nodelay = 1;
+  setsockopt(ctx->fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+  if (httpd_req_async_handler_begin(req, &ctx->req) != ESP_OK) {
+    log_e("WebSocket handoff failed");
+    free(ctx);
+    broadcast_unsubscribe(sub);
+    return ESP_FAIL;
+  }
+  httpd_req_t *async_req = ctx->req;
+  if (xTaskCreatePinnedToCore(ws_task, "ws", 4096, ctx, 5, NULL, STREAM_CORE) != pdPASS) {
+    log_e("WebSocket task create failed");
+    free(ctx);
+    broadcast_unsubscribe(sub);
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+#endif
+
+// lwIP 소켓 예산. httpd 인스턴스는 listen 소켓과 ctrl 소켓을 하나씩, 세션마다 하나씩 쓴다. 합이
+// CONFIG_LWIP_MAX_SOCKETS 를 넘으면 스트림이 가득 찼을 때 제어 포트의 accept() 가 실패한다.
+#define CONTROL_MAX_SESSIONS 4  // 제어 서버 세션 (넘치면 가장 오래 쉰 세션을 닫음)
+#define SOCKETS_RESERVED     1  // DNS 등 httpd 밖의 소켓
+static_assert(2 * 2 + CONTROL_MAX_SESSIONS + BROADCAST_MAX_SUBS + SOCKETS_RESERVED <= CONFIG_LWIP_MAX_SOCKETS,
+              "httpd sessions exceed the lwIP socket budget");
+
 // 카메라 서버 및 스트림 서버를 시작하는 함수
 void startCameraServer() {
   // 기본 HTTP 서버 설정 복사 (기본 URI 핸들러 최대 개수 등)
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-  config.max_uri_handlers = 16;
+  config.max_uri_handlers = 32;
+  // 제어/센서 요청은 짧게 끝나므로 오래 쉬는 keep-alive 연결은 새 연결에 자리를 내준다.
+  config.max_open_sockets = CONTROL_MAX_SESSIONS;
+  config.lru_purge_enable = true;
+  if (!status_lock) {
+    status_lock = xSemaphoreCreateMutex();
+  }
 
   // 각 URI와 그에 해당하는 핸들러를 정의 (웹 인터페이스, 상태, 제어, 캡처, 스트림, BMP, XCLK, 레지스터, PLL, 해상도)
   httpd_uri_t index_uri = {
@@ -866,24 +2637,181 @@ void startCameraServer() {
   .user_ctx = NULL
   };
 
-  // 프레임 간 시간 평균을 위한 필터 초기화 (20개 샘플)
-  ra_filter_init(&ra_filter, 20);
+  httpd_uri_t regs_uri = {
+  .uri      = "/regs",
+  .method   = HTTP_GET,
+  .handler  = regs_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t regs_post_uri = {
+  .uri      = "/regs",
+  .method   = HTTP_POST,
+  .handler  = regs_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t profile_uri = {
+  .uri      = "/profile",
+  .method   = HTTP_GET,
+  .handler  = profile_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t burst_uri = {
+  .uri      = "/burst",
+  .method   = HTTP_GET,
+  .handler  = burst_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t fire_uri = {
+  .uri      = "/fire",
+  .method   = HTTP_GET,
+  .handler  = fire_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t event_uri = {
+  .uri      = "/event",
+  .method   = HTTP_GET,
+  .handler  = event_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t event_trigger_uri = {
+  .uri      = "/event/trigger",
+  .method   = HTTP_GET,
+  .handler  = event_trigger_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t event_rearm_uri = {
+  .uri      = "/event/rearm",
+  .method   = HTTP_GET,
+  .handler  = event_rearm_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t event_clip_uri = {
+  .uri      = "/event/clip",
+  .method   = HTTP_GET,
+  .handler  = event_clip_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t history_uri = {
+  .uri      = "/history",
+  .method   = HTTP_GET,
+  .handler  = history_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t boot_uri = {
+  .uri      = "/boot",
+  .method   = HTTP_GET,
+  .handler  = boot_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t trace_uri = {
+  .uri      = "/trace",
+  .method   = HTTP_GET,
+  .handler  = trace_handler,
+  .user_ctx = NULL
+  };
+
+  httpd_uri_t metrics_uri = {
+  .uri      = "/metrics",
+  .method   = HTTP_GET,
+  .handler  = metrics_handler,
+  .user_ctx = NULL
+  };
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+  // 프레임과 센서 값을 함께 보내는 WebSocket. PING/CLOSE 도 전송 태스크가 직접 처리한다.
+  httpd_uri_t ws_uri = {
+    .uri = "/ws",
+    .method = HTTP_GET,
+    .handler = ws_handler,
+    .user_ctx = NULL,
+    .is_websocket = true,
+    .handle_ws_control_frames = true,
+    .supported_subprotocol = NULL
+  };
+#endif
+
+  // 현재 센서 설정(setup() 에서 정한 값)을 레이트 컨트롤러의 기준값으로 삼는다.
+  rate_ctrl_init();
+
+  // 변환 버퍼를 미리 잡아 둔다 (브로드캐스터가 첫 프레임을 변환하기 전에).
+  sensor_t *s = esp_camera_sensor_get();
+  if (conv_pool_init(s ? s->pixformat : PIXFORMAT_JPEG) != ESP_OK) {
+    log_e("Conversion pool init failed");
+  }
+  if (bmp_stream_init() != ESP_OK) {
+    log_e("BMP stream init failed");
+  }
+  if (capture_cache_init() != ESP_OK || capture_workers_init() != ESP_OK) {
+    log_e("Capture cache init failed");
+  }
+
+  // /stream 클라이언트들이 공유할 캡처 태스크 시작
+  if (broadcast_init(STREAM_CORE) != ESP_OK) {
+    log_e("Frame broadcaster init failed");
+  }
+  // 브로드캐스터에서 프레임을 받아 사건 전 영상을 계속 기록한다.
+  if (event_clip_start() != ESP_OK) {
+    log_e("Event clip init failed");
+  }
+  // 같은 프레임을 1/8 로 디코드해 불꽃 후보 화소를 찾는다.
+  if (analysis_start() != ESP_OK) {
+    log_e("Frame analysis init failed");
+  }
 
   log_i("Starting web server on port: '%d'", config.server_port);
   // 카메라 제어 서버 시작 후 URI 핸들러 등록
   if (httpd_start(&camera_httpd, &config) == ESP_OK) {
-    httpd_register_uri_handler(camera_httpd, &index_uri);
-    httpd_register_uri_handler(camera_httpd, &cmd_uri);
-    httpd_register_uri_handler(camera_httpd, &status_uri);
-    httpd_register_uri_handler(camera_httpd, &capture_uri);
-    httpd_register_uri_handler(camera_httpd, &bmp_uri);
-    httpd_register_uri_handler(camera_httpd, &xclk_uri);
-    httpd_register_uri_handler(camera_httpd, &reg_uri);
-    httpd_register_uri_handler(camera_httpd, &greg_uri);
-    httpd_register_uri_handler(camera_httpd, &pll_uri);
-    httpd_register_uri_handler(camera_httpd, &win_uri);
-    httpd_register_uri_handler(camera_httpd, &dht_uri);
-    httpd_register_uri_handler(camera_httpd, &flame_uri);
-    httpd_register_uri_handler(camera_httpd, &stream_uri);
+    register_timed(camera_httpd, &index_uri);
+    register_timed(camera_httpd, &cmd_uri);
+    register_timed(camera_httpd, &status_uri);
+    httpd_register_uri_handler(camera_httpd, &capture_uri);  // 시간은 capture_task 에서 잰다
+    register_timed(camera_httpd, &bmp_uri);
+    burst_metric = metrics_endpoint_register("/burst", "GET");
+    httpd_register_uri_handler(camera_httpd, &burst_uri);  // 시간은 burst_task 에서 잰다
+    register_timed(camera_httpd, &xclk_uri);
+    register_timed(camera_httpd, &reg_uri);
+    register_timed(camera_httpd, &greg_uri);
+    register_timed(camera_httpd, &regs_uri);
+    register_timed(camera_httpd, &regs_post_uri);
+    register_timed(camera_httpd, &profile_uri);
+    register_timed(camera_httpd, &pll_uri);
+    register_timed(camera_httpd, &win_uri);
+    register_timed(camera_httpd, &dht_uri);
+    register_timed(camera_httpd, &flame_uri);
+    register_timed(camera_httpd, &history_uri);
+    register_timed(camera_httpd, &fire_uri);
+    register_timed(camera_httpd, &event_uri);
+    register_timed(camera_httpd, &event_trigger_uri);
+    register_timed(camera_httpd, &event_rearm_uri);
+    register_timed(camera_httpd, &event_clip_uri);
+    register_timed(camera_httpd, &boot_uri);
+    register_timed(camera_httpd, &trace_uri);
+    register_timed(camera_httpd, &metrics_uri);
+  }
+
+  // 스트림 서버는 별도 인스턴스(포트 81)로 띄워, 열린 스트림이 제어/센서 요청을 막지 않게 한다.
+  // 서버 태스크는 WiFi 스택이 쓰지 않는 코어에 고정한다.
+  config.server_port += 1;
+  config.ctrl_port += 1;
+  config.core_id = STREAM_CORE;
+  config.max_open_sockets = BROADCAST_MAX_SUBS;
+  config.lru_purge_enable = false;
+  log_i("Starting stream server on port: '%d'", config.server_port);
+  if (httpd_start(&stream_httpd, &config) == ESP_OK) {
+    httpd_register_uri_handler(stream_httpd, &stream_uri);
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    httpd_register_uri_handler(stream_httpd, &ws_uri);
+#endif
   }
 }
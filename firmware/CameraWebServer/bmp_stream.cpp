@@ -0,0 +1,148 @@
+// 줄 단위 BMP 인코더 구현 (bmp_stream.h 참고)
+#include "bmp_stream.h"
+#include "img_converters.h"
+#include "esp_jpg_decode.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+#define BMP_HEADER_LEN 54
+#define BMP_JPEG_MCU_ROWS 16  // JPEG MCU 의 최대 높이 (4:2:0)
+
+// esp32-camera 의 frame2bmp() 와 같은 헤더 ('BM' 뒤)
+typedef struct {
+  uint32_t filesize;
+  uint32_t reserved;
+  uint32_t fileoffset_to_pixelarray;
+  uint32_t dibheadersize;
+  int32_t width;
+  int32_t height;
+  uint16_t planes;
+  uint16_t bitsperpixel;
+  uint32_t compression;
+  uint32_t imagesize;
+  uint32_t ypixelpermeter;
+  uint32_t xpixelpermeter;
+  uint32_t numcolorspallette;
+  uint32_t mostimpcolor;
+} __attribute__((packed)) bmp_header_t;
+
+static SemaphoreHandle_t band_lock = NULL;
+static uint8_t *band = NULL;  // band_lock 으로 보호
+static size_t band_cap;
+
+static bool band_reserve(size_t size) {
+  if (band_cap >= size) {
+    return true;
+  }
+  free(band);
+  band = (uint8_t *)(size > BMP_BAND_BYTES && psramFound() ? ps_malloc(size) : malloc(size));
+  band_cap = band ? size : 0;
+  return band != NULL;
+}
+
+typedef struct {
+  camera_fb_t *fb;
+  bmp_write_cb_t write;
+  void *arg;
+  esp_err_t err;
+  size_t row_bytes;
+} bmp_ctx_t;
+
+static size_t jpg_read(void *arg, size_t index, uint8_t *buf, size_t len) {
+  camera_fb_t *fb = ((bmp_ctx_t *)arg)->fb;
+  if (index + len > fb->len) {
+    len = fb->len - index;
+  }
+  if (buf) {
+    memcpy(buf, fb->buf + index, len);
+  }
+  return len;
+}
+
+// 디코더가 MCU 블록(RGB)을 넘길 때마다 띠의 제자리에 BGR 로 옮기고, 줄의 마지막 블록이면 띠를 보낸다.
+static bool jpg_write(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data) {
+  bmp_ctx_t *ctx = (bmp_ctx_t *)arg;
+  if (!data) {
+    return true;  // 시작/끝 알림
+  }
+  for (uint16_t r = 0; r < h; r++) {
+    uint8_t *o = band + r * ctx->row_bytes + x * 3;
+    for (uint16_t i = 0; i < w * 3; i += 3) {
+      o[i] = data[i + 2];
+      o[i + 1] = data[i + 1];
+      o[i + 2] = data[i];
+    }
+    data += w * 3;
+  }
+  if ((size_t)(x + w) * 3 >= ctx->row_bytes) {
+    ctx->err = ctx->write(ctx->arg, band, ctx->row_bytes * h);
+  }
+  return ctx->err == ESP_OK;
+}
+
+static esp_err_t send_jpeg(bmp_ctx_t *ctx) {
+  if (!band_reserve(ctx->row_bytes * BMP_JPEG_MCU_ROWS)) {
+    return ESP_ERR_NO_MEM;
+  }
+  esp_err_t err = esp_jpg_decode(ctx->fb->len, JPG_SCALE_NONE, jpg_read, jpg_write, ctx);
+  return ctx->err != ESP_OK ? ctx->err : err;
+}
+
+static esp_err_t send_raw(bmp_ctx_t *ctx) {
+  camera_fb_t *fb = ctx->fb;
+  size_t bpp = fb->format == PIXFORMAT_GRAYSCALE ? 1 : fb->format == PIXFORMAT_RGB888 ? 3 : 2;
+  size_t rows = max(BMP_BAND_BYTES / ctx->row_bytes, (size_t)1);
+  if (!band_reserve(rows * ctx->row_bytes)) {
+    return ESP_ERR_NO_MEM;
+  }
+  size_t src_row = fb->width * bpp;
+  for (size_t y = 0; y < fb->height; y += rows) {
+    size_t n = min(rows, fb->height - y);
+    if (!fmt2rgb888(fb->buf + y * src_row, n * src_row, fb->format, band)) {
+      return ESP_FAIL;
+    }
+    esp_err_t err = ctx->write(ctx->arg, band, n * ctx->row_bytes);
+    if (err != ESP_OK) {
+      return err;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t bmp_stream_init(void) {
+  if (!band_lock) {
+    band_lock = xSemaphoreCreateMutex();
+  }
+  return band_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t bmp_stream(camera_fb_t *fb, bmp_write_cb_t write, void *arg, size_t *out_len) {
+  size_t pix_count = fb->width * fb->height;
+  uint8_t head[BMP_HEADER_LEN] = {'B', 'M'};
+  bmp_header_t hdr = {};
+  hdr.filesize = pix_count * 3 + BMP_HEADER_LEN;
+  hdr.fileoffset_to_pixelarray = BMP_HEADER_LEN;
+  hdr.dibheadersize = 40;
+  hdr.width = fb->width;
+  hdr.height = -(int32_t)fb->height;  // 위에서 아래로
+  hdr.planes = 1;
+  hdr.bitsperpixel = 24;
+  hdr.imagesize = pix_count * 3;
+  hdr.ypixelpermeter = 0x0B13;
+  hdr.xpixelpermeter = 0x0B13;
+  memcpy(head + 2, &hdr, sizeof(hdr));
+  *out_len = 0;
+  esp_err_t err = write(arg, head, sizeof(head));
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  bmp_ctx_t ctx = {fb, write, arg, ESP_OK, fb->width * 3};
+  xSemaphoreTake(band_lock, portMAX_DELAY);
+  err = fb->format == PIXFORMAT_JPEG ? send_jpeg(&ctx) : send_raw(&ctx);
+  xSemaphoreGive(band_lock);
+  if (err == ESP_OK) {
+    *out_len = hdr.filesize;
+  }
+  return err;
+}
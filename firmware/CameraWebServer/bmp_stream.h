@@ -0,0 +1,25 @@
+// /bmp 용 줄 단위 BMP 인코더
+//
+// frame2bmp() 는 BMP 전체(VGA 면 약 900KB)를 메모리에 만든 뒤에야 보낼 수 있다. 여기서는 헤더를 먼저
+// 넘기고, 이미지를 몇 줄씩 작은 띠 버퍼에 변환해 곧바로 넘기므로 변환과 전송이 겹친다.
+//  - 원시 포맷(RGB565, YUV422, GRAYSCALE, RGB888): BMP_BAND_BYTES 에 들어가는 줄 수씩
+//  - JPEG: 디코더가 MCU 줄(8 또는 16 줄) 단위로 내놓으므로 그만큼씩 (VGA 에서 30KB)
+// 띠 버퍼는 처음 쓸 때 잡아 두고 다시 쓰며, 더 넓은 프레임이 올 때만 늘린다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#define BMP_BAND_BYTES 7680  // 원시 포맷의 띠 크기 (VGA 4 줄)
+
+// 조각 하나를 보낸다. ESP_OK 가 아니면 변환을 멈추고 그 값을 돌려준다.
+typedef esp_err_t (*bmp_write_cb_t)(void *arg, const uint8_t *data, size_t len);
+
+// 띠 버퍼를 보호하는 잠금을 만든다. HTTP 서버 시작 전에 부른다.
+esp_err_t bmp_stream_init(void);
+
+// fb 를 BMP(24 비트, 위에서 아래로)로 변환하며 write 에 넘긴다. 끝날 때까지 fb 를 읽으므로
+// fb 는 돌아온 뒤에 돌려준다. *out_len 에는 넘긴 전체 길이를 넣는다.
+esp_err_t bmp_stream(camera_fb_t *fb, bmp_write_cb_t write, void *arg, size_t *out_len);
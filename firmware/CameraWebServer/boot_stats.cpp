@@ -0,0 +1,38 @@
+// 부팅 단계별 완료 시각 구현 (boot_stats.h 참고)
+#include "boot_stats.h"
+#include "trace.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static int64_t marks[BOOT_STAGE_COUNT];
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;  // 64 비트 값을 찢어지지 않게 읽고 쓴다.
+
+static const char *const trace_names[BOOT_STAGE_COUNT] = {
+  "boot_camera", "boot_sensors", "boot_server", "boot_first_frame", "boot_wifi"
+};
+
+void boot_mark(boot_stage_t stage, int64_t start_us) {
+  int64_t now = esp_timer_get_time();
+  bool first = false;
+  portENTER_CRITICAL(&mux);
+  if (!marks[stage]) {
+    marks[stage] = now;
+    first = true;
+  }
+  portEXIT_CRITICAL(&mux);
+  if (first) {
+    trace_span(trace_names[stage], start_us, 0);
+  }
+}
+
+int64_t boot_time_us(boot_stage_t stage) {
+  portENTER_CRITICAL(&mux);
+  int64_t t = marks[stage];
+  portEXIT_CRITICAL(&mux);
+  return t;
+}
+
+const char *boot_stage_name(boot_stage_t stage) {
+  static const char *const names[BOOT_STAGE_COUNT] = {"camera", "sensors", "server", "first_frame", "wifi"};
+  return names[stage];
+}
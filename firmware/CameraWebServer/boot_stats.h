@@ -0,0 +1,26 @@
+// 부팅 단계별 완료 시각 (/boot)
+//
+// setup() 과 WiFi 접속 태스크가 각 단계를 마칠 때 boot_mark() 를 부른다. 시각은 esp_timer_get_time()
+// 기준(앱 시작 후 us)이고 같은 단계는 처음 한 번만 기록한다. 단계는 /trace 에도 "boot_<이름>" 구간으로 남는다. WiFi 는 다른 초기화와 동시에 진행되므로
+// 단계의 순서는 부팅마다 다를 수 있다.
+#pragma once
+
+#include <stdint.h>
+
+typedef enum {
+  BOOT_CAMERA,       // esp_camera_init() 완료
+  BOOT_SENSORS,      // 불꽃 인터럽트, DHT/기록 태스크 시작
+  BOOT_SERVER,       // HTTP 서버 시작
+  BOOT_FIRST_FRAME,  // 첫 프레임 캡처
+  BOOT_WIFI,         // AP 에 연결되고 IP 를 받음
+  BOOT_STAGE_COUNT
+} boot_stage_t;
+
+// 단계를 지금 마쳤다. start_us 는 단계를 시작한 시각 (/trace 구간의 시작).
+void boot_mark(boot_stage_t stage, int64_t start_us);
+
+// 단계를 마친 시각 (0: 아직)
+int64_t boot_time_us(boot_stage_t stage);
+
+// /boot 응답의 키 이름
+const char *boot_stage_name(boot_stage_t stage);
@@ -0,0 +1,68 @@
+// /burst 용 연속 캡처 구현 (burst.h 참고)
+#include "burst.h"
+#include "frame_broadcaster.h"
+#include "trace.h"
+#include "esp_timer.h"
+#include <Arduino.h>
+
+#define BURST_FRAME_TIMEOUT_MS 2000
+
+static int64_t frame_time(const broadcast_frame_t *f) {
+  return f->timestamp.tv_sec * 1000000LL + f->timestamp.tv_usec;
+}
+
+// not_before 이후에 찍힌 프레임을 기다린다. 그보다 먼저 찍힌 프레임은 버린다.
+// 설정 묶음 적용 전/도중에 찍힌 프레임은 브로드캐스터가 이미 걸러 낸다.
+static broadcast_frame_t *frame_after(broadcast_sub_t *sub, int64_t not_before) {
+  for (;;) {
+    broadcast_frame_t *f = broadcast_wait_frame(sub, pdMS_TO_TICKS(BURST_FRAME_TIMEOUT_MS));
+    if (!f || frame_time(f) >= not_before) {
+      return f;
+    }
+    broadcast_release(f);
+  }
+}
+
+static bool frame_store(burst_frame_t *f, const broadcast_frame_t *frame) {
+  f->buf = (uint8_t *)(psramFound() ? ps_malloc(frame->len) : malloc(frame->len));
+  if (!f->buf) {
+    return false;
+  }
+  memcpy(f->buf, frame->buf, frame->len);
+  f->len = frame->len;
+  f->timestamp = frame->timestamp;
+  return true;
+}
+
+int burst_capture(burst_frame_t *frames, int n, uint32_t interval_ms) {
+  broadcast_sub_t *sub = broadcast_subscribe_recorder(interval_ms);
+  if (!sub) {
+    return -1;
+  }
+  int64_t start = esp_timer_get_time();
+  int64_t interval = (int64_t)interval_ms * 1000;
+  int got = 0;
+  for (; got < n; got++) {
+    broadcast_frame_t *frame = frame_after(sub, got ? start + got * interval - interval / 2 : start);
+    if (!frame) {
+      log_e("Camera capture failed");
+      break;
+    }
+    bool ok = frame_store(&frames[got], frame);
+    broadcast_release(frame);
+    if (!ok) {
+      log_e("Burst frame allocation failed");
+      break;
+    }
+  }
+  broadcast_unsubscribe(sub);
+  trace_span("burst", start, got);
+  return got;
+}
+
+void burst_free(burst_frame_t *frames, int n) {
+  for (int i = 0; i < n; i++) {
+    free(frames[i].buf);
+    frames[i].buf = NULL;
+  }
+}
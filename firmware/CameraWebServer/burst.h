@@ -0,0 +1,31 @@
+// /burst 용 연속 캡처
+//
+// 불꽃의 깜빡임을 보려면 일정한 간격으로 찍은 여러 장이 필요하다. /capture 를 연달아 부르면 요청마다
+// HTTP 준비와 캡처 대기가 따로 걸려 간격이 들쭉날쭉하므로, 여기서는 시작 시각을 기준으로 k 번째 프레임의
+// 마감 시각(start + k * interval)을 정해 두고 그 무렵(interval 의 절반 전부터)에 찍힌 첫 프레임을 PSRAM 에
+// 복사해 둔다. 전송은 모두 찍은 뒤에 하므로 네트워크가 간격을 흔들지 않는다.
+//
+// 프레임은 프레임 브로드캐스터의 기록용 구독자로 받으므로 스트림과 카메라 버퍼를 나눠 갖지 않는다.
+// 스트림 클라이언트가 없으면 브로드캐스터는 interval 간격으로 캡처한다. 카메라는 센서 프레임 주기로만
+// 새 프레임을 내므로 interval 이 그보다 짧으면 프레임 주기로 찍힌다. 각 프레임의 실제 캡처 시각은
+// timestamp 에 있다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+#define BURST_MAX_FRAMES  32
+#define BURST_MAX_SPAN_MS 5000  // n * interval_ms 의 상한 (기록용 자리와 PSRAM 을 오래 붙잡지 않도록)
+
+typedef struct {
+  uint8_t *buf;              // JPEG 데이터 (PSRAM)
+  size_t len;
+  struct timeval timestamp;  // 원본 프레임 버퍼의 캡처 시각
+} burst_frame_t;
+
+// frames[0..n) 에 interval_ms 간격으로 n 장을 찍는다. 찍은 장 수를 돌려주며, n 보다 적으면 도중에
+// 캡처나 메모리 할당이 실패한 것이다. 기록용 구독자 자리가 없으면(다른 버스트가 진행 중) -1.
+// 다 쓴 뒤 burst_free() 로 돌려준다.
+int burst_capture(burst_frame_t *frames, int n, uint32_t interval_ms);
+void burst_free(burst_frame_t *frames, int n);
@@ -0,0 +1,193 @@
+// /capture 요청 합치기와 최근 프레임 캐시 구현 (capture_cache.h 참고)
+#include "capture_cache.h"
+#include "frame_broadcaster.h"
+#include "trace.h"
+#include "metrics.h"
+#include "conv_pool.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+// 버퍼를 다시 잡는 횟수를 줄이기 위한 여유분
+#define CAPTURE_BUF_ALIGN 4096
+// 동시에 기다릴 수 있는 요청 수 (httpd 의 동시 연결 수보다 크면 된다)
+#define CAPTURE_MAX_WAITERS 16
+
+static capture_frame_t slots[CAPTURE_CACHE_SLOTS];
+static capture_frame_t *cached;  // 마지막으로 캡처한 프레임 (캐시가 참조 하나를 가짐)
+static bool in_flight;           // 어떤 요청이 캡처 중
+static uint32_t generation;      // 캡처가 끝날 때마다 증가
+static bool last_ok;             // 마지막 캡처의 성공 여부
+static uint32_t waiters;         // 캡처 결과를 기다리는 요청 수
+static size_t last_jpg_len;      // 직전에 변환한 JPEG 크기 (변환 버퍼 크기를 고르는 데 씀)
+static capture_cache_stats_t stats;
+static SemaphoreHandle_t lock = NULL;  // 위 값들 보호
+static SemaphoreHandle_t done = NULL;  // 캡처가 끝나면 기다리는 요청 수만큼 give
+
+static void frame_unref_locked(capture_frame_t *f) {
+  if (f && f->refs > 0 && --f->refs == 0 && f->conv) {
+    conv_pool_put(f->conv);
+    f->conv = NULL;
+  }
+}
+
+// 아무도 쓰지 않는 슬롯을 캡처하는 요청 소유로 가져온다.
+static capture_frame_t *frame_acquire(void) {
+  capture_frame_t *f = NULL;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (int i = 0; i < CAPTURE_CACHE_SLOTS; i++) {
+    if (slots[i].refs == 0) {
+      f = &slots[i];
+      f->refs = 1;
+      break;
+    }
+  }
+  xSemaphoreGive(lock);
+  return f;
+}
+
+// 슬롯 용량을 늘린다. 캡처하는 요청만 참조를 가진 상태에서만 호출한다.
+static bool frame_reserve(capture_frame_t *f, size_t len) {
+  if (f->cap >= len) {
+    return true;
+  }
+  size_t cap = (len + CAPTURE_BUF_ALIGN - 1) / CAPTURE_BUF_ALIGN * CAPTURE_BUF_ALIGN;
+  free(f->copy_buf);
+  f->copy_buf = (uint8_t *)(psramFound() ? ps_malloc(cap) : malloc(cap));
+  f->cap = f->copy_buf ? cap : 0;
+  return f->copy_buf != NULL;
+}
+
+// 새 프레임을 받아 슬롯에 JPEG 로 넣는다. /control 일괄 설정 전이나 도중에 찍힌 프레임은 버린다.
+static capture_frame_t *capture_new(void) {
+  int64_t t0 = esp_timer_get_time();
+  camera_fb_t *fb = esp_camera_fb_get();
+  for (int i = 0; fb && i < 2 && broadcast_frame_stale(&fb->timestamp); i++) {
+    esp_camera_fb_return(fb);
+    fb = esp_camera_fb_get();
+  }
+  trace_span("fb_get", t0, fb ? fb->len : 0);
+  metrics_observe(METRIC_CAPTURE_WAIT, esp_timer_get_time() - t0);
+  if (!fb) {
+    log_e("Camera capture failed");
+    return NULL;
+  }
+
+  capture_frame_t *f = frame_acquire();
+  bool ok = f != NULL;
+  if (ok && fb->format == PIXFORMAT_JPEG) {
+    ok = frame_reserve(f, fb->len);
+    if (ok) {
+      memcpy(f->copy_buf, fb->buf, fb->len);
+      f->buf = f->copy_buf;
+      f->len = fb->len;
+    }
+  } else if (ok) {
+    t0 = esp_timer_get_time();
+    f->conv = conv_pool_jpeg(fb, 80, last_jpg_len);
+    ok = f->conv != NULL;
+    if (ok) {
+      f->buf = f->conv->data;
+      f->len = last_jpg_len = f->conv->len;
+    } else {
+      log_e("JPEG compression failed");
+    }
+    trace_span("frame2jpg", t0, ok ? f->len : 0);
+  }
+  if (ok) {
+    f->timestamp = fb->timestamp;
+    f->captured_us = esp_timer_get_time();
+  }
+  esp_camera_fb_return(fb);
+
+  if (!ok && f) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    frame_unref_locked(f);
+    xSemaphoreGive(lock);
+    f = NULL;
+  }
+  return f;
+}
+
+esp_err_t capture_cache_init(void) {
+  if (lock) {
+    return ESP_OK;
+  }
+  lock = xSemaphoreCreateMutex();
+  done = xSemaphoreCreateCounting(CAPTURE_MAX_WAITERS, 0);
+  return lock && done ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+capture_frame_t *capture_cache_get(uint32_t max_age_ms) {
+  if (max_age_ms > CAPTURE_MAX_AGE_MS) {
+    max_age_ms = CAPTURE_MAX_AGE_MS;
+  }
+  capture_frame_t *f = NULL;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (cached && esp_timer_get_time() - cached->captured_us <= (int64_t)max_age_ms * 1000) {
+    f = cached;
+    f->refs++;
+    stats.cache_hits++;
+    xSemaphoreGive(lock);
+    return f;
+  }
+
+  if (in_flight) {
+    // 진행 중인 캡처가 끝날 때까지 기다려 그 결과를 받는다.
+    // done 에 남은 give 로 일찍 깨어날 수 있으므로 generation 이 바뀌었는지 확인한다.
+    uint32_t gen = generation;
+    waiters++;
+    stats.coalesced++;
+    while (generation == gen) {
+      xSemaphoreGive(lock);
+      xSemaphoreTake(done, portMAX_DELAY);
+      xSemaphoreTake(lock, portMAX_DELAY);
+    }
+    if (last_ok && cached) {
+      f = cached;
+      f->refs++;
+    }
+    xSemaphoreGive(lock);
+    return f;
+  }
+
+  in_flight = true;
+  xSemaphoreGive(lock);
+  f = capture_new();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (f) {
+    frame_unref_locked(cached);
+    cached = f;
+    f->refs++;  // 캐시의 참조
+    stats.captures++;
+  } else {
+    stats.failed++;
+  }
+  last_ok = f != NULL;
+  generation++;
+  in_flight = false;
+  for (; waiters > 0; waiters--) {
+    xSemaphoreGive(done);
+  }
+  xSemaphoreGive(lock);
+  return f;
+}
+
+void capture_cache_release(capture_frame_t *frame) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  frame_unref_locked(frame);
+  xSemaphoreGive(lock);
+}
+
+void capture_cache_not_modified(void) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  stats.not_modified++;
+  xSemaphoreGive(lock);
+}
+
+void capture_cache_get_stats(capture_cache_stats_t *out) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  *out = stats;
+  xSemaphoreGive(lock);
+}
@@ -0,0 +1,50 @@
+// /capture 요청 합치기와 최근 프레임 캐시
+//
+// 대시보드, AI 백엔드, 아카이버가 한꺼번에 /capture 를 부르면 각자 esp_camera_fb_get() 으로 새 노출을
+// 기다리며 프레임 버퍼 두 개를 두고 다툰다. 여기서는 캡처를 한 번에 하나만 하고, 그동안 들어온 요청은
+// 그 캡처 결과를 함께 받는다. 마지막 JPEG 는 참조 카운트가 있는 슬롯에 남겨 두어, 요청이 허용한
+// 나이(max_age)보다 새것이면 캡처 없이 그대로 보낸다.
+//
+// JPEG 가 아닌 포맷은 캡처한 태스크에서 한 번만 변환 버퍼 풀(conv_pool.h)에 인코딩한다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "esp_err.h"
+
+// 슬롯 수: 캐시 1 개 + 보내는 중인 이전 프레임들 + 채우는 중 1 개
+#define CAPTURE_CACHE_SLOTS 4
+// max_age 로 허용하는 최대 나이 (ms). 이보다 오래된 프레임은 캐시에서 보내지 않는다.
+#define CAPTURE_MAX_AGE_MS 5000
+
+typedef struct {
+  const uint8_t *buf;        // JPEG 데이터
+  size_t len;
+  struct timeval timestamp;  // 원본 프레임 버퍼의 캡처 시각 (ETag 로 씀)
+  int64_t captured_us;       // 캐시에 넣은 시각 (esp_timer)
+  // 아래는 내부용
+  uint8_t *copy_buf;         // JPEG 프레임을 복사해 두는 슬롯 고유 버퍼
+  size_t cap;
+  struct conv_buf *conv;     // 변환한 프레임이면 변환 버퍼 풀에서 빌린 버퍼
+  int refs;
+} capture_frame_t;
+
+typedef struct {
+  uint32_t captures;      // 실제로 카메라에서 받은 프레임 수
+  uint32_t cache_hits;    // 캐시에서 보낸 요청 수
+  uint32_t coalesced;     // 다른 요청의 캡처를 기다려 받은 요청 수
+  uint32_t not_modified;  // 304 로 답한 요청 수 (app_httpd 가 capture_cache_not_modified() 로 셈)
+  uint32_t failed;        // 캡처나 인코딩 실패
+} capture_cache_stats_t;
+
+esp_err_t capture_cache_init(void);
+
+// max_age_ms 이내에 캐시에 들어간 프레임이 있으면 그것을, 없으면 새로 캡처한 프레임을 돌려준다
+// (NULL: 실패). 다른 요청이 캡처 중이면 새로 캡처하지 않고 그 결과를 기다린다.
+// 받은 프레임은 반드시 capture_cache_release() 로 돌려준다.
+capture_frame_t *capture_cache_get(uint32_t max_age_ms);
+void capture_cache_release(capture_frame_t *frame);
+
+void capture_cache_not_modified(void);
+void capture_cache_get_stats(capture_cache_stats_t *out);
@@ -0,0 +1,192 @@
+// 변환 버퍼 풀 구현 (conv_pool.h 참고)
+#include "conv_pool.h"
+#include "img_converters.h"
+#include "freertos/FreeRTOS.h"
+#include <Arduino.h>
+
+typedef struct {
+  size_t size;
+  uint16_t count;
+} pool_class_t;
+
+// 스트림 프레임은 클라이언트마다 전송 중 1 개와 대기 1 개까지 빌려 가므로 작은 클래스를 넉넉히 둔다.
+// /bmp 는 bmp_stream 이 띠 단위로 보내므로 풀을 쓰지 않는다.
+static constexpr pool_class_t pool_classes[CONV_POOL_CLASSES] = {
+  {32 * 1024, 6},   // QVGA~VGA JPEG
+  {96 * 1024, 3},   // SVGA~XGA JPEG
+  {232 * 1024, 1},  // UXGA 등 큰 JPEG
+};
+
+static constexpr int pool_buffer_count(void) {
+  int n = 0;
+  for (const pool_class_t &c : pool_classes) {
+    n += c.count;
+  }
+  return n;
+}
+
+static conv_buf_t bufs[pool_buffer_count()];
+static int class_first[CONV_POOL_CLASSES];  // 클래스의 첫 버퍼 번호 (같은 클래스는 이어져 있음)
+static bool pool_ready;
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+static conv_pool_stats_t stats;  // mux 로 보호
+
+esp_err_t conv_pool_init(pixformat_t format) {
+  if (pool_ready || !psramFound()) {
+    return ESP_OK;
+  }
+  int n = 0;
+  for (int c = 0; c < CONV_POOL_CLASSES; c++) {
+    class_first[c] = n;
+    n += pool_classes[c].count;
+    stats.classes[c].size = pool_classes[c].size;
+  }
+  if (format == PIXFORMAT_JPEG) {
+    return ESP_OK;  // 변환할 일이 없다 (pool_ready 가 false 라 빌려주지 않음)
+  }
+  n = 0;
+  for (int c = 0; c < CONV_POOL_CLASSES; c++) {
+    for (int i = 0; i < pool_classes[c].count; i++, n++) {
+      bufs[n].data = (uint8_t *)ps_malloc(pool_classes[c].size);
+      if (!bufs[n].data) {
+        log_e("Conversion pool allocation failed");
+        return ESP_ERR_NO_MEM;
+      }
+      bufs[n].cap = pool_classes[c].size;
+      bufs[n].cls = c;
+      stats.classes[c].count++;
+    }
+  }
+  pool_ready = true;
+  return ESP_OK;
+}
+
+// size 이상인 가장 작은 클래스의 빈 버퍼. 모두 사용 중이면 더 큰 클래스에서 찾는다.
+static conv_buf_t *pool_get(size_t size) {
+  if (!pool_ready) {
+    return NULL;
+  }
+  conv_buf_t *b = NULL;
+  bool best_fit = true;
+  portENTER_CRITICAL(&mux);
+  for (int c = 0; c < CONV_POOL_CLASSES && !b; c++) {
+    if (pool_classes[c].size < size || stats.classes[c].count == 0) {
+      continue;
+    }
+    for (int i = class_first[c]; i < class_first[c] + pool_classes[c].count; i++) {
+      if (!bufs[i].in_use) {
+        b = &bufs[i];
+        break;
+      }
+    }
+    conv_pool_class_stats_t *cs = &stats.classes[c];
+    if (!b && best_fit) {
+      cs->misses++;
+    } else if (b) {
+      b->in_use = true;
+      b->len = 0;
+      cs->hits++;
+      cs->in_use++;
+      cs->high_water = max(cs->high_water, cs->in_use);
+    }
+    best_fit = false;
+  }
+  portEXIT_CRITICAL(&mux);
+  return b;
+}
+
+static conv_buf_t *heap_wrap(uint8_t *data, size_t cap) {
+  conv_buf_t *b = (conv_buf_t *)malloc(sizeof(conv_buf_t));
+  if (!b) {
+    free(data);
+    return NULL;
+  }
+  b->data = data;
+  b->cap = cap;
+  b->len = 0;
+  b->cls = -1;
+  b->in_use = true;
+  portENTER_CRITICAL(&mux);
+  stats.heap_fallbacks++;
+  portEXIT_CRITICAL(&mux);
+  return b;
+}
+
+// 풀 버퍼를 빈 것으로 되돌린다.
+static void pool_release(conv_buf_t *b) {
+  portENTER_CRITICAL(&mux);
+  b->in_use = false;
+  stats.classes[b->cls].in_use--;
+  portEXIT_CRITICAL(&mux);
+}
+
+// heap_wrap() 의 반대. 풀 버퍼(bufs)를 free 하는 경로가 한 함수에 섞이지 않도록 따로 둔다.
+static void heap_unwrap(conv_buf_t *b) {
+  free(b->data);
+  free(b);
+}
+
+void conv_pool_put(conv_buf_t *b) {
+  if (!b) {
+    return;
+  }
+  if (b->cls < 0) {
+    heap_unwrap(b);
+  } else {
+    pool_release(b);
+  }
+}
+
+typedef struct {
+  conv_buf_t *buf;
+  bool overflow;
+} jpg_sink_t;
+
+// frame2jpg_cb 출력을 빌린 버퍼에 이어 붙인다. 넘치면 0 을 돌려 인코딩을 멈춘다.
+static size_t jpg_sink_write(void *arg, size_t index, const void *data, size_t len) {
+  jpg_sink_t *sink = (jpg_sink_t *)arg;
+  conv_buf_t *b = sink->buf;
+  if (index + len > b->cap) {
+    sink->overflow = true;
+    return 0;
+  }
+  memcpy(b->data + index, data, len);
+  b->len = index + len;
+  return len;
+}
+
+conv_buf_t *conv_pool_jpeg(camera_fb_t *fb, uint8_t quality, size_t size_hint) {
+  size_t want = size_hint + size_hint / 4;  // 장면이 바뀌어 조금 커져도 들어가도록
+  conv_buf_t *b;
+  while ((b = pool_get(want)) != NULL) {
+    jpg_sink_t sink = {b, false};
+    if (frame2jpg_cb(fb, quality, jpg_sink_write, &sink)) {
+      return b;
+    }
+    pool_release(b);
+    if (!sink.overflow) {
+      return NULL;  // 인코더 자체가 실패
+    }
+    want = b->cap + 1;
+    portENTER_CRITICAL(&mux);
+    stats.retries++;
+    portEXIT_CRITICAL(&mux);
+  }
+  // 풀에서 구하지 못하면 크기를 모르므로 인코더가 잡게 한다.
+  uint8_t *jpg = NULL;
+  size_t jpg_len = 0;
+  if (!frame2jpg(fb, quality, &jpg, &jpg_len)) {
+    return NULL;
+  }
+  b = heap_wrap(jpg, jpg_len);
+  if (b) {
+    b->len = jpg_len;
+  }
+  return b;
+}
+
+void conv_pool_get_stats(conv_pool_stats_t *out) {
+  portENTER_CRITICAL(&mux);
+  *out = stats;
+  portEXIT_CRITICAL(&mux);
+}
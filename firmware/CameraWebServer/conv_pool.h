@@ -0,0 +1,53 @@
+// 변환 버퍼 풀
+//
+// 센서가 JPEG 가 아닌 포맷으로 찍을 때 frame2jpg() 는 프레임마다 출력 버퍼를 malloc 하고
+// 보낸 뒤 free 한다. 몇 시간 스트리밍하면 PSRAM 이 조각나 큰 할당이 실패하게 되므로, 부팅 때 크기별로
+// 미리 잡아 둔 버퍼를 빌려주고 변환 결과를 빌린 버퍼에 바로 쓴다.
+//
+// 요청 크기에 맞는 가장 작은 클래스부터 찾고, 모두 빌려 가 있으면 더 큰 클래스로 넘어간다.
+// 풀에서 구하지 못하면(요청이 가장 큰 클래스보다 크거나 모두 사용 중) 예전처럼 힙에서 잡고 heap_fallbacks
+// 로 센다. 크기 클래스는 conv_pool.cpp 의 pool_classes 에 있다. PSRAM 이 없으면 풀 없이 항상 힙을 쓴다.
+// 센서가 JPEG 를 내면 스트림은 변환하지 않으므로 아무것도 잡지 않는다. (/bmp 는 bmp_stream.h 참고)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#define CONV_POOL_CLASSES 3
+
+typedef struct conv_buf {
+  uint8_t *data;
+  size_t cap;
+  size_t len;    // 변환 결과 길이
+  int8_t cls;    // 크기 클래스 (-1: 힙에서 잡은 버퍼)
+  bool in_use;
+} conv_buf_t;
+
+typedef struct {
+  size_t size;          // 버퍼 하나의 크기
+  uint16_t count;       // 버퍼 수
+  uint16_t in_use;
+  uint16_t high_water;  // in_use 의 최댓값
+  uint32_t hits;        // 이 클래스에서 빌려준 수
+  uint32_t misses;      // 이 클래스가 가장 잘 맞았지만 모두 사용 중이던 요청 수
+} conv_pool_class_stats_t;
+
+typedef struct {
+  conv_pool_class_stats_t classes[CONV_POOL_CLASSES];
+  uint32_t heap_fallbacks;  // 풀에서 구하지 못해 힙에서 잡은 수
+  uint32_t retries;         // JPEG 가 빌린 버퍼를 넘쳐 더 큰 버퍼로 다시 인코딩한 수
+} conv_pool_stats_t;
+
+// 버퍼를 미리 잡는다. format 은 센서 출력 포맷으로, JPEG 면 잡지 않는다.
+esp_err_t conv_pool_init(pixformat_t format);
+
+// fb 를 JPEG 로 인코딩한 버퍼를 돌려준다 (NULL: 실패). size_hint 는 예상 크기로, 직전 프레임의 결과
+// 길이를 주면 된다. 넘치면 한 클래스 큰 버퍼로 다시 인코딩한다.
+conv_buf_t *conv_pool_jpeg(camera_fb_t *fb, uint8_t quality, size_t size_hint);
+
+// 빌린 버퍼를 돌려준다. 어느 태스크에서나 부를 수 있다.
+void conv_pool_put(conv_buf_t *b);
+
+void conv_pool_get_stats(conv_pool_stats_t *out);
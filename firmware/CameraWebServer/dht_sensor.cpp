@@ -0,0 +1,157 @@
+// DHT22 RMT 수신 태스크 구현 (dht_sensor.h 참고)
+#include "dht_sensor.h"
+#include "trace.h"
+#include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+#define DHT_RMT_RESOLUTION_HZ 1000000  // 1 tick = 1us
+#define DHT_RMT_SYMBOLS 64             // 응답 + 40 비트 = 약 43 심볼
+#define DHT_START_LOW_MS 2             // 시작 신호 (DHT22 는 1ms 이상)
+#define DHT_RX_TIMEOUT_MS 20           // 전체 응답은 5ms 안쪽
+#define DHT_GLITCH_NS 1000             // 이보다 짧은 펄스는 잡음으로 버림
+#define DHT_IDLE_NS 200000             // 선이 이만큼 HIGH 로 머물면 프레임 끝
+#define DHT_BIT_ONE_US 48              // HIGH 가 26~28us 면 0, 70us 면 1
+#define DHT_BIT_MIN_US 10
+#define DHT_BIT_MAX_US 100
+
+static gpio_num_t dht_pin;
+static rmt_channel_handle_t rx_chan = NULL;
+static SemaphoreHandle_t rx_done = NULL;
+static rmt_symbol_word_t symbols[DHT_RMT_SYMBOLS];
+static volatile size_t rx_symbols;
+static dht_reading_cb_t reading_cb;
+
+static bool IRAM_ATTR dht_rx_done(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_ctx) {
+  BaseType_t woken = pdFALSE;
+  rx_symbols = edata->num_symbols;
+  xSemaphoreGiveFromISR(rx_done, &woken);
+  return woken == pdTRUE;
+}
+
+// 캡처한 펄스에서 길이가 있는 HIGH 펄스만 모은다. 센서 응답(80us) 뒤의 마지막 40 개가 데이터 비트다.
+static bool dht_decode(const rmt_symbol_word_t *sym, size_t n, uint8_t data[5]) {
+  uint16_t highs[DHT_RMT_SYMBOLS * 2];
+  size_t nh = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (sym[i].level0 && sym[i].duration0) {
+      highs[nh++] = sym[i].duration0;
+    }
+    if (sym[i].level1 && sym[i].duration1) {
+      highs[nh++] = sym[i].duration1;
+    }
+  }
+  if (nh < 40) {
+    return false;
+  }
+  memset(data, 0, 5);
+  for (size_t b = 0; b < 40; b++) {
+    uint16_t us = highs[nh - 40 + b];
+    if (us < DHT_BIT_MIN_US || us > DHT_BIT_MAX_US) {
+      return false;
+    }
+    if (us > DHT_BIT_ONE_US) {
+      data[b / 8] |= 0x80 >> (b % 8);
+    }
+  }
+  return ((data[0] + data[1] + data[2] + data[3]) & 0xff) == data[4];
+}
+
+static esp_err_t dht_read(float *temperature, float *humidity) {
+  rmt_receive_config_t rx_cfg = {};
+  rx_cfg.signal_range_min_ns = DHT_GLITCH_NS;
+  rx_cfg.signal_range_max_ns = DHT_IDLE_NS;
+
+  // 시작 신호. 틱 경계에서 짧아지지 않도록 한 틱을 더 기다린다.
+  gpio_set_level(dht_pin, 0);
+  vTaskDelay(pdMS_TO_TICKS(DHT_START_LOW_MS) + 1);
+  xSemaphoreTake(rx_done, 0);
+  esp_err_t err = rmt_receive(rx_chan, symbols, sizeof(symbols), &rx_cfg);
+  // 선을 놓으면 풀업으로 HIGH 가 되고, 센서가 80us LOW/80us HIGH 응답 뒤 40 비트를 보낸다.
+  gpio_set_level(dht_pin, 1);
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (xSemaphoreTake(rx_done, pdMS_TO_TICKS(DHT_RX_TIMEOUT_MS)) != pdTRUE) {
+    // 응답이 없으면 대기 중인 수신을 끊고 다음 읽기를 위해 채널을 다시 켠다.
+    rmt_disable(rx_chan);
+    rmt_enable(rx_chan);
+    return ESP_ERR_TIMEOUT;
+  }
+
+  uint8_t data[5];
+  if (!dht_decode(symbols, rx_symbols, data)) {
+    return ESP_ERR_INVALID_CRC;
+  }
+  *humidity = ((data[0] << 8) | data[1]) / 10.0f;
+  *temperature = (((data[2] & 0x7f) << 8) | data[3]) / 10.0f;
+  if (data[2] & 0x80) {
+    *temperature = -*temperature;
+  }
+  return ESP_OK;
+}
+
+static void dht_task(void *arg) {
+  uint32_t failures = 0;
+  TickType_t last_wake = xTaskGetTickCount();
+  for (;;) {
+    float t, h;
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = dht_read(&t, &h);
+    trace_span("dht_read", t0, err);
+    if (err == ESP_OK) {
+      failures = 0;
+      reading_cb(t, h);
+    } else if (++failures == 1 || failures % 30 == 0) {
+      // 센서가 빠져 있으면 2 초마다 찍히므로 처음과 1 분마다만 남긴다.
+      log_w("DHT read failed: 0x%x (%u in a row)", err, failures);
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DHT_INTERVAL_MS));
+  }
+}
+
+esp_err_t dht_sensor_start(uint8_t pin, dht_reading_cb_t on_reading, BaseType_t core_id) {
+  if (rx_chan) {
+    return ESP_OK;
+  }
+  dht_pin = (gpio_num_t)pin;
+  reading_cb = on_reading;
+  rx_done = xSemaphoreCreateBinary();
+  if (!rx_done) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  rmt_rx_channel_config_t cfg = {};
+  cfg.gpio_num = dht_pin;
+  cfg.clk_src = RMT_CLK_SRC_DEFAULT;
+  cfg.resolution_hz = DHT_RMT_RESOLUTION_HZ;
+  cfg.mem_block_symbols = DHT_RMT_SYMBOLS;
+  esp_err_t err = rmt_new_rx_channel(&cfg, &rx_chan);
+  if (err != ESP_OK) {
+    return err;
+  }
+  rmt_rx_event_callbacks_t cbs = {};
+  cbs.on_recv_done = dht_rx_done;
+  err = rmt_rx_register_event_callbacks(rx_chan, &cbs, NULL);
+  if (err == ESP_OK) {
+    err = rmt_enable(rx_chan);
+  }
+  if (err != ESP_OK) {
+    rmt_del_channel(rx_chan);
+    rx_chan = NULL;
+    return err;
+  }
+
+  // RMT 가 입력을 가져간 뒤 같은 핀을 오픈 드레인 출력으로도 열어 시작 신호를 낸다.
+  gpio_set_direction(dht_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_pullup_en(dht_pin);
+  gpio_set_level(dht_pin, 1);
+
+  if (xTaskCreatePinnedToCore(dht_task, "dht", 3072, NULL, 2, NULL, core_id) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,19 @@
+// DHT22 온습도 센서를 RMT 수신으로 읽는 전용 태스크
+//
+// DHT 라이브러리는 40 비트를 받는 약 4~5ms 동안 인터럽트를 끄고 비트뱅으로 펄스 길이를 잰다.
+// 그동안 카메라 DMA 인터럽트와 WiFi 가 밀려 스트림 프레임 간격이 흔들린다.
+// 여기서는 시작 신호(1ms 이상 LOW)만 GPIO 로 내고, 센서 응답 펄스는 RMT 주변장치가 캡처하게 한다.
+// 태스크는 수신 완료를 세마포어로 기다리므로 읽는 동안 CPU 를 쓰지 않는다.
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define DHT_INTERVAL_MS 2000  // DHT22 는 2 초에 한 번보다 자주 읽을 수 없다
+
+// 읽기에 성공할 때마다 dht 태스크에서 불린다.
+typedef void (*dht_reading_cb_t)(float temperature, float humidity);
+
+// RMT 수신 채널을 잡고 DHT_INTERVAL_MS 마다 읽는 태스크를 시작한다.
+esp_err_t dht_sensor_start(uint8_t pin, dht_reading_cb_t on_reading, BaseType_t core_id);
@@ -0,0 +1,390 @@
+// 사건 전 영상 기록 구현 (event_clip.h 참고)
+#include "event_clip.h"
+#include "frame_broadcaster.h"
+#include "sensor_snapshot.h"
+#include "trace.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+#define EVENT_TEMP_SAMPLES 32  // 온도 상승을 보려고 남겨 두는 DHT 읽기 수 (2 초마다면 64 초)
+#define EVENT_AVI_HEADER   224 // RIFF + hdrl LIST + movi LIST 머리
+#define EVENT_AVI_INDEX    16  // idx1 을 이만큼씩 모아 보낸다
+
+static uint8_t *ring = NULL;
+static size_t ring_cap;
+static event_frame_t *frames = NULL;   // EVENT_MAX_FRAMES 개
+static SemaphoreHandle_t lock = NULL;
+static SemaphoreHandle_t rearmed = NULL;  // 언 링을 풀면 give
+
+// 아래는 lock 으로 보호
+static uint32_t first, count;   // 가장 오래된 프레임의 번호와 프레임 수
+static size_t bytes;
+static uint32_t write_off;      // 다음 프레임을 쓸 위치
+static event_state_t state = EVENT_OFF;
+static event_trigger_t trigger = EVENT_TRIGGER_NONE;
+static int64_t trigger_us;
+static uint32_t events;
+static int readers;             // 빌려 간 클립 수
+
+// 기록 태스크만 쓰는 상태
+static uint32_t flame_seen;     // 이미 본 불꽃 에지 번호
+static int64_t dht_seen;
+static struct {
+  int64_t time_us;
+  float temperature;
+} temps[EVENT_TEMP_SAMPLES];
+static uint32_t temp_count;
+
+const char *event_trigger_name(event_trigger_t why) {
+  switch (why) {
+    case EVENT_TRIGGER_FLAME:  return "flame";
+    case EVENT_TRIGGER_TEMP:   return "temperature";
+    case EVENT_TRIGGER_MANUAL: return "manual";
+    default:                   return "";
+  }
+}
+
+void event_clip_trigger(event_trigger_t why) {
+  if (!lock) {
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (state == EVENT_RECORDING) {
+    state = EVENT_POST;
+    trigger = why;
+    trigger_us = esp_timer_get_time();
+    events++;
+    log_i("Event triggered: %s", event_trigger_name(why));
+  }
+  xSemaphoreGive(lock);
+}
+
+// 불꽃 감지 에지와 온도 상승을 확인한다.
+static void check_sensors(void) {
+  sensor_snapshot_t snap;
+  sensor_snapshot_read(&snap);
+  if (snap.flame.seq != flame_seen) {
+    flame_seen = snap.flame.seq;
+    if (snap.flame.state == 0) {
+      event_clip_trigger(EVENT_TRIGGER_FLAME);
+    }
+  }
+  if (snap.dht_us == dht_seen || isnan(snap.temperature)) {
+    return;
+  }
+  dht_seen = snap.dht_us;
+  temps[temp_count % EVENT_TEMP_SAMPLES] = {snap.dht_us, snap.temperature};
+  temp_count++;
+  float lowest = snap.temperature;
+  for (uint32_t i = 0; i < min(temp_count, (uint32_t)EVENT_TEMP_SAMPLES); i++) {
+    if (snap.dht_us - temps[i].time_us <= EVENT_TEMP_WINDOW_MS * 1000LL) {
+      lowest = min(lowest, temps[i].temperature);
+    }
+  }
+  if (snap.temperature - lowest >= EVENT_TEMP_RISE_C) {
+    temp_count = 0;  // 같은 상승으로 다시 트리거하지 않도록 기준을 새로 잡는다.
+    event_clip_trigger(EVENT_TRIGGER_TEMP);
+  }
+}
+
+// 프레임 하나를 링 끝에 복사한다. 자리를 만들려고 겹치는 가장 오래된 프레임부터 지운다.
+static void record(const broadcast_frame_t *f) {
+  if (f->len > ring_cap) {
+    return;
+  }
+  uint32_t len = f->len;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  uint32_t off = write_off;
+  bool wrap = off + len > ring_cap;
+  if (wrap) {
+    off = 0;
+  }
+  while (count > 0) {
+    const event_frame_t *o = &frames[first];
+    bool tail = wrap && o->off >= write_off;  // 처음으로 돌아가면 끝쪽에 남은 프레임이 가장 오래됨
+    bool overlap = o->off < off + len && o->off + o->len > off;
+    if (!tail && !overlap && count < EVENT_MAX_FRAMES) {
+      break;
+    }
+    bytes -= o->len;
+    first = (first + 1) % EVENT_MAX_FRAMES;
+    count--;
+  }
+  xSemaphoreGive(lock);
+
+  // 얼어 있지 않은 동안 링은 이 태스크만 건드리므로 잠그지 않고 복사한다.
+  memcpy(ring + off, f->buf, len);
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  event_frame_t *e = &frames[(first + count) % EVENT_MAX_FRAMES];
+  e->off = off;
+  e->len = len;
+  e->time_us = f->timestamp.tv_sec * 1000000LL + f->timestamp.tv_usec;
+  e->width = f->width;
+  e->height = f->height;
+  count++;
+  bytes += len;
+  write_off = off + len;
+  xSemaphoreGive(lock);
+}
+
+static void event_task(void *arg) {
+  broadcast_sub_t *sub = NULL;
+  for (;;) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (state == EVENT_POST && esp_timer_get_time() - trigger_us >= EVENT_POST_MS * 1000LL) {
+      state = EVENT_FROZEN;
+      log_i("Event clip frozen: %lu frames", (unsigned long)count);
+    }
+    bool frozen = state == EVENT_FROZEN;
+    xSemaphoreGive(lock);
+
+    if (frozen) {
+      // 얼어 있는 동안은 구독을 끊어 다른 클라이언트가 없으면 카메라를 쉬게 한다.
+      if (sub) {
+        broadcast_unsubscribe(sub);
+        sub = NULL;
+      }
+      xSemaphoreTake(rearmed, portMAX_DELAY);
+      continue;
+    }
+    if (!sub && !(sub = broadcast_subscribe_recorder(EVENT_RECORD_INTERVAL_MS))) {
+      vTaskDelay(pdMS_TO_TICKS(1000));  // 구독자 자리가 빌 때까지
+      continue;
+    }
+
+    check_sensors();
+    broadcast_frame_t *f = broadcast_wait_frame(sub, pdMS_TO_TICKS(200));
+    if (f) {
+      int64_t t0 = esp_timer_get_time();
+      record(f);
+      trace_span("event_record", t0, f->len);
+      broadcast_release(f);
+    }
+  }
+}
+
+esp_err_t event_clip_start(void) {
+  if (lock) {
+    return ESP_OK;
+  }
+  if (!psramFound()) {
+    log_w("Event clip needs PSRAM");
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  ring_cap = min((size_t)EVENT_RING_MAX_BYTES, heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) / 2);
+  ring = (uint8_t *)ps_malloc(ring_cap);
+  frames = (event_frame_t *)ps_malloc(EVENT_MAX_FRAMES * sizeof(event_frame_t));
+  lock = xSemaphoreCreateMutex();
+  rearmed = xSemaphoreCreateBinary();
+  if (!ring || !frames || !lock || !rearmed) {
+    return ESP_ERR_NO_MEM;
+  }
+  sensor_snapshot_t snap;
+  sensor_snapshot_read(&snap);
+  flame_seen = snap.flame.seq;  // 부팅 전부터 이어지는 상태로는 트리거하지 않는다.
+  state = EVENT_RECORDING;
+  if (xTaskCreate(event_task, "event", 4096, NULL, 4, NULL) != pdPASS) {
+    state = EVENT_OFF;
+    return ESP_FAIL;
+  }
+  log_i("Event ring: %u KB", (unsigned)(ring_cap / 1024));
+  return ESP_OK;
+}
+
+esp_err_t event_clip_rearm(void) {
+  if (!lock) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = ESP_OK;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (readers > 0) {
+    err = ESP_ERR_INVALID_STATE;
+  } else if (state == EVENT_FROZEN) {
+    state = EVENT_RECORDING;
+    first = count = write_off = 0;
+    bytes = 0;
+    xSemaphoreGive(rearmed);
+  }
+  xSemaphoreGive(lock);
+  return err;
+}
+
+esp_err_t event_clip_open(event_clip_t *clip) {
+  if (!lock) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (state == EVENT_FROZEN && count > 0) {
+    readers++;
+    clip->ring = ring;
+    clip->frames = frames;
+    clip->first = first;
+    clip->count = count;
+    err = ESP_OK;
+  }
+  xSemaphoreGive(lock);
+  return err;
+}
+
+void event_clip_close(event_clip_t *clip) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  readers--;
+  xSemaphoreGive(lock);
+  clip->count = 0;
+}
+
+void event_clip_get_status(event_status_t *out) {
+  memset(out, 0, sizeof(*out));
+  if (!lock) {
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  out->state = state;
+  out->trigger = trigger;
+  out->trigger_us = trigger_us;
+  out->events = events;
+  out->frames = count;
+  out->bytes = bytes;
+  out->capacity = ring_cap;
+  if (count > 0) {
+    out->first_us = frames[first].time_us;
+    out->last_us = frames[(first + count - 1) % EVENT_MAX_FRAMES].time_us;
+  }
+  xSemaphoreGive(lock);
+}
+
+// ===========================
+// MJPEG AVI
+// ===========================
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v) {
+  p = put16(p, v);
+  return put16(p, v >> 16);
+}
+
+static uint8_t *put_cc(uint8_t *p, const char *cc) {
+  memcpy(p, cc, 4);
+  return p + 4;
+}
+
+esp_err_t event_clip_write_avi(const event_clip_t *clip, event_write_cb_t write, void *arg) {
+  uint32_t n = clip->count;
+  uint32_t max_len = 0;
+  uint32_t movi_len = 4;
+  for (uint32_t i = 0; i < n; i++) {
+    const event_frame_t *f = event_clip_frame(clip, i);
+    max_len = max(max_len, f->len);
+    movi_len += 8 + f->len + (f->len & 1);
+  }
+  const event_frame_t *last = event_clip_frame(clip, n - 1);
+  uint32_t us_per_frame = n > 1 ? (last->time_us - event_clip_frame(clip, 0)->time_us) / (n - 1) : 50000;
+  if (us_per_frame == 0) {
+    us_per_frame = 1;
+  }
+
+  uint8_t hdr[EVENT_AVI_HEADER];
+  uint8_t *p = hdr;
+  p = put_cc(p, "RIFF");
+  p = put32(p, 4 + (8 + 192) + (8 + movi_len) + (8 + 16 * n));
+  p = put_cc(p, "AVI ");
+  p = put_cc(p, "LIST");
+  p = put32(p, 192);
+  p = put_cc(p, "hdrl");
+  p = put_cc(p, "avih");
+  p = put32(p, 56);
+  p = put32(p, us_per_frame);
+  p = put32(p, (uint64_t)max_len * 1000000 / us_per_frame);  // dwMaxBytesPerSec
+  p = put32(p, 0);                                            // dwPaddingGranularity
+  p = put32(p, 0x10);                                         // AVIF_HASINDEX
+  p = put32(p, n);
+  p = put32(p, 0);                                            // dwInitialFrames
+  p = put32(p, 1);                                            // dwStreams
+  p = put32(p, max_len);                                      // dwSuggestedBufferSize
+  p = put32(p, last->width);
+  p = put32(p, last->height);
+  for (int i = 0; i < 4; i++) {
+    p = put32(p, 0);
+  }
+  p = put_cc(p, "LIST");
+  p = put32(p, 116);
+  p = put_cc(p, "strl");
+  p = put_cc(p, "strh");
+  p = put32(p, 56);
+  p = put_cc(p, "vids");
+  p = put_cc(p, "MJPG");
+  p = put32(p, 0);                                            // dwFlags
+  p = put16(p, 0);                                            // wPriority
+  p = put16(p, 0);                                            // wLanguage
+  p = put32(p, 0);                                            // dwInitialFrames
+  p = put32(p, us_per_frame);                                 // dwScale
+  p = put32(p, 1000000);                                      // dwRate
+  p = put32(p, 0);                                            // dwStart
+  p = put32(p, n);                                            // dwLength
+  p = put32(p, max_len);
+  p = put32(p, 0xFFFFFFFF);                                   // dwQuality
+  p = put32(p, 0);                                            // dwSampleSize
+  p = put16(p, 0);
+  p = put16(p, 0);
+  p = put16(p, last->width);
+  p = put16(p, last->height);
+  p = put_cc(p, "strf");
+  p = put32(p, 40);
+  p = put32(p, 40);                                           // biSize
+  p = put32(p, last->width);
+  p = put32(p, last->height);
+  p = put16(p, 1);                                            // biPlanes
+  p = put16(p, 24);                                           // biBitCount
+  p = put_cc(p, "MJPG");
+  p = put32(p, (uint32_t)last->width * last->height * 3);
+  for (int i = 0; i < 4; i++) {
+    p = put32(p, 0);
+  }
+  p = put_cc(p, "LIST");
+  p = put32(p, movi_len);
+  p = put_cc(p, "movi");
+  esp_err_t err = write(arg, hdr, p - hdr);
+
+  static const uint8_t pad = 0;
+  for (uint32_t i = 0; i < n && err == ESP_OK; i++) {
+    const event_frame_t *f = event_clip_frame(clip, i);
+    uint8_t chunk[8];
+    put32(put_cc(chunk, "00dc"), f->len);
+    err = write(arg, chunk, sizeof(chunk));
+    if (err == ESP_OK) {
+      err = write(arg, clip->ring + f->off, f->len);
+    }
+    if (err == ESP_OK && (f->len & 1)) {
+      err = write(arg, &pad, 1);
+    }
+  }
+
+  uint8_t idx[EVENT_AVI_INDEX * 16];
+  p = put32(put_cc(idx, "idx1"), 16 * n);
+  if (err == ESP_OK) {
+    err = write(arg, idx, p - idx);
+  }
+  uint32_t offset = 4;  // 'movi' 로부터
+  for (uint32_t i = 0; i < n && err == ESP_OK;) {
+    p = idx;
+    for (int k = 0; k < EVENT_AVI_INDEX && i < n; k++, i++) {
+      const event_frame_t *f = event_clip_frame(clip, i);
+      p = put_cc(p, "00dc");
+      p = put32(p, 0x10);                                     // AVIIF_KEYFRAME
+      p = put32(p, offset);
+      p = put32(p, f->len);
+      offset += 8 + f->len + (f->len & 1);
+    }
+    err = write(arg, idx, p - idx);
+  }
+  return err;
+}
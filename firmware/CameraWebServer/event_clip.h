@@ -0,0 +1,92 @@
+// 사건 전 영상 기록 (/event)
+//
+// 불꽃이 감지되거나 온도가 빠르게 오를 때, 그 뒤뿐 아니라 그 앞 몇 초도 보려고 최근 JPEG 프레임을 PSRAM
+// 링에 계속 기록한다. 프레임은 브로드캐스터의 기록용 구독자로 받으므로 이미 카메라 버퍼에서 복사된
+// 것이고, /stream 이 받을 프레임을 가로채지 않는다.
+//
+// 링은 바이트 영역 하나에 프레임을 이어 쓰고, 끝에 자리가 없으면 처음으로 돌아가 겹치는 가장 오래된
+// 프레임부터 지운다. 크기는 부팅 때 PSRAM 여유의 절반까지, 최대 EVENT_RING_MAX_BYTES 이다.
+// QVGA(약 10KB)를 20fps 로 받으면 2MB 에 약 10 초가 들어간다. 스트림 클라이언트가 없으면 브로드캐스터가
+// EVENT_RECORD_INTERVAL_MS 마다만 캡처하므로 그만큼 더 긴 시간이 들어간다.
+//
+// 트리거(불꽃 감지 에지, EVENT_TEMP_WINDOW_MS 안에서 EVENT_TEMP_RISE_C 이상 오른 온도, /event/trigger)가
+// 오면 EVENT_POST_MS 동안 더 기록한 뒤 링을 얼린다. 언 링은 /event/rearm 까지 바뀌지 않으므로
+// /event/clip 은 잠금 없이 읽어 보낸다. 얼어 있는 동안은 구독을 끊어 카메라를 쉬게 한다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define EVENT_RING_MAX_BYTES (2 * 1024 * 1024)
+#define EVENT_MAX_FRAMES     512      // 링에 둘 수 있는 최대 프레임 수
+#define EVENT_POST_MS        2000     // 트리거 뒤에 더 기록하는 시간
+#define EVENT_RECORD_INTERVAL_MS 100  // 스트림 클라이언트가 없을 때의 기록 간격 (10fps)
+#define EVENT_TEMP_RISE_C    3.0f     // 이만큼 오르면 트리거
+#define EVENT_TEMP_WINDOW_MS 30000    // 온도 상승을 보는 구간
+
+typedef enum {
+  EVENT_OFF,        // PSRAM 이 없거나 초기화 실패
+  EVENT_RECORDING,  // 트리거를 기다리며 기록 중
+  EVENT_POST,       // 트리거 뒤 EVENT_POST_MS 동안 더 기록 중
+  EVENT_FROZEN,     // 기록을 멈추고 클립을 보관 중
+} event_state_t;
+
+typedef enum {
+  EVENT_TRIGGER_NONE,
+  EVENT_TRIGGER_FLAME,
+  EVENT_TRIGGER_TEMP,
+  EVENT_TRIGGER_MANUAL,
+} event_trigger_t;
+
+typedef struct {
+  uint32_t off;      // 링 안의 위치
+  uint32_t len;
+  int64_t time_us;   // 원본 프레임 버퍼의 캡처 시각 (esp_timer 기준)
+  uint16_t width;
+  uint16_t height;
+} event_frame_t;
+
+typedef struct {
+  event_state_t state;
+  event_trigger_t trigger;  // 마지막 트리거
+  int64_t trigger_us;       // 마지막 트리거 시각 (0: 없음)
+  uint32_t events;          // 부팅 뒤 트리거 수
+  uint32_t frames;          // 링에 있는 프레임 수
+  size_t bytes;             // 그 프레임들의 크기 합
+  size_t capacity;          // 링 크기
+  int64_t first_us;         // 가장 오래된 프레임과 가장 새 프레임의 캡처 시각
+  int64_t last_us;
+} event_status_t;
+
+// 언 링을 읽는 동안 빌려 쓰는 클립. event_clip_close() 전까지 링은 다시 기록되지 않는다.
+typedef struct {
+  const uint8_t *ring;
+  const event_frame_t *frames;  // frames[(first + i) % EVENT_MAX_FRAMES], 오래된 것부터
+  uint32_t first;
+  uint32_t count;
+} event_clip_t;
+
+// 링을 잡고 기록 태스크를 시작한다. 브로드캐스터를 시작한 뒤에 부른다.
+esp_err_t event_clip_start(void);
+
+// 트리거를 건다 (이미 트리거된 뒤면 무시). 어느 태스크에서나 부를 수 있다.
+void event_clip_trigger(event_trigger_t why);
+
+// 언 링을 풀고 다시 기록한다. 클립을 읽는 중이면 ESP_ERR_INVALID_STATE.
+esp_err_t event_clip_rearm(void);
+
+// 언 링을 클립으로 빌린다. 얼어 있지 않으면 ESP_ERR_NOT_FOUND.
+esp_err_t event_clip_open(event_clip_t *clip);
+void event_clip_close(event_clip_t *clip);
+
+static inline const event_frame_t *event_clip_frame(const event_clip_t *clip, uint32_t i) {
+  return &clip->frames[(clip->first + i) % EVENT_MAX_FRAMES];
+}
+
+// 클립을 MJPEG AVI 파일 하나로 만들어 조각마다 write 에 넘긴다. write 가 실패하면 그 값을 돌려준다.
+typedef esp_err_t (*event_write_cb_t)(void *arg, const uint8_t *data, size_t len);
+esp_err_t event_clip_write_avi(const event_clip_t *clip, event_write_cb_t write, void *arg);
+
+void event_clip_get_status(event_status_t *out);
+const char *event_trigger_name(event_trigger_t why);
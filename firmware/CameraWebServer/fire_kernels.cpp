@@ -0,0 +1,124 @@
+// 불꽃 후보 화소 색 규칙 커널 구현 (fire_kernels.h 참고)
+#include "fire_kernels.h"
+#include "esp_heap_caps.h"
+#include <Arduino.h>
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "fire_color_mask() reads RGB565 pixels as little-endian words"
+#endif
+
+// 빅엔디언 RGB565 화소 두 바이트를 리틀엔디언 16 비트로 읽은 값(바이트가 뒤바뀐 색)으로 찾는다.
+// 그래서 화소마다 바이트를 바꿀 필요가 없다.
+static uint8_t *color_table = NULL;  // 65536 비트
+
+bool fire_color_rule(int r, int g, int b) {
+  if (r <= FIRE_R_MIN || r < g || g <= b) {
+    return false;
+  }
+  // BT.601 정수 근사
+  int y = (77 * r + 150 * g + 29 * b) >> 8;
+  int cb = ((-43 * r - 85 * g + 128 * b) >> 8) + 128;
+  int cr = ((128 * r - 107 * g - 21 * b) >> 8) + 128;
+  return y >= cb && cr >= cb && cr - cb >= FIRE_CRCB_MIN;
+}
+
+esp_err_t fire_kernels_init(void) {
+  if (color_table) {
+    return ESP_OK;
+  }
+  uint8_t *t = (uint8_t *)heap_caps_calloc(65536 / 8, 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!t) {
+    return ESP_ERR_NO_MEM;
+  }
+  for (uint32_t raw = 0; raw < 65536; raw++) {
+    uint16_t px = (uint16_t)((raw >> 8) | (raw << 8));
+    int r = (px >> 11) & 0x1F;
+    int g = (px >> 5) & 0x3F;
+    int b = px & 0x1F;
+    if (fire_color_rule((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2))) {
+      t[raw >> 3] |= 1 << (raw & 7);
+    }
+  }
+  color_table = t;
+  return ESP_OK;
+}
+
+void fire_color_mask(const uint8_t *rgb565, int width, int height, uint8_t *mask, fire_mask_result_t *out) {
+  const uint8_t *table = color_table;
+  uint32_t total = 0;
+  int x0 = width, x1 = -1, y0 = height, y1 = -1;
+  for (int y = 0; y < height; y++) {
+    const uint16_t *row = (const uint16_t *)(rgb565 + (size_t)y * width * 2);
+    uint8_t *mrow = mask ? mask + (size_t)y * width : NULL;
+    uint32_t n = 0;
+    int first = -1, last = -1;
+    for (int x = 0; x < width; x++) {
+      uint16_t v = row[x];
+      uint32_t bit = (table[v >> 3] >> (v & 7)) & 1;
+      n += bit;
+      if (mrow) {
+        mrow[x] = bit;
+      }
+      if (bit) {
+        if (first < 0) {
+          first = x;
+        }
+        last = x;
+      }
+    }
+    if (n) {
+      total += n;
+      x0 = min(x0, first);
+      x1 = max(x1, last);
+      y0 = min(y0, y);
+      y1 = y;
+    }
+  }
+  out->pixels = total;
+  if (total) {
+    out->x0 = x0;
+    out->y0 = y0;
+    out->x1 = x1 + 1;
+    out->y1 = y1 + 1;
+  } else {
+    out->x0 = out->y0 = out->x1 = out->y1 = 0;
+  }
+}
+
+uint32_t fire_luma_sum(const uint8_t *rgb565, int width, int x0, int y0, int x1, int y1) {
+  uint32_t sum = 0;
+  for (int y = y0; y < y1; y++) {
+    const uint8_t *p = rgb565 + ((size_t)y * width + x0) * 2;
+    for (int x = x0; x < x1; x++, p += 2) {
+      sum += rgb565_luma(p);
+    }
+  }
+  return sum;
+}
+
+void fire_mask_gate(const uint8_t *mask, const uint8_t *gate, int width, int height, fire_mask_result_t *out) {
+  uint32_t total = 0;
+  int x0 = width, x1 = -1, y0 = height, y1 = -1;
+  for (int y = 0; y < height; y++) {
+    const uint8_t *mrow = mask + (size_t)y * width;
+    const uint8_t *grow = gate + (size_t)y * width;
+    for (int x = 0; x < width; x++) {
+      if (mrow[x] & grow[x]) {
+        total++;
+        x0 = min(x0, x);
+        x1 = max(x1, x);
+        y0 = min(y0, y);
+        y1 = y;
+      }
+    }
+  }
+  out->pixels = total;
+  if (total) {
+    out->x0 = x0;
+    out->y0 = y0;
+    out->x1 = x1 + 1;
+    out->y1 = y1 + 1;
+  } else {
+    out->x0 = out->y0 = out->x1 = out->y1 = 0;
+  }
+}
@@ -0,0 +1,41 @@
+// 불꽃 후보 화소 색 규칙 커널
+//
+// 화소가 불꽃 색인지는 RGB 규칙(R > FIRE_R_MIN, R >= G > B)과 YCbCr 규칙(Y >= Cb, Cr >= Cb,
+// Cr - Cb >= FIRE_CRCB_MIN)을 모두 만족하는지로 정한다. RGB565 색은 65536 개뿐이므로 부팅 때 모든
+// 색에 규칙을 적용해 1 비트씩 표(8KB, 내부 RAM)에 담아 두고, 프레임에서는 화소마다 표를 한 번 찾기만
+// 한다. 곱셈과 비교가 없어 벡터 명령이 없는 ESP32 에서도 화소당 몇 사이클이며 호스트에서도 같게 돈다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define FIRE_R_MIN    115  // 불꽃 화소의 최소 R (0~255)
+#define FIRE_CRCB_MIN 40   // 불꽃 화소의 최소 Cr - Cb
+
+typedef struct {
+  uint32_t pixels;           // 규칙을 만족한 화소 수
+  uint16_t x0, y0, x1, y1;   // 그 화소들을 감싸는 상자 (x1, y1 은 포함하지 않음, pixels 가 0 이면 모두 0)
+} fire_mask_result_t;
+
+// 색 표를 만든다. 처음 한 번만 만들고 다시 부르면 그냥 돌아온다.
+esp_err_t fire_kernels_init(void);
+
+// 규칙 하나를 그대로 계산한다 (표를 만들 때와 시험용). r, g, b 는 0~255.
+bool fire_color_rule(int r, int g, int b);
+
+// jpg2rgb565() 가 낸 RGB565(빅엔디언) 영상에서 불꽃 색 화소를 센다.
+// mask 가 NULL 이 아니면 화소마다 1(불꽃 색)/0 을 쓴다 (width * height 바이트).
+void fire_color_mask(const uint8_t *rgb565, int width, int height, uint8_t *mask, fire_mask_result_t *out);
+
+// RGB565(빅엔디언) 화소 하나의 밝기(BT.601 Y, 0~250). 5/6/5 비트를 8 비트로 늘린 값에 계수를 곱한 것과 같다.
+static inline uint8_t rgb565_luma(const uint8_t *p) {
+  uint16_t px = (p[0] << 8) | p[1];
+  return ((px >> 11) * (8 * 77) + ((px >> 5) & 0x3F) * (4 * 150) + (px & 0x1F) * (8 * 29)) >> 8;
+}
+
+// RGB565(빅엔디언) 영상의 [x0, x1) x [y0, y1) 영역 밝기(BT.601 Y, 0~255) 합을 구한다.
+uint32_t fire_luma_sum(const uint8_t *rgb565, int width, int x0, int y0, int x1, int y1);
+
+// mask 와 gate 가 모두 1 인 화소를 세고 감싸는 상자를 구한다 (둘 다 width * height 바이트).
+void fire_mask_gate(const uint8_t *mask, const uint8_t *gate, int width, int height, fire_mask_result_t *out);
@@ -0,0 +1,142 @@
+// 불꽃 센서 에지 인터럽트 구현 (flame_sensor.h 참고)
+#include "flame_sensor.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <Arduino.h>
+#include <atomic>
+
+#define RING_MASK (FLAME_EDGE_RING - 1)
+
+// seq 번 에지는 ring[seq & RING_MASK] 에 있다.
+static flame_edge_t ring[FLAME_EDGE_RING];
+static std::atomic<uint32_t> head(0);  // 마지막으로 넣은 에지의 seq
+
+static uint8_t flame_pin;
+static esp_timer_handle_t settle_timer = NULL;
+static flame_edge_cb_t edge_cb = NULL;
+
+// 인터럽트와 디바운스 타이머가 함께 쓰는 상태 (mux 로 보호)
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+static int level_now;        // 마지막으로 받아들인 레벨
+static int64_t accepted_us;  // 마지막으로 받아들인 에지 시각
+static int64_t bounce_us;    // 마지막으로 무시한 인터럽트 시각
+static uint32_t bounces;
+
+// 에지 -> HTTP 지연 통계 (stats_mux 로 보호)
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> served_seq(0);
+static flame_stats_t stats;
+
+static void IRAM_ATTR push_locked(int64_t time_us, int level) {
+  uint32_t seq = head.load(std::memory_order_relaxed) + 1;
+  flame_edge_t *e = &ring[seq & RING_MASK];
+  e->seq = seq;
+  e->level = level;
+  e->time_us = time_us;
+  head.store(seq, std::memory_order_release);
+  level_now = level;
+  accepted_us = time_us;
+  if (edge_cb) {
+    flame_state_t st = {level, seq, time_us};
+    edge_cb(&st);
+  }
+}
+
+static void IRAM_ATTR flame_isr(void) {
+  int64_t now = esp_timer_get_time();
+  int level = digitalRead(flame_pin);
+  int64_t settle_us = 0;
+  portENTER_CRITICAL_ISR(&mux);
+  if (now - accepted_us >= FLAME_DEBOUNCE_US) {
+    if (level != level_now) {
+      push_locked(now, level);
+    }
+  } else {
+    bounces++;
+    bounce_us = now;
+    settle_us = accepted_us + FLAME_DEBOUNCE_US - now;
+  }
+  portEXIT_CRITICAL_ISR(&mux);
+  if (settle_us > 0) {
+    // 이미 예약돼 있으면 ESP_ERR_INVALID_STATE 로 끝나며, 그 타이머가 대신 확인한다.
+    esp_timer_start_once(settle_timer, settle_us);
+  }
+}
+
+// 디바운스 구간이 끝난 뒤 핀을 다시 읽어, 채터링 끝에 레벨이 바뀌어 있으면 에지로 기록한다.
+static void settle_cb(void *arg) {
+  int level = digitalRead(flame_pin);
+  portENTER_CRITICAL(&mux);
+  if (level != level_now) {
+    // 채터링이 끝난 시각(마지막으로 무시한 인터럽트)을 에지 시각으로 쓴다.
+    push_locked(bounce_us, level);
+  }
+  portEXIT_CRITICAL(&mux);
+}
+
+esp_err_t flame_sensor_init(uint8_t pin, flame_edge_cb_t on_edge) {
+  if (settle_timer) {
+    return ESP_OK;
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = settle_cb;
+  args.name = "flame_settle";
+  esp_err_t err = esp_timer_create(&args, &settle_timer);
+  if (err != ESP_OK) {
+    return err;
+  }
+  flame_pin = pin;
+  edge_cb = on_edge;
+  pinMode(pin, INPUT);
+  level_now = digitalRead(pin);
+  if (edge_cb) {
+    flame_state_t st = {level_now, 0, esp_timer_get_time()};
+    edge_cb(&st);
+  }
+  attachInterrupt(digitalPinToInterrupt(pin), flame_isr, CHANGE);
+  return ESP_OK;
+}
+
+size_t flame_sensor_recent(flame_edge_t *out, size_t max) {
+  uint32_t h = head.load(std::memory_order_acquire);
+  // 인터럽트가 다음 에지를 쓰는 중일 수 있는 가장 오래된 슬롯은 읽지 않는다.
+  size_t n = min(max, (size_t)min(h, (uint32_t)FLAME_EDGE_RING - 1));
+  for (size_t i = 0; i < n; i++) {
+    out[i] = ring[(h - i) & RING_MASK];
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // 복사하는 동안 들어온 에지만큼 오래된 쪽이 덮어써졌을 수 있다.
+  uint32_t added = head.load(std::memory_order_relaxed) - h;
+  if (added >= FLAME_EDGE_RING - 1) {
+    return 0;
+  }
+  return min(n, (size_t)(FLAME_EDGE_RING - 1 - added));
+}
+
+void flame_sensor_mark_served(const flame_state_t *st, int64_t now_us) {
+  uint32_t prev = served_seq.load(std::memory_order_relaxed);
+  do {
+    if (st->seq <= prev) {
+      return;  // 이미 다른 응답이 먼저 실었다.
+    }
+  } while (!served_seq.compare_exchange_weak(prev, st->seq));
+
+  // 두 응답 사이에 에지가 여럿이면 가장 최근 것만 잰다 (나머지는 edges 목록으로 함께 보인다).
+  int64_t latency = now_us - st->last_edge_us;
+  portENTER_CRITICAL(&stats_mux);
+  stats.latency_samples++;
+  stats.latency_last_us = latency;
+  stats.latency_sum_us += latency;
+  stats.latency_max_us = max(stats.latency_max_us, latency);
+  portEXIT_CRITICAL(&stats_mux);
+}
+
+void flame_sensor_get_stats(flame_stats_t *out) {
+  portENTER_CRITICAL(&stats_mux);
+  *out = stats;
+  portEXIT_CRITICAL(&stats_mux);
+  portENTER_CRITICAL(&mux);
+  out->bounces = bounces;
+  portEXIT_CRITICAL(&mux);
+  out->edges = head.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,56 @@
+// 불꽃 센서 에지 인터럽트와 에지 이벤트 링
+//
+// 불꽃 핀의 CHANGE 인터럽트에서 esp_timer 시각을 찍어 에지를 링 버퍼에 넣는다.
+// 폴링 주기 사이에 지나간 짧은 깜빡임도 에지 기록으로 남는다.
+//
+// 디바운스: 마지막으로 받아들인 에지로부터 FLAME_DEBOUNCE_US 안에 들어온 인터럽트는 채터링으로 보고
+// 무시하되, 그 구간이 끝날 때 핀을 한 번 더 읽어 최종 레벨이 바뀌어 있으면 에지로 기록한다.
+// 그래서 첫 에지는 지연 없이 보이고, 채터링 끝의 레벨도 놓치지 않는다.
+//
+// 링은 인터럽트(와 디바운스 타이머)만 쓰고, HTTP 핸들러는 잠금 없이 읽는다.
+// 읽는 쪽은 head 를 읽고 복사한 뒤 head 를 다시 읽어, 그사이 덮어써진 항목을 버린다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define FLAME_EDGE_RING   32     // 링 크기 (2 의 거듭제곱)
+#define FLAME_DEBOUNCE_US 5000   // 이 간격 안의 에지는 채터링으로 봄
+
+typedef struct {
+  uint32_t seq;      // 1 부터 증가하는 에지 번호
+  uint8_t level;     // 에지 이후 레벨 (0: 불꽃 감지, 1: 정상)
+  int64_t time_us;   // esp_timer_get_time() 기준 에지 시각
+} flame_edge_t;
+
+typedef struct {
+  int state;              // 현재 레벨 (-1: 초기화 전)
+  uint32_t seq;           // 마지막 에지 번호 (0: 부팅 이후 에지 없음)
+  int64_t last_edge_us;   // 마지막 에지 시각 (에지가 없으면 초기화 시각)
+} flame_state_t;
+
+typedef struct {
+  uint32_t edges;            // 받아들인 에지 수
+  uint32_t bounces;          // 디바운스로 무시한 인터럽트 수
+  uint32_t latency_samples;  // 에지가 처음 HTTP 응답에 실린 횟수
+  int64_t latency_last_us;   // 에지 -> 처음 HTTP 응답에 실린 시각
+  int64_t latency_max_us;
+  int64_t latency_sum_us;
+} flame_stats_t;
+
+// 초기 레벨과 받아들인 에지마다 불린다. 인터럽트 문맥에서 불리므로 IRAM 에 두고 짧게 끝낸다.
+typedef void (*flame_edge_cb_t)(const flame_state_t *st);
+
+// 핀을 입력으로 잡고 현재 레벨을 읽은 뒤 CHANGE 인터럽트를 건다. on_edge 는 NULL 이어도 된다.
+// 이 모듈은 에지 기록만 가지며, 현재 상태는 on_edge 로 받아 sensor_snapshot 에 둔다.
+esp_err_t flame_sensor_init(uint8_t pin, flame_edge_cb_t on_edge);
+
+// 최근 에지를 새것부터 최대 max 개 복사하고 복사한 개수를 돌려준다.
+size_t flame_sensor_recent(flame_edge_t *out, size_t max);
+
+// on_edge 로 받은 상태를 HTTP 응답에 실었음을 알린다.
+// 그 에지가 처음 실린 것이면 에지 시각부터 now_us 까지를 지연으로 기록한다.
+void flame_sensor_mark_served(const flame_state_t *st, int64_t now_us);
+
+void flame_sensor_get_stats(flame_stats_t *out);
@@ -0,0 +1,119 @@
+// 불꽃 깜빡임 주파수 검출 구현 (flicker.h 참고)
+#include "flicker.h"
+#include <math.h>
+#include <string.h>
+
+#define N    FLICKER_WINDOW
+#define BINS (N / 2 + 1)  // 0 ~ N/2 번 빈
+
+static_assert((N & (N - 1)) == 0, "FLICKER_WINDOW must be a power of two");
+
+static int16_t cos_q15[N];  // cos(2πi/N), Q15
+static int16_t sin_q15[N];
+static bool tables_ready;
+
+static uint16_t ring[N];  // 샘플 (차기 전에는 0 이 채워진 창으로 본다)
+static int64_t times[N];
+static int head;          // 다음에 쓸 자리 = 가장 오래된 샘플
+static int count;
+static int since_sync;    // 마지막으로 다시 계산한 뒤 넣은 샘플 수
+
+// X_k = Σ x[m] e^(-j2πkm/N), m = 0 이 가장 오래된 샘플
+static int32_t re[BINS];
+static int32_t im[BINS];
+
+static void build_tables(void) {
+  for (int i = 0; i < N; i++) {
+    cos_q15[i] = (int16_t)lroundf(cosf(2 * (float)M_PI * i / N) * 32767);
+    sin_q15[i] = (int16_t)lroundf(sinf(2 * (float)M_PI * i / N) * 32767);
+  }
+  tables_ready = true;
+}
+
+// 창 전체로 빈을 다시 계산한다 (N * BINS 번 곱).
+static void resync(void) {
+  for (int k = 0; k < BINS; k++) {
+    int64_t sr = 0, si = 0;
+    for (int m = 0; m < N; m++) {
+      int32_t x = ring[(head + m) & (N - 1)];
+      int i = (k * m) & (N - 1);
+      sr += (int64_t)x * cos_q15[i];
+      si -= (int64_t)x * sin_q15[i];
+    }
+    re[k] = (int32_t)((sr + (1 << 14)) >> 15);
+    im[k] = (int32_t)((si + (1 << 14)) >> 15);
+  }
+}
+
+void flicker_reset(void) {
+  memset(ring, 0, sizeof(ring));
+  memset(re, 0, sizeof(re));
+  memset(im, 0, sizeof(im));
+  head = 0;
+  count = 0;
+  since_sync = 0;
+}
+
+void flicker_push(uint16_t luma_q8, int64_t time_us) {
+  if (!tables_ready) {
+    build_tables();
+  }
+  int32_t d = (int32_t)luma_q8 - ring[head];
+  ring[head] = luma_q8;
+  times[head] = time_us;
+  head = (head + 1) & (N - 1);
+  if (count < N) {
+    count++;
+  }
+  if (++since_sync >= N) {
+    since_sync = 0;
+    resync();
+    return;
+  }
+  // 슬라이딩 DFT: X_k <- (X_k + x_new - x_old) * e^(j2πk/N)
+  for (int k = 0; k < BINS; k++) {
+    int64_t a = re[k] + d;
+    int64_t b = im[k];
+    re[k] = (int32_t)((a * cos_q15[k] - b * sin_q15[k] + (1 << 14)) >> 15);
+    im[k] = (int32_t)((a * sin_q15[k] + b * cos_q15[k] + (1 << 14)) >> 15);
+  }
+}
+
+void flicker_get(flicker_result_t *out) {
+  memset(out, 0, sizeof(*out));
+  out->samples = count;
+  if (count < N || re[0] <= 0) {
+    return;
+  }
+  int64_t span = times[(head - 1) & (N - 1)] - times[head];
+  if (span <= 0) {
+    return;
+  }
+  float fs = (N - 1) * 1e6f / span;
+  out->rate_hz = fs;
+  int k0 = (int)ceilf(FLICKER_MIN_HZ * N / fs);
+  int k1 = (int)floorf(FLICKER_MAX_HZ * N / fs);
+  k0 = k0 < 1 ? 1 : k0;
+  k1 = k1 > N / 2 - 1 ? N / 2 - 1 : k1;
+
+  // Hann 창은 주파수 영역에서 (-1/4, 1/2, -1/4) 합성곱이다. 0 번 빈을 빼고 합성곱하면 평균을 뺀
+  // 신호에 창을 씌운 것과 같아, 평균 밝기가 낮은 빈으로 새지 않는다.
+  float energy = 0, best = 0;
+  int best_k = 0;
+  for (int k = k0; k <= k1; k++) {
+    float lr = k > 1 ? re[k - 1] : 0;
+    float li = k > 1 ? im[k - 1] : 0;
+    float hr = 0.5f * re[k] - 0.25f * (lr + re[k + 1]);
+    float hi = 0.5f * im[k] - 0.25f * (li + im[k + 1]);
+    float p = hr * hr + hi * hi;
+    energy += p;
+    if (p > best) {
+      best = p;
+      best_k = k;
+    }
+  }
+  // 빈 k 에 걸친 진폭 a 의 정현파는 Hann 창 뒤 띠 에너지가 3(Na)^2/32 이고, 0 번 빈은 N * 평균이다.
+  out->depth = sqrtf(energy * 32 / 3) / re[0];
+  out->peak_hz = best_k ? best_k * fs / N : 0;
+  out->flickering = out->depth >= FLICKER_MIN_DEPTH;
+}
@@ -0,0 +1,36 @@
+// 불꽃 깜빡임 주파수 검출
+//
+// 실제 불꽃은 1~15Hz 로 깜빡이지만 햇빛 반사나 붉은 물체는 밝기가 거의 그대로다. frame_analysis 가
+// 불꽃 후보 영역의 평균 밝기를 프레임마다 flicker_push() 로 넣으면, 최근 FLICKER_WINDOW 개 샘플의
+// DFT 를 슬라이딩 DFT 로 갱신한다. 샘플 하나에 빈(bin)마다 복소 곱 한 번이며 모두 고정소수점이다.
+// 반올림 오차가 쌓이지 않도록 FLICKER_WINDOW 샘플마다 창 전체로 다시 계산한다.
+//
+// 결과의 depth 는 Hann 창을 씌운 스펙트럼에서 FLICKER_MIN_HZ~FLICKER_MAX_HZ 띠의 진폭을 평균 밝기로
+// 나눈 값이다 (밝기가 평균의 ±30% 로 출렁이면 약 0.3). 샘플률은 프레임 시각에서 구하므로 띠의 위쪽은
+// 프레임률의 절반으로 잘린다 (25fps 면 12.5Hz).
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLICKER_WINDOW    64      // 창 크기 (샘플 수, 2 의 거듭제곱. 25fps 면 2.6 초)
+#define FLICKER_MIN_HZ    1.0f
+#define FLICKER_MAX_HZ    15.0f
+#define FLICKER_MIN_DEPTH 0.10f   // depth 가 이 이상이면 깜빡임으로 봄
+
+typedef struct {
+  uint16_t samples;  // 창에 든 샘플 수 (FLICKER_WINDOW 가 되기 전에는 depth 가 0)
+  float rate_hz;     // 창의 평균 샘플률
+  float depth;       // 띠 안 진폭 / 평균 밝기
+  float peak_hz;     // 띠 안에서 가장 센 주파수 (depth 가 0 이면 0)
+  bool flickering;   // depth >= FLICKER_MIN_DEPTH
+} flicker_result_t;
+
+// 창을 비운다. 후보 영역이 바뀌면 부른다.
+void flicker_reset(void);
+
+// 샘플 하나를 넣는다. luma_q8 은 평균 밝기(0~255)에 256 을 곱한 값, time_us 는 프레임 캡처 시각.
+void flicker_push(uint16_t luma_q8, int64_t time_us);
+
+// 현재 창으로 결과를 계산한다. flicker_push() 와 같은 태스크에서 부른다.
+void flicker_get(flicker_result_t *out);
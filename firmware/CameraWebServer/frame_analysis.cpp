@@ -0,0 +1,246 @@
+// 저해상도 프레임 분석 구현 (frame_analysis.h 참고)
+#include "frame_analysis.h"
+#include "fire_kernels.h"
+#include "motion.h"
+#include "frame_broadcaster.h"
+#include "trace.h"
+#include "metrics.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "img_converters.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+#include <atomic>
+
+static SemaphoreHandle_t lock = NULL;
+static analysis_result_t result;  // lock 으로 보호
+static analysis_stats_t stats;    // lock 으로 보호
+static std::atomic<uint32_t> analyzed_ms(0);  // 마지막으로 분석한 millis() (0: 아직 없음)
+static std::atomic<uint32_t> changed_ms(0);   // 마지막으로 장면이 바뀌었거나 후보를 잡고 있던 millis()
+
+// 분석 태스크만 쓰는 상태
+static uint8_t *rgb = NULL;       // 1/8 RGB565 영상
+static size_t rgb_cap;
+static uint8_t *fire_mask = NULL; // 불꽃 색 화소 (화소당 1 바이트)
+static size_t fire_mask_cap;
+static uint8_t *fg_mask = NULL;   // 전경 화소 (마지막 배경 갱신 때)
+static size_t fg_mask_cap;
+static int motion_w, motion_h;    // 배경 모델의 분석 해상도
+static int64_t motion_us;         // 마지막으로 배경을 갱신한 프레임 시각
+static bool tracking;             // 후보 영역을 잡고 있음
+static int misses;                // 영역에서 불꽃 색 화소가 안 보인 연속 프레임 수
+static int roi_x0, roi_y0, roi_x1, roi_y1;  // 후보 영역 (분석 해상도, x1/y1 은 포함하지 않음)
+static int track_w, track_h;      // 영역을 잡을 때의 분석 해상도
+static bool was_flickering;
+
+// 디코드 버퍼와 마스크를 잡는다. 커널이 화소마다 읽으므로 되도록 내부 RAM 에 둔다.
+static bool reserve(uint8_t **buf, size_t *cap, size_t size) {
+  if (*cap >= size) {
+    return true;
+  }
+  free(*buf);
+  *buf = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!*buf && psramFound()) {
+    *buf = (uint8_t *)ps_malloc(size);
+  }
+  *cap = *buf ? size : 0;
+  return *buf != NULL;
+}
+
+// 후보 영역을 갱신한다. 영역은 움직이는 불꽃 색 화소(moving)로만 새로 잡고, 잡은 뒤에는 불꽃 색
+// 화소(m)가 영역에 걸쳐 있는 동안 유지한다. 영역을 새로 잡으면 깜빡임 창을 비운다.
+static void track(const fire_mask_result_t *m, const fire_mask_result_t *moving, int w, int h) {
+  if (tracking && (w != track_w || h != track_h)) {
+    tracking = false;  // 해상도가 바뀌면 영역 좌표가 맞지 않는다
+  }
+  if (tracking) {
+    if (m->pixels && m->x0 < roi_x1 && roi_x0 < m->x1 && m->y0 < roi_y1 && roi_y0 < m->y1) {
+      misses = 0;
+      return;
+    }
+    if (++misses <= ANALYSIS_TRACK_MISSES) {
+      return;
+    }
+    tracking = false;
+  }
+  if (!moving->pixels) {
+    return;
+  }
+  roi_x0 = max(moving->x0 - 1, 0);
+  roi_y0 = max(moving->y0 - 1, 0);
+  roi_x1 = min(moving->x1 + 1, w);
+  roi_y1 = min(moving->y1 + 1, h);
+  track_w = w;
+  track_h = h;
+  misses = 0;
+  tracking = true;
+  flicker_reset();
+}
+
+// 프레임 하나를 분석해 result 에 싣는다. 실패하면 false.
+static bool analyze(const broadcast_frame_t *f) {
+  int w = f->width / 8;
+  int h = f->height / 8;
+  size_t n = (size_t)w * h;
+  if (n == 0 || n > ANALYSIS_MAX_PIXELS || !reserve(&rgb, &rgb_cap, n * 2) ||
+      !reserve(&fire_mask, &fire_mask_cap, n) || !reserve(&fg_mask, &fg_mask_cap, n)) {
+    return false;
+  }
+  if ((w != motion_w || h != motion_h) && motion_reset(w, h) != ESP_OK) {
+    return false;
+  }
+  int64_t t0 = esp_timer_get_time();
+  if (!jpg2rgb565(f->buf, f->len, rgb, JPG_SCALE_8X)) {
+    return false;
+  }
+  int64_t t1 = esp_timer_get_time();
+  int64_t frame_us = f->timestamp.tv_sec * 1000000LL + f->timestamp.tv_usec;
+  // 배경은 ANALYSIS_INTERVAL_MS 마다 갱신한다. 후보를 잡고 모든 프레임을 분석하는 동안에도 배경이
+  // 따라가는 속도는 그대로다.
+  motion_result_t mo = {};
+  bool motion_due = w != motion_w || h != motion_h || frame_us - motion_us >= ANALYSIS_INTERVAL_MS * 1000LL;
+  if (motion_due) {
+    if (w != motion_w || h != motion_h) {
+      motion_w = w;
+      motion_h = h;
+      mo.changed = true;  // 새 배경을 시작하는 것도 장면이 바뀐 것으로 본다
+    }
+    motion_result_t upd;
+    motion_update(rgb, fg_mask, &upd);
+    mo.fg_pixels = upd.fg_pixels;
+    mo.changed |= upd.changed;
+    motion_us = frame_us;
+  }
+  fire_mask_result_t m, moving;
+  fire_color_mask(rgb, w, h, fire_mask, &m);
+  fire_mask_gate(fire_mask, fg_mask, w, h, &moving);
+  flicker_result_t fl = {};
+  track(&m, &moving, w, h);
+  if (tracking) {
+    uint32_t area = (roi_x1 - roi_x0) * (roi_y1 - roi_y0);
+    uint32_t sum = fire_luma_sum(rgb, w, roi_x0, roi_y0, roi_x1, roi_y1);
+    flicker_push((sum << 8) / area, frame_us);
+    flicker_get(&fl);
+  }
+  int64_t t2 = esp_timer_get_time();
+  trace_span("analysis", t0, m.pixels);
+  metrics_observe(METRIC_ANALYSIS_TIME, t2 - t0);
+  uint32_t now_ms = millis();
+  if (mo.changed || tracking) {
+    changed_ms.store(now_ms, std::memory_order_relaxed);
+  }
+  analyzed_ms.store(now_ms ? now_ms : 1, std::memory_order_relaxed);
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  analysis_result_t *r = &result;
+  r->seq++;
+  r->frame_us = frame_us;
+  r->width = w;
+  r->height = h;
+  r->fire_pixels = m.pixels;
+  r->fire_ratio = (float)m.pixels / n;
+  r->fire_moving = moving.pixels;
+  r->box_x = m.x0 * 8;
+  r->box_y = m.y0 * 8;
+  r->box_w = (m.x1 - m.x0) * 8;
+  r->box_h = (m.y1 - m.y0) * 8;
+  r->decode_us = t1 - t0;
+  r->kernel_us = t2 - t1;
+  r->tracking = tracking;
+  r->roi_x = tracking ? roi_x0 * 8 : 0;
+  r->roi_y = tracking ? roi_y0 * 8 : 0;
+  r->roi_w = tracking ? (roi_x1 - roi_x0) * 8 : 0;
+  r->roi_h = tracking ? (roi_y1 - roi_y0) * 8 : 0;
+  r->flicker = fl;
+  if (motion_due) {
+    r->motion_pixels = mo.fg_pixels;
+    r->motion_changed = mo.changed;
+    stats.motion_frames += mo.changed;
+  }
+  stats.flicker_events += fl.flickering && !was_flickering;
+  was_flickering = fl.flickering;
+  stats.frames++;
+  stats.overruns += t2 - t0 > ANALYSIS_BUDGET_US;
+  xSemaphoreGive(lock);
+  return true;
+}
+
+static void analysis_task(void *arg) {
+  broadcast_sub_t *sub = NULL;
+  int64_t last = 0;
+  for (;;) {
+    if (!sub && !(sub = broadcast_subscribe_recorder(ANALYSIS_INTERVAL_MS))) {
+      vTaskDelay(pdMS_TO_TICKS(1000));  // 구독자 자리가 빌 때까지
+      continue;
+    }
+    broadcast_frame_t *f = broadcast_wait_frame(sub, pdMS_TO_TICKS(1000));
+    if (!f) {
+      continue;
+    }
+    int64_t now = esp_timer_get_time();
+    // 후보 영역을 잡고 있으면 깜빡임 샘플을 위해 모든 프레임을 분석한다
+    if (tracking || now - last >= ANALYSIS_INTERVAL_MS * 1000LL) {
+      last = now;
+      bool was_tracking = tracking;
+      if (!analyze(f)) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        stats.decode_failed++;
+        xSemaphoreGive(lock);
+      }
+      // 후보를 잡고 있는 동안은 클라이언트가 없어도 모든 프레임을 받는다
+      if (tracking != was_tracking) {
+        broadcast_recorder_interval(sub, tracking ? 0 : ANALYSIS_INTERVAL_MS);
+      }
+    }
+    broadcast_release(f);
+  }
+}
+
+esp_err_t analysis_start(void) {
+  if (lock) {
+    return ESP_OK;
+  }
+  esp_err_t err = fire_kernels_init();
+  if (err != ESP_OK) {
+    return err;
+  }
+  lock = xSemaphoreCreateMutex();
+  if (!lock) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (xTaskCreate(analysis_task, "analysis", 4096, NULL, 3, NULL) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+bool analysis_scene_changed(void) {
+  uint32_t now = millis();
+  uint32_t seen = analyzed_ms.load(std::memory_order_relaxed);
+  // 분석이 멈춰 있으면 장면을 알 수 없으므로 바뀐 것으로 본다
+  if (!seen || now - seen > ANALYSIS_SCENE_HOLD_MS) {
+    return true;
+  }
+  return now - changed_ms.load(std::memory_order_relaxed) < ANALYSIS_SCENE_HOLD_MS;
+}
+
+void analysis_get(analysis_result_t *out) {
+  if (!lock) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  *out = result;
+  xSemaphoreGive(lock);
+}
+
+void analysis_get_stats(analysis_stats_t *out) {
+  if (!lock) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  *out = stats;
+  xSemaphoreGive(lock);
+}
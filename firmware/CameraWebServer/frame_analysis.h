@@ -0,0 +1,68 @@
+// 저해상도 프레임 분석 (/fire)
+//
+// 불꽃 판단을 모두 서버에 맡기면 장면이 그대로여도 프레임을 계속 보내야 한다. 이 태스크는
+// 브로드캐스터의 기록용 구독자(클라이언트 자리를 쓰지 않음)로 프레임을 받아 ANALYSIS_INTERVAL_MS 마다
+// 한 장씩 JPEG 를 1/8 크기 RGB565 로 디코드하고(QVGA 면 40x30), 불꽃 색 화소의 비율과 그 화소들을 감싸는
+// 상자를 구한다 (fire_kernels.h). 1/8 디코드는 DCT 계수 중 DC 만 쓰므로 전체 디코드보다 훨씬 싸다.
+// 스트림 클라이언트가 없으면 브로드캐스터도 이 간격으로만 캡처한다.
+//
+// 같은 영상의 밝기로 배경 모델(motion.h)을 ANALYSIS_INTERVAL_MS 마다 갱신해 전경(움직임) 마스크를 얻는다.
+// 전경이 있으면 장면이 바뀐 것으로 보고, 그 뒤 ANALYSIS_SCENE_HOLD_MS 동안 analysis_scene_changed() 가
+// true 다. /stream 과 /ws 는 장면이 그대로인 동안 프레임을 솎아 보낸다.
+//
+// 움직이는 불꽃 색 화소가 보이면 그 상자를 한 칸씩 넓혀 후보 영역으로 고정하고, 그때부터는 프레임마다 분석해
+// 영역의 평균 밝기를 깜빡임 검출(flicker.h)에 넣는다. 불꽃 색 화소가 영역에서 ANALYSIS_TRACK_MISSES
+// 프레임 넘게 사라지면 영역을 놓고 다시 ANALYSIS_INTERVAL_MS 주기로 돌아간다.
+//
+// 디코드와 커널 시간을 프레임마다 재서 /metrics 의 fire_analysis_seconds 에 넣고, 합이
+// ANALYSIS_BUDGET_US 를 넘은 프레임을 overruns 로 센다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "flicker.h"
+
+#define ANALYSIS_INTERVAL_MS 100    // 분석 주기 (최대 10fps)
+#define ANALYSIS_BUDGET_US   5000   // 프레임 하나의 분석 시간 목표
+#define ANALYSIS_MAX_PIXELS  (200 * 150)  // UXGA 의 1/8
+#define ANALYSIS_TRACK_MISSES 5     // 후보 영역을 놓기 전까지 봐주는 프레임 수
+#define ANALYSIS_SCENE_HOLD_MS 2000 // 움직임이 멎은 뒤에도 장면이 바뀐 것으로 보는 시간
+
+typedef struct {
+  uint32_t seq;              // 분석한 프레임 수 (0: 아직 없음)
+  int64_t frame_us;          // 분석한 프레임의 캡처 시각 (esp_timer 기준)
+  uint16_t width;            // 분석 해상도 (프레임의 1/8)
+  uint16_t height;
+  uint32_t fire_pixels;      // 불꽃 색 화소 수 (분석 해상도 기준)
+  float fire_ratio;          // fire_pixels / (width * height)
+  uint32_t fire_moving;      // 그중 전경(움직이는) 화소 수
+  uint16_t box_x, box_y;     // 불꽃 색 화소를 감싸는 상자 (원본 프레임 좌표, fire_pixels 가 0 이면 0)
+  uint16_t box_w, box_h;
+  uint32_t decode_us;        // 1/8 디코드 시간
+  uint32_t kernel_us;        // 색 규칙과 깜빡임 계산 시간
+  bool tracking;             // 후보 영역을 잡고 있음
+  uint16_t roi_x, roi_y;     // 후보 영역 (원본 프레임 좌표, tracking 일 때만)
+  uint16_t roi_w, roi_h;
+  flicker_result_t flicker;  // 후보 영역의 깜빡임 (tracking 이 아니면 0)
+  uint32_t motion_pixels;    // 마지막 배경 갱신의 전경 화소 수
+  bool motion_changed;       // 그때 장면이 바뀌었는지
+} analysis_result_t;
+
+typedef struct {
+  uint32_t frames;         // 분석한 프레임 수
+  uint32_t overruns;       // ANALYSIS_BUDGET_US 를 넘긴 프레임 수
+  uint32_t decode_failed;  // 디코드 실패나 너무 큰 프레임
+  uint32_t flicker_events; // 깜빡임으로 바뀐 횟수
+  uint32_t motion_frames;  // 장면이 바뀐 것으로 본 배경 갱신 수
+} analysis_stats_t;
+
+// 색 표를 만들고 분석 태스크를 시작한다. 브로드캐스터를 시작한 뒤에 부른다.
+esp_err_t analysis_start(void);
+
+// 최근 ANALYSIS_SCENE_HOLD_MS 안에 움직임이 있었거나 불꽃 후보를 잡고 있으면 true.
+// 분석이 돌고 있지 않으면(시작 전, JPEG 가 아닌 포맷 등) 항상 true 다. 어느 태스크에서나 부를 수 있다.
+bool analysis_scene_changed(void);
+
+void analysis_get(analysis_result_t *out);
+void analysis_get_stats(analysis_stats_t *out);
@@ -0,0 +1,345 @@
+// 프레임 브로드캐스터 구현 (frame_broadcaster.h 참고)
+#include "frame_broadcaster.h"
+#include "trace.h"
+#include "metrics.h"
+#include "conv_pool.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "img_converters.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+// 클라이언트/기록용 자리
+#define BROADCAST_SLOTS (BROADCAST_MAX_SUBS + BROADCAST_MAX_RECORDERS)
+// 구독자마다 전송 중 1 개 + 대기 1 개(모두 같은 최신 프레임) + 채우는 중 1 개
+#define BROADCAST_POOL_SIZE (BROADCAST_SLOTS + 2)
+// 버퍼를 다시 잡는 횟수를 줄이기 위한 여유분
+#define BROADCAST_BUF_ALIGN 4096
+
+struct broadcast_sub {
+  SemaphoreHandle_t ready;    // 대기 프레임이 생기면 give
+  broadcast_frame_t *pending; // 아직 가져가지 않은 최신 프레임
+  uint32_t dropped;
+  bool used;
+  bool recorder;              // broadcast_subscribe_recorder() 로 구독
+  int64_t interval_us;        // 기록용 구독자가 필요한 프레임 간격
+};
+
+static broadcast_frame_t pool[BROADCAST_POOL_SIZE];
+static broadcast_sub_t subs[BROADCAST_SLOTS];  // 앞 BROADCAST_MAX_SUBS 개는 클라이언트, 나머지는 기록용
+static SemaphoreHandle_t lock = NULL;      // pool/subs 보호
+static SemaphoreHandle_t wake = NULL;      // 첫 구독자가 생기면 캡처 태스크를 깨움
+static broadcast_stats_t stats;
+static SemaphoreHandle_t settings_lock = NULL;  // 설정 묶음을 적용하는 동안 잡혀 있음
+static int64_t settings_us;                     // 마지막 설정 묶음 적용이 끝난 시각
+static bool settle_pending;                     // 그 뒤로 아직 프레임을 발행하지 않음
+
+static void frame_unref_locked(broadcast_frame_t *f) {
+  if (f && f->refs > 0 && --f->refs == 0 && f->conv) {
+    conv_pool_put(f->conv);
+    f->conv = NULL;
+  }
+}
+
+// 아무도 쓰지 않는 풀 슬롯을 캡처 태스크 소유로 가져온다.
+static broadcast_frame_t *frame_acquire(void) {
+  broadcast_frame_t *f = NULL;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (int i = 0; i < BROADCAST_POOL_SIZE; i++) {
+    if (pool[i].refs == 0) {
+      f = &pool[i];
+      f->refs = 1;
+      break;
+    }
+  }
+  xSemaphoreGive(lock);
+  return f;
+}
+
+// 슬롯 용량을 늘린다. 캡처 태스크만 참조를 가진 상태에서만 호출한다.
+static bool frame_reserve(broadcast_frame_t *f, size_t len) {
+  if (f->cap >= len) {
+    return true;
+  }
+  size_t cap = (len + BROADCAST_BUF_ALIGN - 1) / BROADCAST_BUF_ALIGN * BROADCAST_BUF_ALIGN;
+  free(f->copy_buf);
+  f->copy_buf = (uint8_t *)(psramFound() ? ps_malloc(cap) : malloc(cap));
+  f->cap = f->copy_buf ? cap : 0;
+  return f->copy_buf != NULL;
+}
+
+// 설정 묶음 적용 뒤 첫 프레임이면 적용이 끝나고 걸린 시간, 아니면 -1
+static int64_t settle_time(void) {
+  int64_t settle = -1;
+  xSemaphoreTake(settings_lock, portMAX_DELAY);
+  if (settle_pending) {
+    settle = esp_timer_get_time() - settings_us;
+    settle_pending = false;
+  }
+  xSemaphoreGive(settings_lock);
+  return settle;
+}
+
+static void publish(broadcast_frame_t *f) {
+  int64_t settle = settle_time();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (settle >= 0) {
+    stats.settle_us = settle;
+  }
+  f->seq = stats.captured++;
+  for (int i = 0; i < BROADCAST_SLOTS; i++) {
+    broadcast_sub_t *sub = &subs[i];
+    if (!sub->used) {
+      continue;
+    }
+    // 최신 프레임 우선: 보내지 못한 이전 프레임은 이 구독자에서만 버린다.
+    if (sub->pending) {
+      frame_unref_locked(sub->pending);
+      sub->dropped++;
+      stats.dropped++;
+    }
+    f->refs++;
+    sub->pending = f;
+    xSemaphoreGive(sub->ready);
+  }
+  frame_unref_locked(f);  // 캡처 태스크의 참조
+  xSemaphoreGive(lock);
+}
+
+// 클라이언트가 없으면 기록용 구독자들이 요청한 가장 짧은 프레임 간격, 있으면 0
+static int64_t recorder_gap_us(void) {
+  int64_t gap = 0;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (stats.subscribers == stats.recorders) {
+    gap = INT64_MAX;
+    for (int i = BROADCAST_MAX_SUBS; i < BROADCAST_SLOTS; i++) {
+      if (subs[i].used) {
+        gap = min(gap, subs[i].interval_us);
+      }
+    }
+  }
+  xSemaphoreGive(lock);
+  return gap == INT64_MAX ? 0 : gap;
+}
+
+static void broadcast_task(void *arg) {
+  int64_t last_publish = 0;  // 0: 구독자가 없어 쉬다 깨어남 (간격을 재지 않음)
+  int64_t last_capture = 0;
+  size_t last_jpg_len = 0;   // 직전에 변환한 JPEG 크기 (변환 버퍼 크기를 고르는 데 씀)
+  for (;;) {
+    if (stats.subscribers == 0) {
+      xSemaphoreTake(wake, portMAX_DELAY);
+      last_publish = 0;
+      continue;
+    }
+    // 기록용 구독자만 있으면 간격을 채울 때까지 잔다. 클라이언트가 구독하면 wake 로 곧바로 깬다.
+    int64_t wait_us = last_capture + recorder_gap_us() - esp_timer_get_time();
+    if (wait_us > 0) {
+      xSemaphoreTake(wake, pdMS_TO_TICKS(wait_us / 1000) + 1);
+      continue;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    last_capture = t0;
+    camera_fb_t *fb = esp_camera_fb_get();
+    trace_span("fb_get", t0, fb ? fb->len : 0);
+    metrics_observe(METRIC_CAPTURE_WAIT, esp_timer_get_time() - t0);
+    if (!fb) {
+      log_e("Camera capture failed");
+      stats.capture_failed++;
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+    if (broadcast_frame_stale(&fb->timestamp)) {
+      esp_camera_fb_return(fb);
+      stats.stale++;
+      continue;
+    }
+
+    broadcast_frame_t *f = frame_acquire();
+    bool ok = f != NULL;
+    if (ok && fb->format == PIXFORMAT_JPEG) {
+      ok = frame_reserve(f, fb->len);
+      if (ok) {
+        memcpy(f->copy_buf, fb->buf, fb->len);
+        f->buf = f->copy_buf;
+        f->len = fb->len;
+      }
+    } else if (ok) {
+      // JPEG 가 아닌 포맷은 클라이언트마다가 아니라 여기서 한 번만, 풀에서 빌린 버퍼에 변환한다.
+      t0 = esp_timer_get_time();
+      f->conv = conv_pool_jpeg(fb, 80, last_jpg_len);
+      ok = f->conv != NULL;
+      if (ok) {
+        f->buf = f->conv->data;
+        f->len = last_jpg_len = f->conv->len;
+      } else {
+        log_e("JPEG compression failed");
+      }
+      trace_span("frame2jpg", t0, ok ? f->len : 0);
+    }
+    if (ok) {
+      f->width = fb->width;
+      f->height = fb->height;
+      f->timestamp = fb->timestamp;
+    }
+    // 복사가 끝났으니 카메라 버퍼는 곧바로 돌려준다 (/capture 가 굶지 않도록).
+    esp_camera_fb_return(fb);
+
+    if (!ok) {
+      if (f) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        frame_unref_locked(f);
+        xSemaphoreGive(lock);
+      }
+      stats.alloc_failed++;
+      continue;
+    }
+    metrics_observe(METRIC_JPEG_SIZE, f->len);
+    publish(f);
+    int64_t now = esp_timer_get_time();
+    if (last_publish) {
+      metrics_observe(METRIC_FRAME_INTERVAL, now - last_publish);
+    }
+    last_publish = now;
+  }
+}
+
+esp_err_t broadcast_init(BaseType_t core_id) {
+  if (lock) {
+    return ESP_OK;
+  }
+  lock = xSemaphoreCreateMutex();
+  wake = xSemaphoreCreateBinary();
+  settings_lock = xSemaphoreCreateMutex();
+  if (!lock || !wake || !settings_lock) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (xTaskCreatePinnedToCore(broadcast_task, "broadcast", 4096, NULL, 5, NULL, core_id) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+static broadcast_sub_t *subscribe(bool recorder, uint32_t interval_ms) {
+  broadcast_sub_t *sub = NULL;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  int lo = recorder ? BROADCAST_MAX_SUBS : 0;
+  int hi = recorder ? BROADCAST_SLOTS : BROADCAST_MAX_SUBS;
+  for (int i = lo; i < hi; i++) {
+    if (!subs[i].used) {
+      sub = &subs[i];
+      break;
+    }
+  }
+  if (sub) {
+    if (!sub->ready) {
+      sub->ready = xSemaphoreCreateBinary();
+    }
+    sub->pending = NULL;
+    sub->dropped = 0;
+    sub->used = true;
+    sub->recorder = recorder;
+    sub->interval_us = interval_ms * 1000LL;
+    stats.recorders += recorder;
+    // 쉬고 있거나 기록용 간격으로 자고 있는 캡처 태스크를 깨운다 (깬 태스크가 간격을 다시 계산한다)
+    stats.subscribers++;
+    xSemaphoreGive(wake);
+  }
+  xSemaphoreGive(lock);
+  return sub;
+}
+
+broadcast_sub_t *broadcast_subscribe(void) {
+  return subscribe(false, 0);
+}
+
+broadcast_sub_t *broadcast_subscribe_recorder(uint32_t interval_ms) {
+  return subscribe(true, interval_ms);
+}
+
+void broadcast_recorder_interval(broadcast_sub_t *sub, uint32_t interval_ms) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool shorter = interval_ms * 1000LL < sub->interval_us;
+  sub->interval_us = interval_ms * 1000LL;
+  if (shorter) {
+    xSemaphoreGive(wake);
+  }
+  xSemaphoreGive(lock);
+}
+
+void broadcast_unsubscribe(broadcast_sub_t *sub) {
+  if (!sub) {
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  frame_unref_locked(sub->pending);
+  sub->pending = NULL;
+  sub->used = false;
+  // 다음 구독자가 지난 신호를 받지 않도록 비운다.
+  xSemaphoreTake(sub->ready, 0);
+  stats.subscribers--;
+  stats.recorders -= sub->recorder;
+  xSemaphoreGive(lock);
+}
+
+broadcast_frame_t *broadcast_wait_frame(broadcast_sub_t *sub, TickType_t timeout) {
+  broadcast_frame_t *f = NULL;
+  int64_t deadline = esp_timer_get_time() + (int64_t)timeout * portTICK_PERIOD_MS * 1000;
+  while (!f) {
+    int64_t left_us = deadline - esp_timer_get_time();
+    if (left_us < 0 || xSemaphoreTake(sub->ready, pdMS_TO_TICKS(left_us / 1000)) != pdTRUE) {
+      return NULL;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    f = sub->pending;
+    sub->pending = NULL;
+    xSemaphoreGive(lock);
+  }
+  return f;
+}
+
+void broadcast_release(broadcast_frame_t *frame) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  frame_unref_locked(frame);
+  xSemaphoreGive(lock);
+}
+
+uint32_t broadcast_dropped(broadcast_sub_t *sub) {
+  return sub->dropped;
+}
+
+void broadcast_get_stats(broadcast_stats_t *out) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  *out = stats;
+  xSemaphoreGive(lock);
+}
+
+void broadcast_settings_begin(void) {
+  if (settings_lock) {
+    xSemaphoreTake(settings_lock, portMAX_DELAY);
+  }
+}
+
+void broadcast_settings_end(void) {
+  if (settings_lock) {
+    settings_us = esp_timer_get_time();
+    settle_pending = true;
+    xSemaphoreGive(settings_lock);
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.settle_us = -1;
+    xSemaphoreGive(lock);
+  }
+}
+
+bool broadcast_frame_stale(const struct timeval *timestamp) {
+  if (!settings_lock) {
+    return false;
+  }
+  int64_t t = timestamp->tv_sec * 1000000LL + timestamp->tv_usec;
+  xSemaphoreTake(settings_lock, portMAX_DELAY);
+  bool stale = t < settings_us;
+  xSemaphoreGive(settings_lock);
+  return stale;
+}
@@ -0,0 +1,80 @@
+// 여러 /stream 클라이언트가 한 번의 캡처를 나눠 쓰도록 하는 프레임 브로드캐스터
+//
+// 캡처 태스크 하나만 esp_camera_fb_get() 을 호출하고, 받은 프레임을 참조 카운트가 있는 버퍼에
+// 복사해 카메라 버퍼를 곧바로 돌려준다. 각 구독자는 "가장 최근 프레임" 하나만 대기시키며,
+// 보내는 동안 새 프레임이 오면 이전 대기 프레임은 그 구독자에서만 버려진다.
+// 따라서 클라이언트 N 명의 비용은 캡처 1 번 + 전송 N 번이다.
+//
+// 기록용 구독자(event_clip, frame_analysis, burst)는 클라이언트와 별도의 자리를 쓰므로 클라이언트 상한을
+// 줄이지 않는다. 클라이언트 없이 기록용 구독자만 있으면 그들이 요청한 간격 중 가장 짧은 간격으로만
+// 캡처하고 복사한다. 센서와 DMA 는 계속 돌지만 프레임마다 복사하고 깨어나는 비용은 줄어든다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// 동시에 구독할 수 있는 최대 클라이언트 수 (스트림 서버의 세션 수. lwIP 소켓 예산은 app_httpd.cpp 참고)
+#define BROADCAST_MAX_SUBS 7
+// 클라이언트와 따로 두는 기록용 구독자 자리 수
+#define BROADCAST_MAX_RECORDERS 3
+
+typedef struct {
+  uint8_t *buf;              // JPEG 데이터
+  size_t len;                // JPEG 길이
+  size_t width;
+  size_t height;
+  struct timeval timestamp;  // 원본 프레임 버퍼의 캡처 시각
+  uint32_t seq;              // 발행 순번
+  // 아래는 브로드캐스터 내부용
+  uint8_t *copy_buf;         // JPEG 프레임을 복사해 두는 슬롯 고유 버퍼
+  size_t cap;
+  struct conv_buf *conv;     // 변환한 프레임이면 변환 버퍼 풀에서 빌린 버퍼 (마지막 참조가 풀리면 돌려줌)
+  int refs;
+} broadcast_frame_t;
+
+typedef struct broadcast_sub broadcast_sub_t;
+
+typedef struct {
+  uint32_t captured;    // 발행한 프레임 수
+  uint32_t capture_failed;
+  uint32_t alloc_failed;
+  uint32_t subscribers; // 현재 구독자 수 (recorders 포함)
+  uint32_t recorders;   // 그중 클라이언트가 아닌 기록용 구독자 수
+  uint32_t stale;       // 설정 묶음 적용 전/도중에 찍혀 버린 프레임 수
+  uint32_t dropped;     // 구독자가 받기 전에 더 새 프레임으로 대체된 수 (모든 구독자 합)
+  int64_t settle_us;    // 마지막 설정 묶음 적용이 끝나고 첫 프레임을 발행하기까지 (-1: 적용 뒤 아직 발행 전)
+} broadcast_stats_t;
+
+// 캡처 태스크를 core_id 코어에 만든다. 구독자가 없으면 태스크는 카메라를 건드리지 않고 잠든다.
+esp_err_t broadcast_init(BaseType_t core_id);
+
+// 구독자를 추가한다. 최대 구독자 수를 넘으면 NULL.
+broadcast_sub_t *broadcast_subscribe(void);
+// 클라이언트가 아닌 기록용 구독자를 추가한다. BROADCAST_MAX_RECORDERS 개의 별도 자리를 쓰며 자리가
+// 없으면 NULL. interval_ms 는 클라이언트가 없을 때 이 구독자가 필요한 프레임 간격이다 (0: 모든 프레임).
+broadcast_sub_t *broadcast_subscribe_recorder(uint32_t interval_ms);
+// 기록용 구독자의 프레임 간격을 바꾼다.
+void broadcast_recorder_interval(broadcast_sub_t *sub, uint32_t interval_ms);
+void broadcast_unsubscribe(broadcast_sub_t *sub);
+
+// 이 구독자가 아직 받지 않은 가장 최근 프레임을 기다린다. 시간 초과면 NULL.
+// 받은 프레임은 반드시 broadcast_release() 로 돌려준다.
+broadcast_frame_t *broadcast_wait_frame(broadcast_sub_t *sub, TickType_t timeout);
+void broadcast_release(broadcast_frame_t *frame);
+
+// 구독자가 받지 못하고 버려진(더 새 프레임으로 대체된) 프레임 수
+uint32_t broadcast_dropped(broadcast_sub_t *sub);
+
+void broadcast_get_stats(broadcast_stats_t *stats);
+
+// 센서 설정 여러 개를 한 번에 바꿀 때 그 앞뒤로 부른다 (/control 일괄 설정).
+// 적용이 끝난 뒤에 찍힌 프레임만 발행하므로, 설정이 절반만 바뀐 프레임은 스트림에 나가지 않는다.
+void broadcast_settings_begin(void);
+void broadcast_settings_end(void);
+
+// timestamp 의 프레임이 마지막 설정 묶음 적용 전이나 도중에 찍혔으면 true.
+// 적용 중이면 끝날 때까지 기다린다. esp_camera_fb_get() 을 직접 부르는 핸들러도 쓴다.
+bool broadcast_frame_stale(const struct timeval *timestamp);
@@ -0,0 +1,268 @@
+// 성능 지표 구현 (metrics.h 참고)
+#include "metrics.h"
+#include "frame_broadcaster.h"
+#include "flame_sensor.h"
+#include "conv_pool.h"
+#include "capture_cache.h"
+#include "frame_analysis.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+
+#define METRICS_CHUNK 768  // 한 번에 write 로 넘기는 텍스트 크기
+
+typedef struct {
+  uint32_t base;   // 첫 버킷 상한 (관측값 단위)
+  std::atomic<uint32_t> buckets[METRICS_BUCKETS + 1];  // 마지막은 +Inf (누적이 아닌 구간별 개수)
+  std::atomic<uint64_t> sum;
+} metrics_hist_t;
+
+typedef struct {
+  const char *name;
+  const char *help;
+  bool seconds;    // true: 관측값은 us, 초로 내보냄 / false: 그대로
+} metrics_hist_info_t;
+
+static const metrics_hist_info_t hist_info[METRIC_HIST_COUNT] = {
+  {"camera_frame_interval_seconds", "Interval between frames published to stream clients.", true},
+  {"camera_capture_wait_seconds", "Time blocked in esp_camera_fb_get().", true},
+  {"camera_frame_send_seconds", "Time to send one frame to a /stream or /ws client.", true},
+  {"camera_jpeg_bytes", "Size of published or captured JPEG frames.", false},
+  {"fire_analysis_seconds", "Time to decode one frame at 1/8 scale and run the fire color kernel.", true},
+};
+
+static metrics_hist_t hists[METRIC_HIST_COUNT] = {
+  {1000},  // 1ms ~ 33s
+  {100},   // 0.1ms ~ 3.3s
+  {100},
+  {1024},  // 1KB ~ 32MB
+  {100},
+};
+
+static const char *const counter_info[METRIC_COUNTER_COUNT][2] = {
+  {"camera_frames_sent_total", "Frames sent to /stream and /ws clients."},
+  {"camera_send_failures_total", "Failed frame or response sends."},
+  {"camera_frames_thinned_total", "Frames not sent to /stream and /ws clients because the scene was unchanged."},
+};
+static std::atomic<uint32_t> counters[METRIC_COUNTER_COUNT];
+
+typedef struct {
+  const char *path;
+  const char *method;
+  metrics_hist_t latency;
+} metrics_endpoint_t;
+
+static metrics_endpoint_t endpoints[METRICS_ENDPOINTS];
+static std::atomic<int> endpoint_count(0);
+
+static void hist_observe(metrics_hist_t *h, uint32_t value) {
+  // 상한이 value 이상인 첫 버킷: value <= base * 2^i
+  uint32_t q = value ? (value - 1) / h->base : 0;
+  int i = q ? 32 - __builtin_clz(q) : 0;
+  h->buckets[min(i, METRICS_BUCKETS)].fetch_add(1, std::memory_order_relaxed);
+  h->sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void metrics_observe(metrics_hist_id_t id, uint32_t value) {
+  hist_observe(&hists[id], value);
+}
+
+void metrics_add(metrics_counter_id_t id, uint32_t n) {
+  counters[id].fetch_add(n, std::memory_order_relaxed);
+}
+
+int metrics_endpoint_register(const char *path, const char *method) {
+  int i = endpoint_count.load();
+  if (i >= METRICS_ENDPOINTS) {
+    return -1;
+  }
+  endpoints[i].path = path;
+  endpoints[i].method = method;
+  endpoints[i].latency.base = 100;  // 0.1ms ~ 3.3s
+  endpoint_count.store(i + 1, std::memory_order_release);
+  return i;
+}
+
+void metrics_endpoint_observe(int endpoint, uint32_t us) {
+  if (endpoint >= 0) {
+    hist_observe(&endpoints[endpoint].latency, us);
+  }
+}
+
+// ===========================
+// Prometheus 텍스트 출력
+// ===========================
+typedef struct {
+  metrics_write_cb_t write;
+  void *arg;
+  esp_err_t err;
+  size_t len;
+  char buf[METRICS_CHUNK];
+} metrics_out_t;
+
+static void out_flush(metrics_out_t *o) {
+  if (o->err == ESP_OK && o->len) {
+    o->err = o->write(o->arg, o->buf, o->len);
+  }
+  o->len = 0;
+}
+
+static void out_printf(metrics_out_t *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void out_printf(metrics_out_t *o, const char *fmt, ...) {
+  if (o->len > sizeof(o->buf) - 160) {
+    out_flush(o);  // 한 줄은 160 자를 넘지 않는다.
+  }
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(o->buf + o->len, sizeof(o->buf) - o->len, fmt, ap);
+  va_end(ap);
+  o->len = min(o->len + (size_t)max(n, 0), sizeof(o->buf) - 1);
+}
+
+// us 를 소수점 6 자리 초로 (부동소수점 없이)
+static void out_fixed(char *s, size_t cap, uint64_t us) {
+  snprintf(s, cap, "%llu.%06u", (unsigned long long)(us / 1000000), (unsigned)(us % 1000000));
+}
+
+static void out_header(metrics_out_t *o, const char *name, const char *type, const char *help) {
+  out_printf(o, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// labels 는 비어 있거나 `path="/x",` 처럼 끝에 쉼표를 붙인 형태
+static void out_hist(metrics_out_t *o, const char *name, const char *labels, metrics_hist_t *h, bool seconds) {
+  uint32_t cumulative = 0;
+  char le[24];
+  for (int i = 0; i <= METRICS_BUCKETS; i++) {
+    cumulative += h->buckets[i].load(std::memory_order_relaxed);
+    if (i == METRICS_BUCKETS) {
+      snprintf(le, sizeof(le), "+Inf");
+    } else if (seconds) {
+      out_fixed(le, sizeof(le), (uint64_t)h->base << i);
+    } else {
+      snprintf(le, sizeof(le), "%llu", (unsigned long long)h->base << i);
+    }
+    out_printf(o, "%s_bucket{%sle=\"%s\"} %lu\n", name, labels, le, (unsigned long)cumulative);
+  }
+  uint64_t sum = h->sum.load(std::memory_order_relaxed);
+  char s[24];
+  if (seconds) {
+    out_fixed(s, sizeof(s), sum);
+  } else {
+    snprintf(s, sizeof(s), "%llu", (unsigned long long)sum);
+  }
+  // count 는 버킷을 더한 값을 써서 읽는 사이에 관측이 들어와도 +Inf 버킷과 어긋나지 않게 한다.
+  const char *braces = *labels ? "{" : "";
+  int label_len = *labels ? (int)strlen(labels) - 1 : 0;  // 끝 쉼표 제외
+  out_printf(o, "%s_sum%s%.*s%s %s\n", name, braces, label_len, labels, *labels ? "}" : "", s);
+  out_printf(o, "%s_count%s%.*s%s %lu\n", name, braces, label_len, labels, *labels ? "}" : "", (unsigned long)cumulative);
+}
+
+static void out_value(metrics_out_t *o, const char *name, const char *type, const char *help, unsigned long value) {
+  out_header(o, name, type, help);
+  out_printf(o, "%s %lu\n", name, value);
+}
+
+esp_err_t metrics_write(metrics_write_cb_t write, void *arg) {
+  metrics_out_t *o = (metrics_out_t *)malloc(sizeof(metrics_out_t));  // httpd 스택을 아끼려고 힙에 둔다.
+  if (!o) {
+    return ESP_ERR_NO_MEM;
+  }
+  o->write = write;
+  o->arg = arg;
+  o->err = ESP_OK;
+  o->len = 0;
+
+  for (int i = 0; i < METRIC_HIST_COUNT; i++) {
+    out_header(o, hist_info[i].name, "histogram", hist_info[i].help);
+    out_hist(o, hist_info[i].name, "", &hists[i], hist_info[i].seconds);
+  }
+  for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+    out_value(o, counter_info[i][0], "counter", counter_info[i][1], counters[i].load(std::memory_order_relaxed));
+  }
+
+  const char *req_name = "http_request_duration_seconds";
+  out_header(o, req_name, "histogram", "Handler time per HTTP endpoint (streams excluded).");
+  int n = endpoint_count.load(std::memory_order_acquire);
+  for (int i = 0; i < n; i++) {
+    char labels[64];
+    snprintf(labels, sizeof(labels), "path=\"%s\",method=\"%s\",", endpoints[i].path, endpoints[i].method);
+    out_hist(o, req_name, labels, &endpoints[i].latency, true);
+  }
+
+  broadcast_stats_t bs;
+  broadcast_get_stats(&bs);
+  out_value(o, "camera_frames_captured_total", "counter", "Frames published by the broadcaster.", bs.captured);
+  out_header(o, "camera_frames_dropped_total", "counter", "Frames not delivered, by reason.");
+  out_printf(o, "camera_frames_dropped_total{reason=\"slow_client\"} %lu\n", (unsigned long)bs.dropped);
+  out_printf(o, "camera_frames_dropped_total{reason=\"stale\"} %lu\n", (unsigned long)bs.stale);
+  out_printf(o, "camera_frames_dropped_total{reason=\"capture_failed\"} %lu\n", (unsigned long)bs.capture_failed);
+  out_printf(o, "camera_frames_dropped_total{reason=\"alloc_failed\"} %lu\n", (unsigned long)bs.alloc_failed);
+  out_value(o, "camera_stream_clients", "gauge", "Current /stream and /ws subscribers.", bs.subscribers - bs.recorders);
+
+  capture_cache_stats_t cs;
+  capture_cache_get_stats(&cs);
+  out_header(o, "capture_requests_total", "counter", "/capture requests by how the frame was obtained.");
+  out_printf(o, "capture_requests_total{result=\"captured\"} %lu\n", (unsigned long)cs.captures);
+  out_printf(o, "capture_requests_total{result=\"cache_hit\"} %lu\n", (unsigned long)cs.cache_hits);
+  out_printf(o, "capture_requests_total{result=\"coalesced\"} %lu\n", (unsigned long)cs.coalesced);
+  out_printf(o, "capture_requests_total{result=\"failed\"} %lu\n", (unsigned long)cs.failed);
+  out_value(o, "capture_not_modified_total", "counter", "/capture requests answered with 304.", cs.not_modified);
+
+  analysis_stats_t as;
+  analysis_get_stats(&as);
+  out_value(o, "fire_analysis_frames_total", "counter", "Frames run through the on-device fire prefilter.", as.frames);
+  out_value(o, "fire_analysis_overruns_total", "counter", "Analyzed frames over the per-frame time budget.", as.overruns);
+  out_value(o, "fire_analysis_failures_total", "counter", "Frames the prefilter could not decode.", as.decode_failed);
+  out_value(o, "scene_motion_updates_total", "counter", "Background updates that found the scene changed.",
+            as.motion_frames);
+  out_value(o, "fire_flicker_events_total", "counter", "Times a candidate region started flickering at 1-15 Hz.",
+            as.flicker_events);
+  analysis_result_t ar;
+  analysis_get(&ar);
+  out_header(o, "fire_flicker_depth", "gauge", "Flicker amplitude in the candidate region relative to its mean luma.");
+  out_printf(o, "fire_flicker_depth %.4f\n", ar.flicker.depth);
+
+  flame_stats_t fs;
+  flame_sensor_get_stats(&fs);
+  out_value(o, "flame_edges_total", "counter", "Debounced flame sensor edges.", fs.edges);
+  out_value(o, "flame_bounces_total", "counter", "Flame sensor interrupts rejected by debounce.", fs.bounces);
+
+  out_header(o, "heap_free_bytes", "gauge", "Free heap by region.");
+  out_printf(o, "heap_free_bytes{region=\"internal\"} %lu\n",
+             (unsigned long)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  out_printf(o, "heap_free_bytes{region=\"psram\"} %lu\n", (unsigned long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+  out_header(o, "heap_largest_free_block_bytes", "gauge", "Largest allocatable block by region.");
+  out_printf(o, "heap_largest_free_block_bytes{region=\"internal\"} %lu\n",
+             (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  out_printf(o, "heap_largest_free_block_bytes{region=\"psram\"} %lu\n",
+             (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+  conv_pool_stats_t ps;
+  conv_pool_get_stats(&ps);
+  static const char *const pool_info[][3] = {
+    {"conv_pool_buffers", "gauge", "Preallocated conversion buffers per size class."},
+    {"conv_pool_in_use", "gauge", "Conversion buffers currently lent out."},
+    {"conv_pool_high_water", "gauge", "Most conversion buffers lent out at once."},
+    {"conv_pool_hits_total", "counter", "Conversions served from this size class."},
+    {"conv_pool_misses_total", "counter", "Requests that best fit this class but found it fully lent out."},
+  };
+  for (int m = 0; m < 5; m++) {
+    out_header(o, pool_info[m][0], pool_info[m][1], pool_info[m][2]);
+    for (int c = 0; c < CONV_POOL_CLASSES; c++) {
+      const conv_pool_class_stats_t *cs = &ps.classes[c];
+      uint32_t v = m == 0 ? cs->count : m == 1 ? cs->in_use : m == 2 ? cs->high_water : m == 3 ? cs->hits : cs->misses;
+      out_printf(o, "%s{size=\"%lu\"} %lu\n", pool_info[m][0], (unsigned long)cs->size, (unsigned long)v);
+    }
+  }
+  out_value(o, "conv_pool_heap_fallbacks_total", "counter", "Conversions that fell back to a heap allocation.",
+            ps.heap_fallbacks);
+  out_value(o, "conv_pool_retries_total", "counter", "JPEG encodes redone in a larger buffer after overflow.",
+            ps.retries);
+  out_value(o, "uptime_seconds", "gauge", "Seconds since boot.", (unsigned long)(esp_timer_get_time() / 1000000));
+
+  out_flush(o);
+  esp_err_t err = o->err;
+  free(o);
+  return err;
+}
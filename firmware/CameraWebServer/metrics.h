@@ -0,0 +1,42 @@
+// 성능 지표 (/metrics)
+//
+// 프레임 경로와 HTTP 요청의 시간/크기를 로그 버킷 히스토그램과 카운터로 항상 모은다.
+// 값은 정수(us, 바이트)로 받아 원자적으로 더하므로 어느 태스크에서나 잠금 없이 기록할 수 있다.
+// 버킷 i 의 상한은 base * 2^i 이고 METRICS_BUCKETS 개를 넘는 값은 +Inf 버킷에만 들어간다.
+//
+// /metrics 는 이 값과 브로드캐스터 통계, 힙 여유를 Prometheus 텍스트 형식으로 내보낸다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define METRICS_BUCKETS   16
+#define METRICS_ENDPOINTS 32  // 지연을 따로 모으는 HTTP 엔드포인트 수
+
+typedef enum {
+  METRIC_FRAME_INTERVAL,  // 브로드캐스터가 발행한 프레임 사이 간격 (us)
+  METRIC_CAPTURE_WAIT,    // esp_camera_fb_get() 대기 (us)
+  METRIC_FRAME_SEND,      // /stream, /ws 프레임 하나 전송 (us)
+  METRIC_JPEG_SIZE,       // 발행하거나 /capture 로 보낸 JPEG 크기 (바이트)
+  METRIC_ANALYSIS_TIME,   // 프레임 하나의 1/8 디코드와 분석 (us)
+  METRIC_HIST_COUNT
+} metrics_hist_id_t;
+
+typedef enum {
+  METRIC_FRAMES_SENT,     // /stream, /ws 로 보낸 프레임
+  METRIC_SEND_FAILED,     // 전송 실패 (연결 끊김 포함)
+  METRIC_FRAMES_THINNED,  // 장면이 그대로라 /stream, /ws 로 보내지 않은 프레임
+  METRIC_COUNTER_COUNT
+} metrics_counter_id_t;
+
+void metrics_observe(metrics_hist_id_t id, uint32_t value);
+void metrics_add(metrics_counter_id_t id, uint32_t n);
+
+// 엔드포인트를 등록하고 번호를 돌려준다 (-1: 자리가 없음). path, method 는 문자열 상수여야 한다.
+int metrics_endpoint_register(const char *path, const char *method);
+void metrics_endpoint_observe(int endpoint, uint32_t us);
+
+// Prometheus 텍스트를 조각으로 나눠 write 에 넘긴다. write 가 실패하면 그 값을 돌려준다.
+typedef esp_err_t (*metrics_write_cb_t)(void *arg, const char *data, size_t len);
+esp_err_t metrics_write(metrics_write_cb_t write, void *arg);
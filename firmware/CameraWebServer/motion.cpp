@@ -0,0 +1,55 @@
+// 배경 모델과 움직임 마스크 구현 (motion.h 참고)
+#include "motion.h"
+#include "fire_kernels.h"
+#include <Arduino.h>
+
+static uint16_t *bg = NULL;  // 배경 밝기 (8.8 고정소수점), 행 순서
+static size_t bg_cap;        // 화소 수
+static int bg_w, bg_h;
+static bool fresh;           // 다음 프레임으로 배경을 채운다
+
+esp_err_t motion_reset(int width, int height) {
+  size_t n = (size_t)width * height;
+  if (n > bg_cap) {
+    free(bg);
+    bg = (uint16_t *)(psramFound() ? ps_malloc(n * 2) : malloc(n * 2));
+    bg_cap = bg ? n : 0;
+    if (!bg) {
+      bg_w = bg_h = 0;
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  bg_w = width;
+  bg_h = height;
+  fresh = true;
+  return ESP_OK;
+}
+
+void motion_update(const uint8_t *rgb565, uint8_t *fg, motion_result_t *out) {
+  size_t n = (size_t)bg_w * bg_h;
+  out->fg_pixels = 0;
+  out->changed = false;
+  if (fresh) {
+    for (size_t i = 0; i < n; i++) {
+      bg[i] = rgb565_luma(rgb565 + i * 2) << 8;
+    }
+    if (fg) {
+      memset(fg, 0, n);
+    }
+    fresh = false;
+    return;
+  }
+  const int thr = MOTION_THRESHOLD << 8;
+  uint32_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    int d = (rgb565_luma(rgb565 + i * 2) << 8) - bg[i];
+    uint32_t f = d > thr || d < -thr;
+    bg[i] += d >> (f ? MOTION_SHIFT + 2 : MOTION_SHIFT);
+    count += f;
+    if (fg) {
+      fg[i] = f;
+    }
+  }
+  out->fg_pixels = count;
+  out->changed = count >= max((size_t)MOTION_MIN_PIXELS, n / 200);
+}
@@ -0,0 +1,31 @@
+// 배경 모델과 움직임 마스크
+//
+// frame_analysis 가 1/8 로 디코드한 영상의 밝기로 화소마다 지수 이동 평균 배경을 유지한다. 배경은
+// 화소당 uint16(8.8 고정소수점) 하나를 디코드 버퍼와 같은 행 순서로 이어 붙인 배열이라, 한 프레임을
+// 앞에서부터 한 번 훑으며 읽고 쓴다. 크기가 해상도에 따라 바뀌므로 PSRAM 에 두고 없으면 내부 RAM 에 둔다.
+//
+// 밝기가 배경과 MOTION_THRESHOLD 넘게 다른 화소를 전경으로 표시한다. 배경은 갱신마다 차이의
+// 1/2^MOTION_SHIFT 만큼 따라가고, 전경 화소는 그보다 4 배 느리게 따라가서 서 있는 불꽃이 곧바로
+// 배경에 묻히지 않는다. 조명이 바뀌면 온 화면이 전경이 되었다가 몇 초 안에 배경으로 들어간다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define MOTION_THRESHOLD  12   // 전경으로 볼 밝기 차이 (0~255)
+#define MOTION_SHIFT      5    // 배경 갱신 비율 1/32 (10Hz 갱신이면 시간 상수 약 3 초)
+#define MOTION_MIN_PIXELS 3    // 장면이 바뀌었다고 볼 최소 전경 화소 수 (전체의 0.5% 와 큰 쪽)
+
+typedef struct {
+  uint32_t fg_pixels;  // 전경 화소 수
+  bool changed;        // fg_pixels 가 문턱을 넘음
+} motion_result_t;
+
+// width x height 영상으로 배경을 새로 시작한다. 크기가 같으면 버퍼를 다시 쓴다.
+// 다음 motion_update() 의 영상이 그대로 배경이 된다.
+esp_err_t motion_reset(int width, int height);
+
+// RGB565(빅엔디언) 영상으로 배경을 갱신하고, fg 가 NULL 이 아니면 화소마다 1(전경)/0 을 쓴다.
+// motion_reset() 과 같은 크기여야 한다. 배경을 막 시작한 프레임은 전경이 없다.
+void motion_update(const uint8_t *rgb565, uint8_t *fg, motion_result_t *out);
@@ -0,0 +1,279 @@
+// 적응형 레이트 컨트롤러 구현 (rate_ctrl.h 참고)
+#include "rate_ctrl.h"
+#include "frame_broadcaster.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+#define RC_WINDOW_MS 1000      // 판단 구간
+#define RC_TARGET_FPS 20       // 기본 목표 fps
+#define RC_CONGESTED 80        // 프레임 간격의 80% 이상을 전송에 쓰면 혼잡
+#define RC_SEVERE 200          // 두 배 이상이면 화질보다 해상도를 먼저 내림
+#define RC_CLEAR 40            // 40% 미만이면 여유
+#define RC_CLEAR_FRAMESIZE 25  // 해상도를 올리려면 25% 미만이어야 함 (프레임 크기가 약 두 배가 됨)
+#define RC_UP_WINDOWS 3        // 여유 구간이 이만큼 이어져야 화질을 올림
+#define RC_QUALITY_WORST 40    // quality 값의 상한 (0~63, 클수록 화질이 낮음)
+#define RC_QUALITY_DOWN 6      // 혼잡할 때 quality 를 올리는 폭
+#define RC_QUALITY_UP 3        // 여유가 있을 때 quality 를 내리는 폭
+#define RC_MAX_CLIENTS BROADCAST_MAX_SUBS
+
+// 해상도 조절 단계 (가로세로 비율이 크게 다르지 않은 것만)
+static const framesize_t ladder[] = {
+  FRAMESIZE_QQVGA, FRAMESIZE_HQVGA, FRAMESIZE_QVGA, FRAMESIZE_HVGA, FRAMESIZE_VGA,
+  FRAMESIZE_SVGA, FRAMESIZE_XGA, FRAMESIZE_HD, FRAMESIZE_SXGA, FRAMESIZE_UXGA,
+};
+#define LADDER_LEN (sizeof(ladder) / sizeof(ladder[0]))
+
+static SemaphoreHandle_t lock = NULL;
+static rate_ctrl_state_t state;
+
+// 현재 구간의 클라이언트별 누적값
+typedef struct {
+  const void *client;  // rate_ctrl_report() 의 client (NULL: 빈 자리)
+  int64_t send_us;
+  uint64_t bytes;
+  uint32_t frames;
+} rc_window_t;
+
+static int64_t window_start;
+static rc_window_t windows[RC_MAX_CLIENTS];
+static int clear_windows;
+static bool skip_window;  // 설정을 바꾼 직후 구간은 이전 설정의 프레임이 섞이므로 건너뜀
+
+static framesize_t ladder_step(framesize_t fs, int dir) {
+  if (dir < 0) {
+    for (int i = LADDER_LEN - 1; i >= 0; i--) {
+      if (ladder[i] < fs) {
+        return ladder[i];
+      }
+    }
+  } else {
+    for (size_t i = 0; i < LADDER_LEN; i++) {
+      if (ladder[i] > fs) {
+        return ladder[i];
+      }
+    }
+  }
+  return fs;
+}
+
+// 목표 설정을 바꾼다. 센서에는 sensor_sync_locked() 가 옮긴다. 바뀐 것이 있으면 true.
+static bool apply_locked(framesize_t fs, int quality) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s || s->pixformat != PIXFORMAT_JPEG || (fs == state.framesize && quality == state.quality)) {
+    return false;
+  }
+  state.framesize = fs;
+  state.quality = quality;
+  state.adjustments++;
+  skip_window = true;
+  clear_windows = 0;
+  return true;
+}
+
+// 센서 설정을 state 에 맞춘다. 호출하는 쪽이 브로드캐스터 설정 펜스를 잡고 있어야 한다.
+static void sensor_sync_locked(void) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s || s->pixformat != PIXFORMAT_JPEG) {
+    return;
+  }
+  if (!state.framesize_locked && s->status.framesize != state.framesize) {
+    s->set_framesize(s, state.framesize);
+  }
+  if (s->status.quality != state.quality) {
+    s->set_quality(s, state.quality);
+  }
+}
+
+// 스트림 태스크에서 설정을 바꾼다. /control 처럼 펜스를 먼저 잡고 lock 을 잡으므로 교착이 없고,
+// 바뀌는 도중에 찍힌 프레임은 브로드캐스터가 버린다.
+static void sensor_sync_fenced(void) {
+  broadcast_settings_begin();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  sensor_sync_locked();
+  xSemaphoreGive(lock);
+  broadcast_settings_end();
+}
+
+static void reset_window_locked(int64_t now) {
+  window_start = now;
+  for (int i = 0; i < RC_MAX_CLIENTS; i++) {
+    windows[i].send_us = 0;
+    windows[i].bytes = 0;
+    windows[i].frames = 0;
+  }
+}
+
+// 구간을 판단한다. 설정을 바꿨으면 true.
+static bool evaluate_locked(void) {
+  // 설정은 모든 스트림이 공유하므로 가장 막힌 클라이언트를 기준으로 한다.
+  int64_t budget_us = 1000000 / state.target_fps;
+  int busy = 0;  // 전송에 막힌 비율(%)
+  int kbps = 0;  // 목표 fps 에서 필요한 비트레이트
+  for (int i = 0; i < RC_MAX_CLIENTS; i++) {
+    const rc_window_t *w = &windows[i];
+    if (w->client && w->frames) {
+      busy = max(busy, (int)(w->send_us / w->frames * 100 / budget_us));
+      kbps = max(kbps, (int)(w->bytes / w->frames * 8 * state.target_fps / 1000));
+    }
+  }
+  bool over_rate = state.max_kbps > 0 && kbps > state.max_kbps;
+  bool under_rate = state.max_kbps == 0 || kbps < state.max_kbps * 7 / 10;
+
+  if (busy >= RC_CONGESTED || over_rate) {
+    framesize_t smaller = state.framesize_locked ? state.framesize : ladder_step(state.framesize, -1);
+    bool changed = false;
+    if (busy >= RC_SEVERE && smaller != state.framesize) {
+      // 화질을 몇 단계 내려서는 따라잡지 못하므로 프레임 크기를 먼저 절반쯤으로 줄인다.
+      changed = apply_locked(smaller, state.quality);
+    } else if (state.quality < RC_QUALITY_WORST) {
+      changed = apply_locked(state.framesize, min(state.quality + RC_QUALITY_DOWN, RC_QUALITY_WORST));
+    } else if (smaller != state.framesize) {
+      changed = apply_locked(smaller, (state.base_quality + RC_QUALITY_WORST) / 2);
+    }
+    if (changed) {
+      log_i("RC congested: busy %d%% %dkbps -> framesize %u quality %d", busy, kbps, state.framesize, state.quality);
+    }
+    return changed;
+  }
+
+  if (busy >= RC_CLEAR || !under_rate || ++clear_windows < RC_UP_WINDOWS) {
+    return false;
+  }
+  bool changed = false;
+  if (state.quality > state.base_quality) {
+    changed = apply_locked(state.framesize, max(state.quality - RC_QUALITY_UP, state.base_quality));
+  } else if (!state.framesize_locked && state.framesize < state.base_framesize && busy < RC_CLEAR_FRAMESIZE) {
+    changed = apply_locked(ladder_step(state.framesize, 1), (state.base_quality + RC_QUALITY_WORST) / 2);
+  }
+  if (changed) {
+    log_i("RC clear: busy %d%% %dkbps -> framesize %u quality %d", busy, kbps, state.framesize, state.quality);
+  }
+  return changed;
+}
+
+void rate_ctrl_init(void) {
+  if (!lock) {
+    lock = xSemaphoreCreateMutex();
+  }
+  sensor_t *s = esp_camera_sensor_get();
+  state.enabled = true;
+  state.target_fps = RC_TARGET_FPS;
+  state.max_kbps = 0;
+  state.base_framesize = state.framesize = s ? s->status.framesize : FRAMESIZE_QVGA;
+  state.base_quality = state.quality = s ? s->status.quality : 12;
+  reset_window_locked(esp_timer_get_time());
+}
+
+void rate_ctrl_set_base_framesize(framesize_t framesize) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.base_framesize = state.framesize = framesize;
+  state.framesize_locked = false;
+  clear_windows = 0;
+  skip_window = true;
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_set_base_quality(int quality) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.base_quality = state.quality = quality;
+  clear_windows = 0;
+  skip_window = true;
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_lock_framesize(bool locked) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.framesize_locked = locked;
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_set_enabled(bool enabled) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.enabled = enabled;
+  if (!enabled && apply_locked(state.base_framesize, state.base_quality)) {
+    sensor_sync_locked();  // /control 이 펜스를 잡은 채 부른다
+  }
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_set_target_fps(int fps) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.target_fps = constrain(fps, 1, 60);
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_set_max_kbps(int kbps) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  state.max_kbps = max(kbps, 0);
+  xSemaphoreGive(lock);
+}
+
+// client 의 구간 자리. 처음 보는 client 면 빈 자리를 준다 (없으면 NULL).
+static rc_window_t *window_find_locked(const void *client) {
+  rc_window_t *empty = NULL;
+  for (int i = 0; i < RC_MAX_CLIENTS; i++) {
+    if (windows[i].client == client) {
+      return &windows[i];
+    }
+    if (!windows[i].client && !empty) {
+      empty = &windows[i];
+    }
+  }
+  if (empty) {
+    empty->client = client;
+  }
+  return empty;
+}
+
+void rate_ctrl_report(const void *client, int64_t send_us, size_t jpg_len) {
+  bool changed = false;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  rc_window_t *w = state.enabled ? window_find_locked(client) : NULL;
+  if (w) {
+    w->send_us += send_us;
+    w->bytes += jpg_len;
+    w->frames++;
+    int64_t now = esp_timer_get_time();
+    if (now - window_start >= RC_WINDOW_MS * 1000) {
+      if (skip_window) {
+        skip_window = false;
+      } else {
+        changed = evaluate_locked();
+      }
+      reset_window_locked(now);
+    }
+  }
+  xSemaphoreGive(lock);
+  if (changed) {
+    sensor_sync_fenced();
+  }
+}
+
+void rate_ctrl_forget(const void *client) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (int i = 0; i < RC_MAX_CLIENTS; i++) {
+    if (windows[i].client == client) {
+      windows[i] = {};
+    }
+  }
+  xSemaphoreGive(lock);
+}
+
+void rate_ctrl_idle(void) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool changed = apply_locked(state.base_framesize, state.base_quality);
+  reset_window_locked(esp_timer_get_time());
+  clear_windows = 0;
+  xSemaphoreGive(lock);
+  if (changed) {
+    sensor_sync_fenced();
+  }
+}
+
+void rate_ctrl_get(rate_ctrl_state_t *out) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  *out = state;
+  xSemaphoreGive(lock);
+}
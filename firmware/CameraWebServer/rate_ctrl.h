@@ -0,0 +1,56 @@
+// 스트림 전송 상태에 맞춰 JPEG 품질과 해상도를 조절하는 적응형 레이트 컨트롤러
+//
+// 스트림 전송 태스크가 프레임마다 "소켓에 쓰는 데 걸린 시간"과 JPEG 크기를 보고하면,
+// 일정 구간(RC_WINDOW_MS)마다 목표 fps 의 프레임 간격 중 전송에 막힌 비율을 계산한다.
+// 링크가 막히면 먼저 quality 값을 올리고(화질 낮춤), 한계에 닿으면 framesize 를 한 단계 내린다.
+// 여유가 몇 구간 이어지면 반대로 사용자가 설정한 값(기준값)까지 천천히 되돌린다.
+// 브로드캐스터가 최신 프레임만 넘기므로 지연이 쌓이지는 않고, 대신 fps 가 떨어지는 것을 막는다.
+//
+// 프로필의 set_res_raw 창이 출력 크기를 정하는 동안에는 framesize 를 바꾸면 창이 걷히므로 quality 만 조절한다.
+//
+// 카메라 설정은 모든 스트림이 공유하므로 가장 느린 클라이언트 기준으로 맞춰진다. 구간은 클라이언트마다
+// 따로 재고, 막힌 비율이 가장 큰 클라이언트로 판단한다. 센서 설정은 브로드캐스터 설정 펜스 안에서 바꾸므로
+// 바뀌는 도중에 찍힌 프레임은 스트림에 나가지 않는다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_camera.h"
+
+typedef struct {
+  bool enabled;
+  int target_fps;        // 유지하려는 스트림 fps
+  int max_kbps;          // 스트림당 최대 비트레이트 (0: 제한 없음)
+  framesize_t base_framesize;  // 사용자가 설정한 값 (상한)
+  int base_quality;
+  framesize_t framesize; // 현재 적용 중인 값
+  int quality;
+  bool framesize_locked; // 창이 출력 크기를 정하고 있어 framesize 는 건드리지 않음
+  uint32_t adjustments;  // 설정을 바꾼 횟수
+} rate_ctrl_state_t;
+
+// 현재 센서 설정을 기준값으로 잡는다.
+void rate_ctrl_init(void);
+
+// 사용자가 /control 로 framesize/quality 를 바꿨을 때 기준값을 갱신한다. 센서가 받아들인 값만 넘긴다.
+// framesize 를 바꾸면 창이 걷히므로 rate_ctrl_lock_framesize() 도 풀린다.
+void rate_ctrl_set_base_framesize(framesize_t framesize);
+void rate_ctrl_set_base_quality(int quality);
+
+// 프로필이 창을 적용하거나 걷을 때 설정 펜스 안에서 부른다.
+void rate_ctrl_lock_framesize(bool locked);
+
+// /control 의 설정 펜스 안에서 부른다 (끄면 기준값을 바로 센서에 적용한다).
+void rate_ctrl_set_enabled(bool enabled);
+void rate_ctrl_set_target_fps(int fps);
+void rate_ctrl_set_max_kbps(int kbps);
+
+// 스트림 전송 태스크가 프레임 하나를 보낸 뒤 호출한다. client 는 클라이언트마다 다른 값(구독 포인터)이다.
+void rate_ctrl_report(const void *client, int64_t send_us, size_t jpg_len);
+// 끝난 클라이언트의 구간 자리를 비운다.
+void rate_ctrl_forget(const void *client);
+
+// 마지막 스트림이 끝났을 때 호출한다. 기준값을 되돌려 /capture 가 원래 설정을 쓰게 한다.
+void rate_ctrl_idle(void);
+
+void rate_ctrl_get(rate_ctrl_state_t *out);
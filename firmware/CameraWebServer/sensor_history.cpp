@@ -0,0 +1,175 @@
+// 센서 시계열 기록 구현 (sensor_history.h 참고)
+#include "sensor_history.h"
+#include "sensor_snapshot.h"
+#include "flame_sensor.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <Arduino.h>
+
+// 기록 태스크가 스냅샷을 확인하는 주기. 불꽃 에지는 디바운스(5ms) 때문에 이 동안 20 개를 넘지 않으므로
+// 에지 링(31 개)에서 빠짐없이 가져온다.
+#define HIST_POLL_MS 100
+// 이 간격마다 기록의 절대 시각을 DRAM 에 따로 두어, 임의의 seq 의 시각을 이만큼의 덧셈 안에 구한다.
+#define HIST_KEY_EVERY 256
+
+static hist_record_t *ring = NULL;
+static uint32_t capacity;      // 2 의 거듭제곱
+static int64_t *keys = NULL;   // keys[(i / HIST_KEY_EVERY) % nkeys] = i 번째 기록의 시각
+static uint32_t nkeys;
+static SemaphoreHandle_t lock = NULL;
+
+// 아래는 lock 으로 보호
+static uint32_t count;        // 지금까지 남긴 기록 수 = 마지막 seq. i 번째(0 부터) 기록의 seq 는 i + 1.
+static int64_t last_us;       // 마지막 기록의 시각 (dt_ms 로 복원되는 값)
+static int64_t oldest_us;     // 링에 남은 가장 오래된 기록의 시각
+
+// 기록 태스크만 쓰는 상태
+static hist_record_t cur = {0, 0, -1, INT16_MIN, UINT16_MAX};  // 다음 기록에 넣을 센서 값
+static uint32_t last_edge_seq;
+static int64_t last_dht_us;
+
+static uint32_t oldest_index_locked(void) {
+  return count > capacity ? count - capacity : 0;
+}
+
+static void push_locked(uint8_t type, uint16_t dt_ms) {
+  uint32_t i = count;
+  if (i == 0) {
+    dt_ms = 0;
+  } else if (i >= capacity) {
+    // 가장 오래된 기록이 덮어써지므로 그다음 기록이 새 기준이 된다.
+    oldest_us += ring[(i - capacity + 1) & (capacity - 1)].dt_ms * 1000LL;
+  }
+  hist_record_t *r = &ring[i & (capacity - 1)];
+  *r = cur;
+  r->type = type;
+  r->dt_ms = dt_ms;
+  last_us += dt_ms * 1000LL;
+  if (i % HIST_KEY_EVERY == 0) {
+    keys[(i / HIST_KEY_EVERY) % nkeys] = last_us;
+  }
+  count++;
+}
+
+static void append_locked(uint8_t type, int64_t time_us) {
+  if (count == 0) {
+    last_us = oldest_us = time_us;
+  }
+  // 복원되는 시각(last_us) 기준으로 차이를 구하므로 ms 로 자른 오차가 쌓이지 않는다.
+  int64_t dt = max((time_us - last_us) / 1000, (int64_t)0);
+  while (dt > UINT16_MAX) {
+    push_locked(HIST_GAP, UINT16_MAX);
+    dt -= UINT16_MAX;
+  }
+  push_locked(type, (uint16_t)dt);
+}
+
+static int64_t time_of_locked(uint32_t i) {
+  uint32_t from = i / HIST_KEY_EVERY * HIST_KEY_EVERY;
+  int64_t t;
+  if (from >= oldest_index_locked()) {
+    t = keys[(from / HIST_KEY_EVERY) % nkeys];
+  } else {
+    from = oldest_index_locked();
+    t = oldest_us;
+  }
+  for (uint32_t j = from + 1; j <= i; j++) {
+    t += ring[j & (capacity - 1)].dt_ms * 1000LL;
+  }
+  return t;
+}
+
+static void record_dht(const sensor_snapshot_t *snap) {
+  cur.temperature = (int16_t)lroundf(snap->temperature * 100);
+  cur.humidity = (uint16_t)lroundf(snap->humidity * 100);
+  append_locked(HIST_DHT, snap->dht_us);
+  last_dht_us = snap->dht_us;
+}
+
+static void history_task(void *arg) {
+  flame_edge_t edges[FLAME_EDGE_RING - 1];
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(HIST_POLL_MS));
+    sensor_snapshot_t snap;
+    sensor_snapshot_read(&snap);
+    bool dht_new = snap.dht_us != last_dht_us;
+    size_t n = 0;
+    if (snap.flame.seq != last_edge_seq) {
+      n = flame_sensor_recent(edges, min(snap.flame.seq - last_edge_seq, (uint32_t)FLAME_EDGE_RING - 1));
+    } else if (snap.flame.seq == 0) {
+      cur.flame = snap.flame.state;  // 아직 에지가 없으면 초기 레벨
+    }
+    if (!dht_new && n == 0) {
+      continue;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    // 에지는 새것부터 들어 있으므로 거꾸로 돌며 DHT 읽기와 시각 순으로 섞는다.
+    for (size_t k = n; k-- > 0;) {
+      if (edges[k].seq <= last_edge_seq) {
+        continue;
+      }
+      if (dht_new && snap.dht_us <= edges[k].time_us) {
+        record_dht(&snap);
+        dht_new = false;
+      }
+      cur.flame = edges[k].level;
+      append_locked(HIST_FLAME, edges[k].time_us);
+      last_edge_seq = edges[k].seq;
+    }
+    if (dht_new) {
+      record_dht(&snap);
+    }
+    xSemaphoreGive(lock);
+  }
+}
+
+esp_err_t sensor_history_start(void) {
+  if (ring) {
+    return ESP_OK;
+  }
+  capacity = psramFound() ? HIST_CAPACITY : HIST_CAPACITY_DRAM;
+  ring = (hist_record_t *)(psramFound() ? ps_malloc(capacity * sizeof(hist_record_t))
+                                        : malloc(capacity * sizeof(hist_record_t)));
+  nkeys = capacity / HIST_KEY_EVERY;
+  keys = (int64_t *)malloc(nkeys * sizeof(int64_t));
+  lock = xSemaphoreCreateMutex();
+  if (!ring || !keys || !lock) {
+    log_e("History buffer allocation failed");
+    return ESP_ERR_NO_MEM;
+  }
+  if (xTaskCreate(history_task, "history", 3072, NULL, 1, NULL) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+size_t sensor_history_read(uint32_t since, hist_record_t *out, size_t limit, uint32_t *first_seq, int64_t *first_us) {
+  if (!ring) {
+    return 0;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  // seq 가 since 인 기록의 다음, 즉 since 번째(0 부터) 기록부터 복사한다.
+  uint32_t start = max(since, oldest_index_locked());
+  size_t n = start < count ? min(limit, (size_t)(count - start)) : 0;
+  for (size_t k = 0; k < n; k++) {
+    out[k] = ring[(start + k) & (capacity - 1)];
+  }
+  if (n) {
+    *first_seq = start + 1;
+    *first_us = time_of_locked(start);
+  }
+  xSemaphoreGive(lock);
+  return n;
+}
+
+uint32_t sensor_history_last_seq(void) {
+  if (!ring) {
+    return 0;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  uint32_t seq = count;
+  xSemaphoreGive(lock);
+  return seq;
+}
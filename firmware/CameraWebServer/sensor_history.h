@@ -0,0 +1,40 @@
+// 센서 시계열 기록 (/history)
+//
+// DHT22 읽기와 불꽃 에지마다 그 시점의 센서 값 전체를 8 바이트 기록 하나로 남긴다.
+// 시각은 직전 기록과의 차이(ms)로만 저장하고, 링이 넘치면 가장 오래된 기록부터 덮어쓴다.
+// PSRAM 이 있으면 HIST_CAPACITY 개(256KB, DHT 만으로 약 18 시간), 없으면 HIST_CAPACITY_DRAM 개를 둔다.
+//
+// 기록 번호(seq)는 1 부터 계속 늘어나므로, 백엔드는 마지막으로 받은 seq 를 기억했다가
+// /history?since=<seq> 로 그 뒤의 기록만 한 번에 받아 간다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define HIST_CAPACITY      32768  // 2 의 거듭제곱
+#define HIST_CAPACITY_DRAM 1024
+
+// type
+#define HIST_DHT   1  // DHT22 읽기 (온도/습도가 새 값)
+#define HIST_FLAME 2  // 불꽃 에지 (flame 이 새 값)
+#define HIST_GAP   3  // 기록 사이가 65.535 초를 넘을 때 시간만 채우는 기록
+
+typedef struct __attribute__((packed)) {
+  uint16_t dt_ms;        // 직전 기록과의 시간 차
+  uint8_t type;
+  int8_t flame;          // 0: 불꽃 감지, 1: 정상, -1: 초기화 전
+  int16_t temperature;   // 0.01°C (INT16_MIN: 아직 읽지 못함)
+  uint16_t humidity;     // 0.01% (UINT16_MAX: 아직 읽지 못함)
+} hist_record_t;
+
+// 링을 잡고 센서 스냅샷을 기록하는 태스크를 시작한다. 센서 초기화 뒤에 부른다.
+esp_err_t sensor_history_start(void);
+
+// seq 가 since 보다 큰 기록을 오래된 것부터 최대 limit 개 복사하고 개수를 돌려준다.
+// *first_seq, *first_us 에는 복사한 첫 기록의 번호와 시각(esp_timer_get_time() 기준)을 넣는다.
+// since 뒤의 기록이 이미 덮어써졌으면 남아 있는 가장 오래된 기록부터 복사한다.
+size_t sensor_history_read(uint32_t since, hist_record_t *out, size_t limit, uint32_t *first_seq, int64_t *first_us);
+
+// 마지막 기록의 번호 (0: 기록 없음)
+uint32_t sensor_history_last_seq(void);
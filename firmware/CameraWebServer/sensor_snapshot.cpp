@@ -0,0 +1,55 @@
+// 센서 스냅샷 시퀀스 락 구현 (sensor_snapshot.h 참고)
+#include "sensor_snapshot.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <Arduino.h>
+#include <atomic>
+
+static std::atomic<uint32_t> lock_seq(0);  // 홀수: 쓰는 중
+static sensor_snapshot_t snap = {0, 0, NAN, NAN, 0, {-1, 0, 0}};
+static portMUX_TYPE write_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline void IRAM_ATTR write_begin(void) {
+  lock_seq.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void IRAM_ATTR write_end(int64_t now) {
+  snap.seq++;
+  snap.timestamp_us = now;
+  lock_seq.fetch_add(1, std::memory_order_release);
+}
+
+void sensor_snapshot_update_dht(float temperature, float humidity) {
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_SAFE(&write_mux);
+  write_begin();
+  snap.temperature = temperature;
+  snap.humidity = humidity;
+  snap.dht_us = now;
+  write_end(now);
+  portEXIT_CRITICAL_SAFE(&write_mux);
+}
+
+void IRAM_ATTR sensor_snapshot_update_flame(const flame_state_t *st) {
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_SAFE(&write_mux);
+  write_begin();
+  snap.flame = *st;
+  write_end(now);
+  portEXIT_CRITICAL_SAFE(&write_mux);
+}
+
+void sensor_snapshot_read(sensor_snapshot_t *out) {
+  for (;;) {
+    uint32_t before = lock_seq.load(std::memory_order_acquire);
+    if (before & 1) {
+      continue;  // 쓰는 중. 쓰기는 수 us 안에 끝난다.
+    }
+    memcpy(out, (const void *)&snap, sizeof(*out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (lock_seq.load(std::memory_order_relaxed) == before) {
+      return;
+    }
+  }
+}
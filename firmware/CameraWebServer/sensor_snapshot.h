@@ -0,0 +1,29 @@
+// 센서 값(DHT22, 불꽃)의 최신 스냅샷
+//
+// dht 태스크와 불꽃 인터럽트가 값을 갱신하고, HTTP 핸들러와 /ws 태스크는 잠금 없이 읽는다.
+// 시퀀스 락(seqlock): 쓰는 쪽은 카운터를 홀수로 만든 뒤 값을 쓰고 다시 짝수로 만든다.
+// 읽는 쪽은 카운터가 짝수이고 복사 전후로 같을 때까지 다시 읽으므로, 온도와 습도가 서로 다른
+// 샘플에서 섞여 보이지 않는다. 쓰는 쪽끼리는 spinlock 으로 순서를 정한다 (인터럽트에서도 씀).
+//
+// 센서 값을 내보내는 엔드포인트는 모두 이 스냅샷에서 읽는다.
+#pragma once
+
+#include <stdint.h>
+#include "flame_sensor.h"
+
+typedef struct {
+  uint32_t seq;            // 갱신할 때마다 1 씩 증가 (0: 아직 아무 값도 없음)
+  int64_t timestamp_us;    // 마지막 갱신 시각 (esp_timer_get_time())
+  float temperature;       // 섭씨 (NAN: 아직 읽지 못함)
+  float humidity;          // % (NAN: 아직 읽지 못함)
+  int64_t dht_us;          // 마지막 DHT22 읽기 성공 시각 (0: 없음)
+  flame_state_t flame;     // 불꽃 상태와 마지막 에지
+} sensor_snapshot_t;
+
+// dht 태스크의 읽기 성공 콜백 (dht_reading_cb_t)
+void sensor_snapshot_update_dht(float temperature, float humidity);
+
+// 불꽃 에지 콜백 (flame_edge_cb_t). 인터럽트 문맥에서도 불린다.
+void sensor_snapshot_update_flame(const flame_state_t *st);
+
+void sensor_snapshot_read(sensor_snapshot_t *out);
@@ -0,0 +1,143 @@
+// 구간 타임라인 기록 구현 (trace.h 참고)
+#include "trace.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <Arduino.h>
+#include <atomic>
+
+#define TRACE_CALIBRATE_SPANS 256
+
+// 슬롯의 seq 는 기록을 다 쓴 뒤에 넣고, 쓰는 동안은 0 이다. 읽는 쪽은 복사 전후의 seq 가 기대한
+// 번호와 같을 때만 받아들인다 (sensor_snapshot 과 같은 방식).
+typedef struct {
+  std::atomic<uint32_t> seq;
+  trace_event_t ev;
+} trace_slot_t;
+
+static trace_slot_t *ring = NULL;
+static uint32_t capacity;
+static std::atomic<uint32_t> head(0);  // 마지막으로 번호를 받은 기록
+static uint32_t overhead_ns;
+
+// 태스크 표. 등록은 드물어 mux 로 묶고, 찾기는 task_count 까지만 잠금 없이 읽는다.
+static portMUX_TYPE task_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t task_handles[TRACE_TASKS];
+static char task_names[TRACE_TASKS][16];
+static std::atomic<uint32_t> task_count(0);
+
+static uint8_t task_index(void) {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  uint32_t n = task_count.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < n; i++) {
+    if (task_handles[i] == self) {
+      return i;
+    }
+  }
+  // 지워진 태스크의 핸들을 새 태스크가 물려받으면 처음 등록한 이름으로 보인다.
+  const char *name = self ? pcTaskGetName(self) : "main";
+  uint8_t index = TRACE_TASK_OTHER;
+  portENTER_CRITICAL(&task_mux);
+  n = task_count.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < n; i++) {
+    if (task_handles[i] == self) {
+      index = i;
+    }
+  }
+  if (index == TRACE_TASK_OTHER && n < TRACE_TASKS) {
+    task_handles[n] = self;
+    snprintf(task_names[n], sizeof(task_names[n]), "%s", name);
+    task_count.store(n + 1, std::memory_order_release);
+    index = n;
+  }
+  portEXIT_CRITICAL(&task_mux);
+  return index;
+}
+
+void trace_span(const char *name, int64_t start_us, uint32_t arg) {
+  if (!ring) {
+    return;
+  }
+  int64_t now = esp_timer_get_time();
+  uint8_t task = task_index();
+  uint32_t seq = head.fetch_add(1, std::memory_order_relaxed) + 1;
+  trace_slot_t *s = &ring[(seq - 1) & (capacity - 1)];
+  s->seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s->ev.seq = seq;
+  s->ev.dur_us = (uint32_t)(now - start_us);
+  s->ev.start_us = start_us;
+  s->ev.name = name;
+  s->ev.arg = arg;
+  s->ev.task = task;
+  s->ev.core = (uint8_t)xPortGetCoreID();
+  s->seq.store(seq, std::memory_order_release);
+}
+
+esp_err_t trace_init(void) {
+  if (ring) {
+    return ESP_OK;
+  }
+  capacity = psramFound() ? TRACE_CAPACITY : TRACE_CAPACITY_DRAM;
+  trace_slot_t *r = (trace_slot_t *)(psramFound() ? ps_malloc(capacity * sizeof(trace_slot_t))
+                                                  : malloc(capacity * sizeof(trace_slot_t)));
+  if (!r) {
+    log_e("Trace buffer allocation failed");
+    return ESP_ERR_NO_MEM;
+  }
+  for (uint32_t i = 0; i < capacity; i++) {
+    r[i].seq.store(0, std::memory_order_relaxed);
+  }
+  ring = r;
+
+  // 기록 비용을 재고, 잰 기록은 지운다 (아직 다른 태스크가 기록하지 않는 시점).
+  int64_t t0 = esp_timer_get_time();
+  for (int i = 0; i < TRACE_CALIBRATE_SPANS; i++) {
+    trace_span("trace_calibrate", t0, 0);
+  }
+  overhead_ns = (uint32_t)((esp_timer_get_time() - t0) * 1000 / TRACE_CALIBRATE_SPANS);
+  for (uint32_t i = 0; i < capacity; i++) {
+    ring[i].seq.store(0, std::memory_order_relaxed);
+  }
+  head.store(0, std::memory_order_release);
+  log_i("Trace: %u spans, %uns per span", capacity, overhead_ns);
+  return ESP_OK;
+}
+
+size_t trace_read(uint32_t since, trace_event_t *out, size_t limit) {
+  if (!ring) {
+    return 0;
+  }
+  uint32_t end = head.load(std::memory_order_acquire);
+  uint32_t start = max(since, end > capacity ? end - capacity : 0);
+  size_t n = 0;
+  for (uint32_t seq = start + 1; seq <= end && n < limit; seq++) {
+    trace_slot_t *s = &ring[(seq - 1) & (capacity - 1)];
+    uint32_t before = s->seq.load(std::memory_order_acquire);
+    if (before == seq) {
+      out[n] = s->ev;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s->seq.load(std::memory_order_relaxed) == seq) {
+        n++;
+        continue;
+      }
+    }
+    if (before < seq) {
+      break;  // 아직 쓰는 중
+    }
+    // 읽는 사이에 덮어써졌으면 건너뛴다 (번호가 비므로 받는 쪽이 알 수 있다).
+  }
+  return n;
+}
+
+uint32_t trace_last_seq(void) {
+  return ring ? head.load(std::memory_order_acquire) : 0;
+}
+
+const char *trace_task_name(uint8_t task) {
+  return task < task_count.load(std::memory_order_acquire) ? task_names[task] : NULL;
+}
+
+uint32_t trace_overhead_ns(void) {
+  return overhead_ns;
+}
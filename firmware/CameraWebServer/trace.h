@@ -0,0 +1,51 @@
+// 구간 타임라인 기록 (/trace)
+//
+// 부팅 단계와 프레임 경로(캡처 대기, 변환, 전송), DHT 읽기처럼 시간이 드는 구간을 이름, 시작 시각,
+// 길이로 링에 남긴다. 항상 켜져 있으므로 기록은 잠금 없이 한다 (trace_overhead_ns() 로 비용을 잰다).
+// PSRAM 이 있으면 TRACE_CAPACITY 개, 없으면 TRACE_CAPACITY_DRAM 개를 두고 넘치면 오래된 것부터 덮는다.
+//
+// 사용법:
+//   int64_t t0 = esp_timer_get_time();
+//   camera_fb_t *fb = esp_camera_fb_get();
+//   trace_span("fb_get", t0, fb ? fb->len : 0);
+//
+// /trace 는 이 링을 Chrome trace-event JSON 으로 내보낸다 (chrome://tracing, Perfetto 에서 열림).
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define TRACE_CAPACITY      4096  // 2 의 거듭제곱
+#define TRACE_CAPACITY_DRAM 256
+#define TRACE_TASKS         24    // 구분해서 보여 줄 태스크 수 (넘으면 한데 묶음)
+#define TRACE_TASK_OTHER    0xFF
+
+typedef struct {
+  uint32_t seq;       // 1 부터 늘어나는 기록 번호
+  uint32_t dur_us;
+  int64_t start_us;   // esp_timer_get_time() 기준
+  const char *name;   // 문자열 상수여야 한다 (포인터만 저장)
+  uint32_t arg;       // 구간별 값 (바이트 수 등, 0: 없음)
+  uint8_t task;       // trace_task_name() 의 번호
+  uint8_t core;
+} trace_event_t;
+
+// 링을 잡고 기록 비용을 잰다. setup() 맨 앞에서 부른다. 그 전의 trace_span() 은 버려진다.
+esp_err_t trace_init(void);
+
+// start_us 부터 지금까지를 name 구간으로 남긴다. 어느 태스크에서나 부를 수 있다 (ISR 제외).
+void trace_span(const char *name, int64_t start_us, uint32_t arg);
+
+// seq 가 since 보다 큰 기록을 오래된 것부터 최대 limit 개 복사한다. since 뒤의 기록이 이미 덮어써졌으면
+// 남아 있는 가장 오래된 기록부터, 아직 쓰는 중인 기록을 만나면 그 앞까지만 복사한다.
+size_t trace_read(uint32_t since, trace_event_t *out, size_t limit);
+
+// 마지막 기록의 번호 (0: 기록 없음)
+uint32_t trace_last_seq(void);
+
+// 태스크 번호의 이름 (NULL: 등록되지 않은 번호)
+const char *trace_task_name(uint8_t task);
+
+// trace_span() 한 번의 평균 비용 (trace_init() 에서 잰 값)
+uint32_t trace_overhead_ns(void);
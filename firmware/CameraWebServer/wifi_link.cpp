@@ -0,0 +1,119 @@
+// WiFi 접속과 빠른 재접속 구현 (wifi_link.h 참고)
+#include "wifi_link.h"
+#include "boot_stats.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+#define WIFI_LINK_NVS_NAMESPACE "wifi_link"
+#define WIFI_LINK_POLL_MS 20
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t channel;   // 0: 캐시 없음
+  uint8_t reserved;
+} wifi_link_cache_t;
+
+static const char *link_ssid;
+static const char *link_password;
+static wifi_link_cache_t cache;
+static wifi_link_mode_t link_mode = WIFI_LINK_SCAN;
+static int64_t begin_us;
+
+static bool cache_load(void) {
+  Preferences prefs;
+  if (!prefs.begin(WIFI_LINK_NVS_NAMESPACE, true)) {
+    return false;
+  }
+  bool ok = prefs.getBytes("cache", &cache, sizeof(cache)) == sizeof(cache);
+  prefs.end();
+  return ok && cache.channel;
+}
+
+static void cache_store(const wifi_link_cache_t *c) {
+  if (!memcmp(c, &cache, sizeof(*c))) {
+    return;  // 플래시 마모를 줄이려고 같은 값은 다시 쓰지 않는다.
+  }
+  Preferences prefs;
+  if (prefs.begin(WIFI_LINK_NVS_NAMESPACE, false)) {
+    prefs.putBytes("cache", c, sizeof(*c));
+    prefs.end();
+  }
+  cache = *c;
+}
+
+static void cache_clear(void) {
+  Preferences prefs;
+  if (prefs.begin(WIFI_LINK_NVS_NAMESPACE, false)) {
+    prefs.remove("cache");
+    prefs.end();
+  }
+  memset(&cache, 0, sizeof(cache));
+}
+
+static void connect(wifi_link_mode_t mode) {
+  bool cached = mode != WIFI_LINK_SCAN;
+  WiFi.begin(link_ssid, link_password, cached ? cache.channel : 0, cached ? cache.bssid : NULL);
+  // WiFi 슬립 모드 비활성화 (연결 안정성 향상)
+  WiFi.setSleep(false);
+  link_mode = mode;
+}
+
+static void wifi_link_task(void *arg) {
+  int64_t start = esp_timer_get_time();
+  while (!WiFi.isConnected() || !(uint32_t)WiFi.localIP()) {
+    if (link_mode != WIFI_LINK_SCAN && esp_timer_get_time() - start > WIFI_LINK_CACHED_TIMEOUT_MS * 1000LL) {
+      log_w("Cached WiFi parameters failed, scanning");
+      WiFi.disconnect();
+      cache_clear();
+      connect(WIFI_LINK_SCAN);
+    }
+    vTaskDelay(pdMS_TO_TICKS(WIFI_LINK_POLL_MS));
+  }
+  boot_mark(BOOT_WIFI, begin_us);
+  Serial.printf("WiFi connected (%s, %lldms)\n", wifi_link_mode_name(link_mode),
+                (long long)(boot_time_us(BOOT_WIFI) / 1000));
+
+  wifi_link_cache_t c = {};
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid) {
+    memcpy(c.bssid, bssid, sizeof(c.bssid));
+    c.channel = WiFi.channel();
+    cache_store(&c);
+  }
+
+  // 연결된 IP 주소를 출력하여 접속 방법 안내
+  Serial.print("Camera Ready! Use 'http://");
+  Serial.print(WiFi.localIP());
+  Serial.println("' to connect");
+  vTaskDelete(NULL);
+}
+
+esp_err_t wifi_link_begin(const char *ssid, const char *password) {
+  begin_us = esp_timer_get_time();
+  link_ssid = ssid;
+  link_password = password;
+  WiFi.mode(WIFI_STA);
+  WiFi.persistent(false);  // 코어가 begin() 마다 설정을 플래시에 쓰지 않게 한다 (캐시는 따로 관리).
+
+  connect(cache_load() ? WIFI_LINK_BSSID : WIFI_LINK_SCAN);
+  if (xTaskCreate(wifi_link_task, "wifi_link", 3072, NULL, 2, NULL) != pdPASS) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+wifi_link_mode_t wifi_link_mode(void) {
+  return link_mode;
+}
+
+const char *wifi_link_mode_name(wifi_link_mode_t mode) {
+  switch (mode) {
+    case WIFI_LINK_BSSID:
+      return "bssid";
+    default:
+      return "scan";
+  }
+}
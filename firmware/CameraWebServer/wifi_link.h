@@ -0,0 +1,25 @@
+// WiFi 접속과 빠른 재접속
+//
+// wifi_link_begin() 은 접속을 시작만 하고 바로 돌아오므로, 그동안 카메라/센서/HTTP 서버 초기화가 함께
+// 진행된다. 연결되면 AP 의 채널과 BSSID 를 NVS 에 남겨 다음 부팅에 쓴다. 채널과 BSSID 를 알면 전 채널
+// 스캔을 건너뛴다. IP 는 항상 DHCP 로 받는다 (이전 IP 를 고정 주소로 먼저 쓰더라도 임대를 다시 받아야
+// 하므로 주소가 확정되는 시각은 같다).
+// 캐시로 WIFI_LINK_CACHED_TIMEOUT_MS 안에 연결되지 않으면(AP 교체, 채널 변경 등) 캐시를 지우고
+// 스캔부터 다시 한다. NVS 는 값이 바뀔 때만 쓴다.
+#pragma once
+
+#include "esp_err.h"
+
+#define WIFI_LINK_CACHED_TIMEOUT_MS 4000
+
+typedef enum {
+  WIFI_LINK_SCAN,     // 캐시 없이 스캔부터
+  WIFI_LINK_BSSID,    // 캐시한 채널/BSSID 로 연결
+} wifi_link_mode_t;
+
+// 접속을 시작하고, 연결될 때까지 지켜보는 태스크를 만든다. IP 를 받으면 접속 주소를 시리얼에 출력한다.
+esp_err_t wifi_link_begin(const char *ssid, const char *password);
+
+// 이번 부팅에서 실제로 연결된 방식
+wifi_link_mode_t wifi_link_mode(void);
+const char *wifi_link_mode_name(wifi_link_mode_t mode);
@@ -0,0 +1,124 @@
+// 호스트 시뮬레이션용 Arduino.h 대체 헤더
+// 스케치가 쓰는 Arduino-ESP32 API(시간, GPIO, Serial, 로그 매크로)만 흉내 낸다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cmath>
+#include <algorithm>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+using std::isnan;
+// Arduino-ESP32 3.x 와 같이 min/max 는 std 것을 쓰고 constrain 은 매크로다.
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define ARDUHAL_LOG_LEVEL_NONE    (0)
+#define ARDUHAL_LOG_LEVEL_ERROR   (1)
+#define ARDUHAL_LOG_LEVEL_WARN    (2)
+#define ARDUHAL_LOG_LEVEL_INFO    (3)
+#define ARDUHAL_LOG_LEVEL_DEBUG   (4)
+#define ARDUHAL_LOG_LEVEL_VERBOSE (5)
+
+// CMake 의 CAMSIM_LOG_LEVEL 로 정해지며, 보드의 "Core Debug Level" 과 같은 역할을 한다.
+#ifndef ARDUHAL_LOG_LEVEL
+#define ARDUHAL_LOG_LEVEL ARDUHAL_LOG_LEVEL_ERROR
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void camsim_log(char level, const char *file, int line, const char *func, const char *fmt, ...)
+    __attribute__((format(printf, 5, 6)));
+#ifdef __cplusplus
+}
+#endif
+
+#define CAMSIM_LOG(level, format, ...) camsim_log(level, __FILE__, __LINE__, __func__, format, ##__VA_ARGS__)
+
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
+#define log_e(format, ...) CAMSIM_LOG('E', format, ##__VA_ARGS__)
+#else
+#define log_e(format, ...) do {} while (0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
+#define log_w(format, ...) CAMSIM_LOG('W', format, ##__VA_ARGS__)
+#else
+#define log_w(format, ...) do {} while (0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define log_i(format, ...) CAMSIM_LOG('I', format, ##__VA_ARGS__)
+#else
+#define log_i(format, ...) do {} while (0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define log_d(format, ...) CAMSIM_LOG('D', format, ##__VA_ARGS__)
+#else
+#define log_d(format, ...) do {} while (0)
+#endif
+
+#define LOW    0x0
+#define HIGH   0x1
+#define INPUT  0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+// 호스트에는 IRAM 이 따로 없다.
+#define IRAM_ATTR
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+// 센서 트레이스의 불꽃 값이 바뀌는 시각마다 별도 스레드에서 isr 을 부른다 (불꽃 핀만 지원).
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+bool psramFound(void);
+void *ps_malloc(size_t size);
+
+// newlib 에는 있지만 glibc 에는 없는 변환 함수
+char *itoa(int value, char *str, int base);
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _addr{a, b, c, d} {}
+  // 실제 코어처럼 메모리상 바이트 순서(네트워크 순서) 그대로의 32 비트 값
+  IPAddress(uint32_t address) { memcpy(_addr, &address, 4); }
+  operator uint32_t() const {
+    uint32_t v;
+    memcpy(&v, _addr, 4);
+    return v;
+  }
+  uint8_t operator[](int i) const { return _addr[i]; }
+
+private:
+  uint8_t _addr[4];
+};
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud);
+  void setDebugOutput(bool enable);
+  size_t print(const char *s);
+  size_t print(const IPAddress &ip);
+  size_t println(const char *s = "");
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,22 @@
+// 호스트 시뮬레이션용 Preferences.h (NVS) 대체 헤더
+// --nvs FILE 을 주면 그 파일에 저장해 다음 실행에서도 남고, 없으면 메모리에만 둔다.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end();
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t getBytesLength(const char *key);
+  bool remove(const char *key);
+
+private:
+  std::string _ns;
+  bool _open = false;
+  bool _readonly = false;
+};
@@ -0,0 +1,54 @@
+// 호스트 시뮬레이션용 WiFi.h 대체 헤더
+// begin() 뒤 스캔(--wifi-scan-ms), 연결(--wifi-ms), DHCP(--dhcp-ms) 시간이 지나면 WL_CONNECTED 가 된다.
+// begin() 에 AP 의 채널과 BSSID 를 주면 스캔을, config() 로 고정 IP 를 주면 DHCP 를 건너뛴다.
+// 연결된 뒤 config() 로 고정 IP 를 지우면 ESP32 처럼 주소를 비우고 DHCP(--dhcp-ms)로 다시 받는다.
+// 주소는 루프백(또는 config() 로 준 주소)이다.
+#pragma once
+
+#include "Arduino.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode);
+  void persistent(bool persistent);
+  bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress());
+  wl_status_t begin(const char *ssid, const char *passphrase = NULL, int32_t channel = 0, const uint8_t *bssid = NULL,
+                    bool connect = true);
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool setSleep(bool enable);
+  wl_status_t status();
+  bool isConnected();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t dns_no = 0);
+  uint8_t *BSSID();
+  int32_t channel();
+
+private:
+  int64_t _connect_at_us = -1;
+  int64_t _dhcp_at_us = 0;  // 연결 뒤 DHCP 로 바꿨을 때 주소를 받는 시각
+  bool _wrong_ap = false;
+  uint32_t _static_ip = 0;
+  uint32_t _static_gw = 0, _static_mask = 0, _static_dns = 0;
+};
+
+extern WiFiClass WiFi;
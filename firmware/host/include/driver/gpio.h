@@ -0,0 +1,30 @@
+// 호스트 시뮬레이션용 driver/gpio.h 대체 헤더
+// 출력 레벨만 기억하며, DHT 핀의 시작 신호는 fake_rmt.cpp 가 받아 센서 응답을 흉내 낸다.
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_MODE_DISABLE = 0,
+  GPIO_MODE_INPUT = 1,
+  GPIO_MODE_OUTPUT = 2,
+  GPIO_MODE_OUTPUT_OD = 6,
+  GPIO_MODE_INPUT_OUTPUT_OD = 7,
+  GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+esp_err_t gpio_pullup_en(gpio_num_t gpio_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+// 호스트 시뮬레이션용 esp32-hal-ledc.h 대체 헤더 (LED 플래시는 시뮬레이션하지 않음)
+#pragma once
+
+#include <stdint.h>
+
+static inline uint32_t ledcSetup(uint8_t, uint32_t freq, uint8_t) { return freq; }
+static inline void ledcAttachPin(uint8_t, uint8_t) {}
+static inline void ledcWrite(uint8_t, uint32_t) {}
@@ -0,0 +1,103 @@
+// 호스트 시뮬레이션용 esp_camera.h 대체 헤더
+// 실제 센서 대신 JPEG 파일(또는 합성 패턴)을 센서 프레임 주기에 맞춰 재생한다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "esp_err.h"
+#include "sensor.h"
+
+typedef enum {
+  LEDC_TIMER_0 = 0,
+  LEDC_TIMER_1,
+  LEDC_TIMER_2,
+  LEDC_TIMER_3,
+} ledc_timer_t;
+
+typedef enum {
+  LEDC_CHANNEL_0 = 0,
+  LEDC_CHANNEL_1,
+  LEDC_CHANNEL_2,
+  LEDC_CHANNEL_3,
+  LEDC_CHANNEL_4,
+  LEDC_CHANNEL_5,
+  LEDC_CHANNEL_6,
+  LEDC_CHANNEL_7,
+} ledc_channel_t;
+
+typedef enum {
+  CAMERA_GRAB_WHEN_EMPTY,  // 빈 버퍼가 있을 때만 채움 (오래된 프레임이 나올 수 있음)
+  CAMERA_GRAB_LATEST       // 빈 버퍼가 없으면 가장 오래된 프레임을 덮어씀
+} camera_grab_mode_t;
+
+typedef enum {
+  CAMERA_FB_IN_PSRAM,
+  CAMERA_FB_IN_DRAM
+} camera_fb_location_t;
+
+typedef struct {
+  int pin_pwdn;
+  int pin_reset;
+  int pin_xclk;
+  union {
+    int pin_sccb_sda;
+    int pin_sscb_sda;
+  };
+  union {
+    int pin_sccb_scl;
+    int pin_sscb_scl;
+  };
+  int pin_d7;
+  int pin_d6;
+  int pin_d5;
+  int pin_d4;
+  int pin_d3;
+  int pin_d2;
+  int pin_d1;
+  int pin_d0;
+  int pin_vsync;
+  int pin_href;
+  int pin_pclk;
+
+  int xclk_freq_hz;
+  ledc_timer_t ledc_timer;
+  ledc_channel_t ledc_channel;
+
+  pixformat_t pixel_format;
+  framesize_t frame_size;
+  int jpeg_quality;
+  size_t fb_count;
+  camera_fb_location_t fb_location;
+  camera_grab_mode_t grab_mode;
+  int sccb_i2c_port;
+} camera_config_t;
+
+typedef struct {
+  uint8_t *buf;              // 픽셀 데이터
+  size_t len;                // 버퍼 길이 (바이트)
+  size_t width;              // 가로 픽셀 수
+  size_t height;             // 세로 픽셀 수
+  pixformat_t format;        // 픽셀 포맷
+  struct timeval timestamp;  // 첫 DMA 버퍼를 받은 시각
+} camera_fb_t;
+
+#define ESP_ERR_CAMERA_BASE                 0x20000
+#define ESP_ERR_CAMERA_NOT_DETECTED         (ESP_ERR_CAMERA_BASE + 1)
+#define ESP_ERR_CAMERA_FAILED_TO_SET_FRAME_SIZE (ESP_ERR_CAMERA_BASE + 2)
+#define ESP_ERR_CAMERA_FAILED_TO_SET_OUT_FORMAT (ESP_ERR_CAMERA_BASE + 3)
+#define ESP_ERR_CAMERA_NOT_SUPPORTED        (ESP_ERR_CAMERA_BASE + 4)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_camera_init(const camera_config_t *config);
+esp_err_t esp_camera_deinit(void);
+camera_fb_t *esp_camera_fb_get(void);
+void esp_camera_fb_return(camera_fb_t *fb);
+sensor_t *esp_camera_sensor_get(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+// 호스트 시뮬레이션용 esp_heap_caps.h: 호스트 malloc 은 영역을 나누지 않으므로 AI-Thinker 보드에서
+// 카메라 서버가 뜬 뒤의 전형적인 값을 돌려준다 (PSRAM 은 --no-psram 이면 0).
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+// 호스트에는 영역이 하나뿐이므로 caps 는 무시한다.
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+  return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  return calloc(n, size);
+}
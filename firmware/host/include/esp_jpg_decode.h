@@ -0,0 +1,23 @@
+// 호스트 시뮬레이션용 esp_jpg_decode.h (esp32-camera conversions)
+// 실제 디코더(tjpgd)처럼 시작/끝을 data == NULL 로 알리고, 그 사이에 MCU 블록을 왼쪽에서 오른쪽,
+// 위에서 아래 순서로 RGB888(R,G,B) 로 넘긴다. 블록 크기는 16x16 (4:2:0) 로 흉내 낸다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "img_converters.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef size_t (*jpg_reader_cb)(void *arg, size_t index, uint8_t *buf, size_t len);
+typedef bool (*jpg_writer_cb)(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data);
+
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+// 호스트 시뮬레이션용 esp_timer.h 대체 헤더
+// esp_timer_get_time()은 프로세스 시작 이후 경과 시간(us)을 단조 시계로 반환한다.
+// 타이머 콜백은 ESP-IDF 의 "esp_timer" 태스크처럼 하나의 스레드에서 차례로 실행된다.
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum {
+  ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+bool esp_timer_is_active(esp_timer_handle_t timer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+// 호스트 시뮬레이션용 fb_gfx.h 대체 헤더 (스케치에서 사용하는 함수가 없어 선언만 둔다)
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+
+typedef enum {
+  FB_RGB888,
+  FB_BGR888,
+  FB_RGB565,
+  FB_BGR565,
+  FB_GRAY
+} fb_format_t;
+
+typedef struct {
+  int width;
+  int height;
+  int bytes_per_pixel;
+  fb_format_t format;
+  uint8_t *data;
+} fb_data_t;
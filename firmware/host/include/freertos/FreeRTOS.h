@@ -0,0 +1,37 @@
+// 호스트 시뮬레이션용 FreeRTOS.h 대체 헤더
+// 틱은 1ms(CONFIG_FREERTOS_HZ=1000)로 고정하며, 태스크는 POSIX 스레드로 대신한다.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY        ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS   ((TickType_t)1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(((TickType_t)(ms) * (TickType_t)CONFIG_FREERTOS_HZ) / (TickType_t)1000U))
+
+#define tskIDLE_PRIORITY     ((UBaseType_t)0U)
+#define tskNO_AFFINITY       ((BaseType_t)0x7FFFFFFF)
+#define configMAX_PRIORITIES 25
+
+// 임계 구역(spinlock). 호스트에서는 뮤텍스로 대신하며 인터럽트 마스킹은 없다.
+#include <pthread.h>
+typedef struct {
+  pthread_mutex_t mux;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {PTHREAD_MUTEX_INITIALIZER}
+#define portENTER_CRITICAL(m)     pthread_mutex_lock(&(m)->mux)
+#define portEXIT_CRITICAL(m)      pthread_mutex_unlock(&(m)->mux)
+#define portENTER_CRITICAL_ISR(m) portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_ISR(m)  portEXIT_CRITICAL(m)
+#define portENTER_CRITICAL_SAFE(m) portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_SAFE(m)  portEXIT_CRITICAL(m)
@@ -0,0 +1,32 @@
+// 호스트 시뮬레이션용 freertos/semphr.h 대체 헤더
+// 모든 세마포어는 최대값이 있는 카운팅 세마포어로 구현한다 (뮤텍스는 최대 1, 초기 1).
+// 우선순위 상속은 흉내 내지 않는다.
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_semaphore *SemaphoreHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return xSemaphoreCreateCounting(1, 1);
+}
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return xSemaphoreCreateCounting(1, 0);
+}
+
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken) xSemaphoreGive(xSemaphore)
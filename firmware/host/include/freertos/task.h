@@ -0,0 +1,34 @@
+// 호스트 시뮬레이션용 freertos/task.h 대체 헤더
+// 코어 고정(xCoreID)은 호스트에서 CPU 친화도로 흉내 내며, 코어 수가 부족하면 무시된다.
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct sim_task *TaskHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth,
+                                   void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask,
+                                   BaseType_t xCoreID);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+BaseType_t xTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t xTaskToQuery);  // NULL: 현재 태스크
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define vTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement) ((void)xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement))
+
+static inline BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth,
+                                     void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask) {
+  return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, tskNO_AFFINITY);
+}
@@ -0,0 +1,10 @@
+// 호스트 시뮬레이션용 sdkconfig.h
+// Arduino-ESP32 코어의 기본 sdkconfig 중 스케치가 참조하는 항목만 옮겨 둔다.
+#pragma once
+
+#define CONFIG_HTTPD_WS_SUPPORT 1
+#define CONFIG_LWIP_MAX_SOCKETS 16
+#define CONFIG_HTTPD_MAX_REQ_HDR_LEN 512
+#define CONFIG_HTTPD_MAX_URI_LEN 512
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_SPIRAM_SUPPORT 1
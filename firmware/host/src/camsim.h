@@ -0,0 +1,49 @@
+// 호스트 시뮬레이션 공통 설정과 가짜 드라이버 사이의 내부 인터페이스
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "sensor.h"
+
+// 명령행 옵션으로 채워지는 시뮬레이션 설정
+struct camsim_options {
+  const char *frames_dir = nullptr;    // 재생할 JPEG 파일 폴더 (없으면 합성 패턴)
+  const char *sensor_trace = nullptr;  // DHT/불꽃 센서 트레이스 파일
+  int port_offset = 8000;              // httpd 포트에 더할 값 (80 -> 8080)
+  int fps = 25;                        // SVGA 이하 해상도에서의 센서 프레임 속도
+  bool psram = true;                   // psramFound() 결과
+  uint16_t sensor_pid = 0x26;          // OV2640_PID
+  int sccb_us = 400;                   // SCCB 레지스터 접근 한 번에 걸리는 시간
+  int pixformat = -1;                  // esp_camera_init() 의 pixel_format 대신 쓸 포맷 (-1: 스케치 설정)
+  int wifi_scan_ms = 900;              // 채널/BSSID 를 모를 때의 전 채널 스캔
+  int wifi_assoc_ms = 300;             // 인증과 연결
+  int dhcp_ms = 300;                   // DHCP (고정 IP 면 0)
+  int wifi_channel = 6;                // AP 채널 (캐시와 다르면 캐시로는 연결되지 않음)
+  const char *nvs_path = nullptr;      // Preferences 저장 파일
+  int reset_reason = 1;                // esp_reset_reason() (ESP_RST_POWERON)
+  double duration_s = 0;               // 0 이면 종료하지 않음
+};
+
+extern camsim_options g_camsim;
+
+// 센서 트레이스에서 현재 시각(ms)의 값을 찾는다.
+struct camsim_sensor_sample {
+  float temperature;
+  float humidity;
+  int flame;
+};
+
+void camsim_sensor_trace_load(const char *path);
+camsim_sensor_sample camsim_sensor_at(uint32_t ms);
+
+// 가짜 SCCB 트랜잭션 지연 (레지스터 접근마다 호출)
+void camsim_sccb_delay(void);
+
+// libjpeg 기반 인코더/디코더 (rgb 는 R,G,B 순서의 24비트 버퍼)
+bool camsim_jpeg_decode(const uint8_t *src, size_t len, int scale_denom, std::vector<uint8_t> &rgb, int *w, int *h);
+bool camsim_jpeg_encode(const uint8_t *rgb, int w, int h, int quality, std::vector<uint8_t> &out);
+
+// 센서 픽셀 포맷 <-> R,G,B 버퍼 변환 (JPEG 는 디코딩만 지원)
+bool camsim_to_rgb(const uint8_t *src, size_t len, int w, int h, pixformat_t format, std::vector<uint8_t> &rgb);
+bool camsim_from_rgb(const uint8_t *rgb, int w, int h, pixformat_t format, std::vector<uint8_t> &out);
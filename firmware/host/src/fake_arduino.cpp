@@ -0,0 +1,425 @@
+// Arduino 코어(시간, GPIO, Serial, WiFi, Preferences)의 호스트용 가짜 구현
+#include "Arduino.h"
+#include "WiFi.h"
+#include "Preferences.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "camsim.h"
+
+#include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+camsim_options g_camsim;
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+static const std::chrono::steady_clock::time_point s_boot = std::chrono::steady_clock::now();
+
+extern "C" int64_t esp_timer_get_time(void) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_boot).count();
+}
+
+unsigned long millis(void) {
+  return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros(void) {
+  return (unsigned long)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ===========================
+// 로그 / Serial
+// ===========================
+static std::mutex s_out_lock;
+
+extern "C" void camsim_log(char level, const char *file, int line, const char *func, const char *fmt, ...) {
+  const char *base = strrchr(file, '/');
+  base = base ? base + 1 : file;
+  std::lock_guard<std::mutex> lock(s_out_lock);
+  fprintf(stderr, "[%6lu][%c][%s:%d] %s(): ", millis(), level, base, line, func);
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void HardwareSerial::begin(unsigned long) {}
+
+void HardwareSerial::setDebugOutput(bool) {}
+
+size_t HardwareSerial::print(const char *s) {
+  std::lock_guard<std::mutex> lock(s_out_lock);
+  size_t n = fputs(s, stdout) < 0 ? 0 : strlen(s);
+  fflush(stdout);
+  return n;
+}
+
+size_t HardwareSerial::print(const IPAddress &ip) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return print(buf);
+}
+
+size_t HardwareSerial::println(const char *s) {
+  size_t n = print(s);
+  return n + print("\r\n");
+}
+
+size_t HardwareSerial::printf(const char *fmt, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  print(buf);
+  return len < 0 ? 0 : (size_t)len;
+}
+
+char *itoa(int value, char *str, int base) {
+  if (base == 10) {
+    sprintf(str, "%d", value);
+  } else if (base == 16) {
+    sprintf(str, "%x", (unsigned)value);
+  } else {
+    str[0] = 0;
+  }
+  return str;
+}
+
+bool psramFound(void) {
+  return g_camsim.psram;
+}
+
+void *ps_malloc(size_t size) {
+  return g_camsim.psram ? malloc(size) : NULL;
+}
+
+// ===========================
+// 센서 트레이스
+// ===========================
+// 한 줄에 "시각(ms) 온도 습도 불꽃" 을 적는다. '#' 이후는 주석이며, 값은 다음 줄 시각까지 유지된다.
+// 온도/습도에 nan 을 적으면 DHT 읽기 실패를 흉내 낸다.
+struct trace_row {
+  uint32_t ms;
+  camsim_sensor_sample sample;
+};
+
+static std::vector<trace_row> s_trace;
+
+void camsim_sensor_trace_load(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "camsim: cannot open sensor trace %s\n", path);
+    exit(1);
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    char *hash = strchr(line, '#');
+    if (hash) {
+      *hash = 0;
+    }
+    trace_row row;
+    char t[32], h[32];
+    if (sscanf(line, "%u %31s %31s %d", &row.ms, t, h, &row.sample.flame) == 4) {
+      row.sample.temperature = strtof(t, NULL);
+      row.sample.humidity = strtof(h, NULL);
+      s_trace.push_back(row);
+    }
+  }
+  fclose(f);
+  std::stable_sort(s_trace.begin(), s_trace.end(), [](const trace_row &a, const trace_row &b) {
+    return a.ms < b.ms;
+  });
+}
+
+camsim_sensor_sample camsim_sensor_at(uint32_t ms) {
+  auto it = std::upper_bound(s_trace.begin(), s_trace.end(), ms, [](uint32_t v, const trace_row &r) {
+    return v < r.ms;
+  });
+  if (it == s_trace.begin()) {
+    return camsim_sensor_sample{22.5f, 45.0f, 1};
+  }
+  return (it - 1)->sample;
+}
+
+// ===========================
+// GPIO
+// ===========================
+#define CAMSIM_FLAME_PIN 14
+
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+  if (pin == CAMSIM_FLAME_PIN) {
+    return camsim_sensor_at(millis()).flame ? HIGH : LOW;
+  }
+  return LOW;
+}
+
+void digitalWrite(uint8_t, uint8_t) {}
+
+// 인터럽트는 트레이스에서 불꽃 값이 바뀌는 행의 시각에 맞춰 깨어나는 스레드가 흉내 낸다.
+// 스레드 깨어남 지연(보통 수십 us)이 실제 보드의 인터럽트 지연 자리에 들어간다.
+static std::atomic<unsigned> s_isr_gen{0};
+
+static void flame_irq_thread(unsigned gen, void (*isr)(void), int mode) {
+  pthread_setname_np(pthread_self(), "gpio_isr");
+  uint32_t from = millis();
+  int level = camsim_sensor_at(from).flame;
+  for (const trace_row &row : s_trace) {
+    if (row.ms <= from || row.sample.flame == level) {
+      continue;
+    }
+    level = row.sample.flame;
+    std::this_thread::sleep_until(s_boot + std::chrono::milliseconds(row.ms));
+    if (s_isr_gen != gen) {
+      return;
+    }
+    if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) {
+      isr();
+    }
+  }
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+  if (pin != CAMSIM_FLAME_PIN || !isr) {
+    return;
+  }
+  std::thread(flame_irq_thread, ++s_isr_gen, isr, mode).detach();
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin == CAMSIM_FLAME_PIN) {
+    s_isr_gen++;
+  }
+}
+
+// ===========================
+// WiFi
+// ===========================
+// 시뮬레이션의 AP. 채널은 --wifi-channel 로 바꿀 수 있다 (AP 가 채널을 옮긴 경우).
+static const uint8_t s_ap_bssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+
+bool WiFiClass::mode(wifi_mode_t) {
+  return true;
+}
+
+void WiFiClass::persistent(bool) {
+}
+
+bool WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1) {
+  if (_static_ip && !(uint32_t)local_ip && isConnected()) {
+    _dhcp_at_us = esp_timer_get_time() + (int64_t)g_camsim.dhcp_ms * 1000;
+  }
+  _static_ip = local_ip;
+  _static_gw = gateway;
+  _static_mask = subnet;
+  _static_dns = dns1;
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char *, const char *, int32_t channel, const uint8_t *bssid, bool connect) {
+  if (!connect) {
+    return WL_DISCONNECTED;
+  }
+  bool known = channel > 0 && bssid;
+  _wrong_ap = known && (channel != g_camsim.wifi_channel || memcmp(bssid, s_ap_bssid, 6));
+  int ms = (known ? 0 : g_camsim.wifi_scan_ms) + g_camsim.wifi_assoc_ms + (_static_ip ? 0 : g_camsim.dhcp_ms);
+  _connect_at_us = esp_timer_get_time() + (int64_t)ms * 1000;
+  return WL_DISCONNECTED;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+  _connect_at_us = -1;
+  return true;
+}
+
+bool WiFiClass::setSleep(bool) {
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  if (_connect_at_us < 0) {
+    return WL_IDLE_STATUS;
+  }
+  if (esp_timer_get_time() < _connect_at_us) {
+    return WL_DISCONNECTED;
+  }
+  // 캐시한 채널/BSSID 에 AP 가 없으면 드라이버는 그 BSSID 만 찾다가 실패한다.
+  return _wrong_ap ? WL_NO_SSID_AVAIL : WL_CONNECTED;
+}
+
+bool WiFiClass::isConnected() {
+  return status() == WL_CONNECTED;
+}
+
+IPAddress WiFiClass::localIP() {
+  if (status() != WL_CONNECTED || esp_timer_get_time() < _dhcp_at_us) {
+    return IPAddress();
+  }
+  return _static_ip ? IPAddress(_static_ip) : IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  if (status() != WL_CONNECTED) {
+    return IPAddress();
+  }
+  return _static_ip ? IPAddress(_static_gw) : IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::subnetMask() {
+  if (status() != WL_CONNECTED) {
+    return IPAddress();
+  }
+  return _static_ip ? IPAddress(_static_mask) : IPAddress(255, 0, 0, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t) {
+  if (status() != WL_CONNECTED) {
+    return IPAddress();
+  }
+  return _static_ip ? IPAddress(_static_dns) : IPAddress(127, 0, 0, 1);
+}
+
+uint8_t *WiFiClass::BSSID() {
+  static uint8_t bssid[6];
+  if (status() != WL_CONNECTED) {
+    return NULL;
+  }
+  memcpy(bssid, s_ap_bssid, 6);
+  return bssid;
+}
+
+int32_t WiFiClass::channel() {
+  return status() == WL_CONNECTED ? g_camsim.wifi_channel : 0;
+}
+
+// ===========================
+// Preferences (NVS)
+// ===========================
+// "네임스페이스/키" -> 값. --nvs 파일에는 [이름 길이][이름][값 길이][값] 을 이어서 쓴다.
+static std::mutex s_nvs_lock;
+static std::map<std::string, std::string> s_nvs;
+static bool s_nvs_loaded;
+
+static void nvs_load_locked(void) {
+  if (s_nvs_loaded) {
+    return;
+  }
+  s_nvs_loaded = true;
+  FILE *f = g_camsim.nvs_path ? fopen(g_camsim.nvs_path, "rb") : NULL;
+  if (!f) {
+    return;
+  }
+  uint32_t len;
+  while (fread(&len, 4, 1, f) == 1) {
+    std::string key(len, 0);
+    if (fread(&key[0], 1, len, f) != len || fread(&len, 4, 1, f) != 1) {
+      break;
+    }
+    std::string value(len, 0);
+    if (fread(&value[0], 1, len, f) != len) {
+      break;
+    }
+    s_nvs[key] = value;
+  }
+  fclose(f);
+}
+
+static void nvs_save_locked(void) {
+  FILE *f = g_camsim.nvs_path ? fopen(g_camsim.nvs_path, "wb") : NULL;
+  if (!f) {
+    return;
+  }
+  for (const auto &kv : s_nvs) {
+    uint32_t len = kv.first.size();
+    fwrite(&len, 4, 1, f);
+    fwrite(kv.first.data(), 1, len, f);
+    len = kv.second.size();
+    fwrite(&len, 4, 1, f);
+    fwrite(kv.second.data(), 1, len, f);
+  }
+  fclose(f);
+}
+
+bool Preferences::begin(const char *name, bool readOnly) {
+  std::lock_guard<std::mutex> lock(s_nvs_lock);
+  nvs_load_locked();
+  _ns = name;
+  _open = true;
+  _readonly = readOnly;
+  return true;
+}
+
+void Preferences::end() {
+  _open = false;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!_open || _readonly) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(s_nvs_lock);
+  s_nvs[_ns + "/" + key] = std::string((const char *)value, len);
+  nvs_save_locked();
+  return len;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  std::lock_guard<std::mutex> lock(s_nvs_lock);
+  auto it = s_nvs.find(_ns + "/" + key);
+  return _open && it != s_nvs.end() ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  std::lock_guard<std::mutex> lock(s_nvs_lock);
+  auto it = s_nvs.find(_ns + "/" + key);
+  if (!_open || it == s_nvs.end() || it->second.size() > maxLen) {
+    return 0;
+  }
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+bool Preferences::remove(const char *key) {
+  if (!_open || _readonly) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(s_nvs_lock);
+  bool found = s_nvs.erase(_ns + "/" + key) > 0;
+  nvs_save_locked();
+  return found;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+  return (esp_reset_reason_t)g_camsim.reset_reason;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  if (caps & MALLOC_CAP_SPIRAM) {
+    return g_camsim.psram ? 3700000 : 0;
+  }
+  return 170000;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  if (caps & MALLOC_CAP_SPIRAM) {
+    return g_camsim.psram ? 3600000 : 0;
+  }
+  return 110592;
+}
@@ -0,0 +1,593 @@
+// esp32-camera 드라이버의 호스트용 가짜 구현
+// 캡처 스레드가 센서 프레임 주기마다 빈 프레임 버퍼를 채우고, esp_camera_fb_get() 은 채워진 버퍼를
+// 기다린다. 버퍼 수(fb_count)와 grab_mode 에 따른 경쟁은 실제 드라이버와 같은 방식으로 일어난다.
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "camsim.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+const resolution_info_t resolution[FRAMESIZE_INVALID] = {
+  {96, 96, ASPECT_RATIO_1X1},     /* 96x96 */
+  {160, 120, ASPECT_RATIO_4X3},   /* QQVGA */
+  {176, 144, ASPECT_RATIO_5X4},   /* QCIF  */
+  {240, 176, ASPECT_RATIO_4X3},   /* HQVGA */
+  {240, 240, ASPECT_RATIO_1X1},   /* 240x240 */
+  {320, 240, ASPECT_RATIO_4X3},   /* QVGA  */
+  {400, 296, ASPECT_RATIO_4X3},   /* CIF   */
+  {480, 320, ASPECT_RATIO_3X2},   /* HVGA  */
+  {640, 480, ASPECT_RATIO_4X3},   /* VGA   */
+  {800, 600, ASPECT_RATIO_4X3},   /* SVGA  */
+  {1024, 768, ASPECT_RATIO_4X3},  /* XGA   */
+  {1280, 720, ASPECT_RATIO_16X9}, /* HD    */
+  {1280, 1024, ASPECT_RATIO_5X4}, /* SXGA  */
+  {1600, 1200, ASPECT_RATIO_4X3}, /* UXGA  */
+  {1920, 1080, ASPECT_RATIO_16X9}, /* FHD   */
+  {720, 1280, ASPECT_RATIO_9X16}, /* Portrait HD   */
+  {864, 1536, ASPECT_RATIO_9X16}, /* Portrait 3MP   */
+  {2048, 1536, ASPECT_RATIO_4X3}, /* QXGA  */
+  {2560, 1440, ASPECT_RATIO_16X9}, /* QHD    */
+  {2560, 1600, ASPECT_RATIO_16X10}, /* WQXGA  */
+  {1088, 1920, ASPECT_RATIO_9X16}, /* Portrait FHD   */
+  {2560, 1920, ASPECT_RATIO_4X3}, /* QSXGA  */
+};
+
+// 합성 패턴은 이 개수의 프레임을 반복한다.
+#define SYNTH_FRAMES 50
+// 실제 드라이버의 FB_GET_TIMEOUT 과 같다.
+#define FB_GET_TIMEOUT_MS 4000
+// 해상도/포맷을 바꾸면 센서가 안정될 때까지 버리는 프레임 수
+#define SETTLE_FRAMES 2
+
+enum fb_state { FB_FREE, FB_READY, FB_IN_USE };
+
+struct sim_fb {
+  camera_fb_t fb;
+  std::vector<uint8_t> data;
+  fb_state state;
+};
+
+static std::mutex s_lock;
+static std::condition_variable s_ready_cv;
+static std::vector<sim_fb> s_fbs;
+static std::deque<size_t> s_ready;  // 채워졌지만 아직 가져가지 않은 버퍼 (오래된 순)
+static camera_grab_mode_t s_grab_mode;
+static sensor_t s_sensor;
+static uint16_t s_out_w, s_out_h;
+static int s_settle;
+static bool s_running;
+static std::vector<std::vector<uint8_t>> s_sources;  // --frames 폴더의 JPEG 원본
+
+// 같은 원본/설정으로 다시 만들 때 인코딩을 반복하지 않기 위한 캐시
+typedef std::tuple<size_t, uint16_t, uint16_t, int, int> frame_key;
+static std::map<frame_key, std::vector<uint8_t>> s_cache;
+
+// ===========================
+// 프레임 원본
+// ===========================
+static void load_sources(const char *dir) {
+  DIR *d = opendir(dir);
+  if (!d) {
+    fprintf(stderr, "camsim: cannot open frames dir %s\n", dir);
+    exit(1);
+  }
+  std::vector<std::string> names;
+  while (struct dirent *e = readdir(d)) {
+    const char *ext = strrchr(e->d_name, '.');
+    if (ext && (!strcasecmp(ext, ".jpg") || !strcasecmp(ext, ".jpeg"))) {
+      names.push_back(std::string(dir) + "/" + e->d_name);
+    }
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  for (const std::string &name : names) {
+    FILE *f = fopen(name.c_str(), "rb");
+    if (!f) {
+      continue;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+      bytes.insert(bytes.end(), buf, buf + n);
+    }
+    fclose(f);
+    s_sources.push_back(std::move(bytes));
+  }
+  if (s_sources.empty()) {
+    fprintf(stderr, "camsim: no JPEG files in %s\n", dir);
+    exit(1);
+  }
+}
+
+static inline uint32_t hash32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  x *= 0x846ca68b;
+  x ^= x >> 16;
+  return x;
+}
+
+// 컬러 바 위로 밝은 띠가 지나가는 합성 패턴. JPEG 크기가 실제 장면과 비슷하도록 잡음을 섞는다.
+static void synth_rgb(size_t index, int w, int h, std::vector<uint8_t> &rgb) {
+  static const uint8_t bars[8][3] = {
+    {255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+    {255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {32, 32, 32},
+  };
+  rgb.resize((size_t)w * h * 3);
+  int band = (int)(index * w / SYNTH_FRAMES);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      const uint8_t *c = bars[x * 8 / w];
+      int noise = (int)(hash32((uint32_t)(y * w + x) ^ (uint32_t)(index * 2654435761u)) & 15) - 8;
+      int boost = abs(x - band) < w / 20 ? 64 : 0;
+      uint8_t *o = &rgb[((size_t)y * w + x) * 3];
+      for (int k = 0; k < 3; k++) {
+        int v = c[k] * 3 / 4 + noise + boost;
+        o[k] = v < 0 ? 0 : (v > 255 ? 255 : v);
+      }
+    }
+  }
+}
+
+static void scale_rgb(const std::vector<uint8_t> &src, int sw, int sh, int w, int h, std::vector<uint8_t> &dst) {
+  dst.resize((size_t)w * h * 3);
+  for (int y = 0; y < h; y++) {
+    const uint8_t *row = &src[(size_t)(y * sh / h) * sw * 3];
+    for (int x = 0; x < w; x++) {
+      memcpy(&dst[((size_t)y * w + x) * 3], row + (size_t)(x * sw / w) * 3, 3);
+    }
+  }
+}
+
+// esp32-camera 의 품질(0~63, 낮을수록 고화질)을 libjpeg 품질로 옮긴다.
+static int libjpeg_quality(int q) {
+  int lq = 100 - q * 3 / 2;
+  return lq < 1 ? 1 : (lq > 100 ? 100 : lq);
+}
+
+static const std::vector<uint8_t> &produce_frame(size_t index, uint16_t w, uint16_t h, pixformat_t format, int quality) {
+  frame_key key(index, w, h, format, format == PIXFORMAT_JPEG ? quality : 0);
+  auto it = s_cache.find(key);
+  if (it != s_cache.end()) {
+    return it->second;
+  }
+  if (s_cache.size() > 512) {
+    s_cache.clear();
+  }
+  std::vector<uint8_t> rgb, scaled, out;
+  if (s_sources.empty()) {
+    synth_rgb(index, w, h, scaled);
+  } else {
+    int sw = 0, sh = 0;
+    const std::vector<uint8_t> &jpg = s_sources[index];
+    if (!camsim_jpeg_decode(jpg.data(), jpg.size(), 1, rgb, &sw, &sh)) {
+      fprintf(stderr, "camsim: failed to decode source frame %zu\n", index);
+      rgb.assign(3, 0);
+      sw = sh = 1;
+    }
+    scale_rgb(rgb, sw, sh, w, h, scaled);
+  }
+  if (format == PIXFORMAT_JPEG) {
+    camsim_jpeg_encode(scaled.data(), w, h, libjpeg_quality(quality), out);
+  } else {
+    camsim_from_rgb(scaled.data(), w, h, format, out);
+  }
+  return s_cache.emplace(key, std::move(out)).first->second;
+}
+
+// ===========================
+// 캡처 스레드
+// ===========================
+static int64_t frame_period_us() {
+  int64_t period = 1000000 / (g_camsim.fps > 0 ? g_camsim.fps : 25);
+  // SVGA 를 넘으면 센서가 UXGA 모드로 바뀌어 프레임 속도가 절반이 된다.
+  if (s_out_w > 800) {
+    period *= 2;
+  }
+  if (s_sensor.xclk_freq_hz > 0) {
+    period = period * 20000000LL / s_sensor.xclk_freq_hz;
+  }
+  return period;
+}
+
+static void capture_task() {
+  size_t index = 0;
+  int64_t next = esp_timer_get_time();
+  std::unique_lock<std::mutex> lock(s_lock);
+  while (s_running) {
+    next += frame_period_us();
+    int64_t now = esp_timer_get_time();
+    if (next < now) {
+      next = now;
+    }
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+    lock.lock();
+
+    size_t count = s_sources.empty() ? SYNTH_FRAMES : s_sources.size();
+    size_t src = index++ % count;
+    if (s_settle > 0) {
+      s_settle--;
+      continue;
+    }
+    uint16_t w = s_out_w, h = s_out_h;
+    pixformat_t format = s_sensor.pixformat;
+    int quality = s_sensor.status.quality;
+
+    // 인코딩은 잠금 밖에서 한다 (캐시는 이 스레드만 사용).
+    lock.unlock();
+    const std::vector<uint8_t> &bytes = produce_frame(src, w, h, format, quality);
+    lock.lock();
+
+    // 빈 버퍼를 찾고, 없으면 GRAB_LATEST 일 때만 가장 오래된 대기 프레임을 덮어쓴다.
+    sim_fb *target = nullptr;
+    for (sim_fb &f : s_fbs) {
+      if (f.state == FB_FREE) {
+        target = &f;
+        break;
+      }
+    }
+    if (!target && s_grab_mode == CAMERA_GRAB_LATEST && !s_ready.empty()) {
+      target = &s_fbs[s_ready.front()];
+      s_ready.pop_front();
+    }
+    if (!target) {
+      continue;  // 드라이버가 프레임을 놓친다.
+    }
+
+    target->data.assign(bytes.begin(), bytes.end());
+    target->fb.buf = target->data.data();
+    target->fb.len = target->data.size();
+    target->fb.width = w;
+    target->fb.height = h;
+    target->fb.format = format;
+    int64_t ts = esp_timer_get_time();
+    target->fb.timestamp.tv_sec = ts / 1000000;
+    target->fb.timestamp.tv_usec = ts % 1000000;
+    target->state = FB_READY;
+    s_ready.push_back(target - s_fbs.data());
+    s_ready_cv.notify_one();
+  }
+}
+
+camera_fb_t *esp_camera_fb_get(void) {
+  std::unique_lock<std::mutex> lock(s_lock);
+  if (!s_running) {
+    return NULL;
+  }
+  if (!s_ready_cv.wait_for(lock, std::chrono::milliseconds(FB_GET_TIMEOUT_MS), [] { return !s_ready.empty(); })) {
+    return NULL;
+  }
+  sim_fb &f = s_fbs[s_ready.front()];
+  s_ready.pop_front();
+  f.state = FB_IN_USE;
+  return &f.fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb) {
+  if (!fb) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  for (sim_fb &f : s_fbs) {
+    if (&f.fb == fb) {
+      f.state = FB_FREE;
+      return;
+    }
+  }
+}
+
+sensor_t *esp_camera_sensor_get(void) {
+  return s_running ? &s_sensor : NULL;
+}
+
+// ===========================
+// 가짜 센서 (레지스터 맵 + 상태)
+// ===========================
+static uint8_t s_regs[0x10000];
+
+void camsim_sccb_delay(void) {
+  if (g_camsim.sccb_us > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(g_camsim.sccb_us));
+  }
+}
+
+static int sccb_read(int reg) {
+  camsim_sccb_delay();
+  return s_regs[reg & 0xFFFF];
+}
+
+static void sccb_write(int reg, int value) {
+  camsim_sccb_delay();
+  s_regs[reg & 0xFFFF] = (uint8_t)value;
+}
+
+// 단순 설정 함수는 실제 드라이버처럼 레지스터 두어 개를 건드린다고 본다.
+static int touch_regs(int count) {
+  for (int i = 0; i < count; i++) {
+    camsim_sccb_delay();
+  }
+  return 0;
+}
+
+static int get_reg(sensor_t *sensor, int reg, int mask) {
+  int ret;
+  if (sensor->id.PID == OV2640_PID) {
+    // 실제 드라이버처럼 마지막으로 고른 뱅크를 기억해, 바뀔 때만 뱅크 선택 레지스터를 쓴다.
+    static int bank = -1;
+    if (((reg >> 8) & 0x01) != bank) {
+      bank = (reg >> 8) & 0x01;
+      sccb_write(0xFF, bank);
+    }
+    ret = sccb_read(reg);
+  } else if (mask > 0xFF) {
+    ret = (sccb_read(reg) << 8) | sccb_read(reg + 1);
+    if (mask > 0xFFFF) {
+      ret = (ret << 8) | sccb_read(reg + 2);
+    }
+  } else {
+    ret = sccb_read(reg);
+  }
+  if (ret > 0) {
+    ret &= mask;
+  }
+  return ret;
+}
+
+static int set_reg(sensor_t *sensor, int reg, int mask, int value) {
+  int ret = get_reg(sensor, reg, mask > 0xFF ? mask : 0xFF);
+  if (ret < 0) {
+    return ret;
+  }
+  value = (ret & ~mask) | (value & mask);
+  if (mask > 0xFFFF) {
+    sccb_write(reg, value >> 16);
+    sccb_write(reg + 1, value >> 8);
+    sccb_write(reg + 2, value);
+  } else if (mask > 0xFF) {
+    sccb_write(reg, value >> 8);
+    sccb_write(reg + 1, value);
+  } else {
+    sccb_write(reg, value);
+  }
+  return 0;
+}
+
+static framesize_t max_framesize() {
+  switch (s_sensor.id.PID) {
+    case OV5640_PID: return FRAMESIZE_QSXGA;
+    case OV3660_PID: return FRAMESIZE_QXGA;
+    default: return FRAMESIZE_UXGA;
+  }
+}
+
+static int set_framesize(sensor_t *sensor, framesize_t framesize) {
+  if (framesize > max_framesize()) {
+    return -1;
+  }
+  // 해상도 테이블을 통째로 다시 쓰므로 SCCB 트랜잭션이 많다.
+  touch_regs(40);
+  std::lock_guard<std::mutex> lock(s_lock);
+  sensor->status.framesize = framesize;
+  s_out_w = resolution[framesize].width;
+  s_out_h = resolution[framesize].height;
+  s_settle = SETTLE_FRAMES;
+  return 0;
+}
+
+static int set_pixformat(sensor_t *sensor, pixformat_t pixformat) {
+  switch (pixformat) {
+    case PIXFORMAT_RGB565:
+    case PIXFORMAT_YUV422:
+    case PIXFORMAT_GRAYSCALE:
+    case PIXFORMAT_JPEG:
+    case PIXFORMAT_RGB888:
+      break;
+    default:
+      return -1;
+  }
+  touch_regs(6);
+  std::lock_guard<std::mutex> lock(s_lock);
+  sensor->pixformat = pixformat;
+  s_settle = SETTLE_FRAMES;
+  return 0;
+}
+
+static int set_quality(sensor_t *sensor, int quality) {
+  touch_regs(1);
+  sensor->status.quality = quality;
+  return 0;
+}
+
+#define SIMPLE_SETTER(name, field, type, regs) \
+  static int name(sensor_t *sensor, type value) { \
+    touch_regs(regs);                            \
+    sensor->status.field = value;                \
+    return 0;                                    \
+  }
+
+SIMPLE_SETTER(set_contrast, contrast, int, 3)
+SIMPLE_SETTER(set_brightness, brightness, int, 3)
+SIMPLE_SETTER(set_saturation, saturation, int, 3)
+SIMPLE_SETTER(set_sharpness, sharpness, int, 2)
+SIMPLE_SETTER(set_denoise, denoise, int, 2)
+SIMPLE_SETTER(set_gainceiling, gainceiling, gainceiling_t, 2)
+SIMPLE_SETTER(set_colorbar, colorbar, int, 2)
+SIMPLE_SETTER(set_whitebal, awb, int, 2)
+SIMPLE_SETTER(set_gain_ctrl, agc, int, 2)
+SIMPLE_SETTER(set_exposure_ctrl, aec, int, 2)
+SIMPLE_SETTER(set_hmirror, hmirror, int, 2)
+SIMPLE_SETTER(set_vflip, vflip, int, 2)
+SIMPLE_SETTER(set_aec2, aec2, int, 2)
+SIMPLE_SETTER(set_awb_gain, awb_gain, int, 2)
+SIMPLE_SETTER(set_agc_gain, agc_gain, int, 2)
+SIMPLE_SETTER(set_aec_value, aec_value, int, 3)
+SIMPLE_SETTER(set_special_effect, special_effect, int, 4)
+SIMPLE_SETTER(set_wb_mode, wb_mode, int, 4)
+SIMPLE_SETTER(set_ae_level, ae_level, int, 3)
+SIMPLE_SETTER(set_dcw, dcw, int, 2)
+SIMPLE_SETTER(set_bpc, bpc, int, 2)
+SIMPLE_SETTER(set_wpc, wpc, int, 2)
+SIMPLE_SETTER(set_raw_gma, raw_gma, int, 2)
+SIMPLE_SETTER(set_lenc, lenc, int, 2)
+
+static int set_res_raw(sensor_t *sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                       int totalX, int totalY, int outputX, int outputY, bool scale, bool binning) {
+  if (outputX <= 0 || outputY <= 0 || outputX > 4096 || outputY > 4096) {
+    return -1;
+  }
+  touch_regs(24);
+  std::lock_guard<std::mutex> lock(s_lock);
+  sensor->status.scale = scale;
+  sensor->status.binning = binning;
+  s_out_w = outputX;
+  s_out_h = outputY;
+  s_settle = SETTLE_FRAMES;
+  return 0;
+}
+
+static int set_pll(sensor_t *, int, int, int, int, int, int, int, int) {
+  touch_regs(8);
+  return 0;
+}
+
+static int set_xclk(sensor_t *sensor, int, int xclk) {
+  if (xclk <= 0 || xclk > 40) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  sensor->xclk_freq_hz = xclk * 1000000;
+  return 0;
+}
+
+static int init_status(sensor_t *sensor) {
+  sensor->status.brightness = 0;
+  sensor->status.contrast = 0;
+  sensor->status.saturation = 0;
+  sensor->status.sharpness = 0;
+  sensor->status.denoise = 0;
+  sensor->status.ae_level = 0;
+  sensor->status.gainceiling = GAINCEILING_2X;
+  sensor->status.awb = 1;
+  sensor->status.awb_gain = 1;
+  sensor->status.aec = 1;
+  sensor->status.aec2 = 0;
+  sensor->status.aec_value = 300;
+  sensor->status.agc = 1;
+  sensor->status.agc_gain = 0;
+  sensor->status.bpc = 0;
+  sensor->status.wpc = 1;
+  sensor->status.raw_gma = 1;
+  sensor->status.lenc = 1;
+  sensor->status.hmirror = 0;
+  sensor->status.vflip = 0;
+  sensor->status.dcw = 1;
+  sensor->status.colorbar = 0;
+  sensor->status.special_effect = 0;
+  sensor->status.wb_mode = 0;
+  return 0;
+}
+
+static int reset(sensor_t *sensor) {
+  touch_regs(64);
+  return init_status(sensor);
+}
+
+// ===========================
+// 초기화
+// ===========================
+esp_err_t esp_camera_init(const camera_config_t *config) {
+  if (s_running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (config->fb_count < 1 || config->frame_size >= FRAMESIZE_INVALID) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (config->fb_location == CAMERA_FB_IN_PSRAM && !g_camsim.psram) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (g_camsim.frames_dir && s_sources.empty()) {
+    load_sources(g_camsim.frames_dir);
+  }
+
+  memset(&s_sensor, 0, sizeof(s_sensor));
+  s_sensor.id.MIDH = 0x7F;
+  s_sensor.id.MIDL = 0xA2;
+  s_sensor.id.PID = g_camsim.sensor_pid;
+  s_sensor.slv_addr = g_camsim.sensor_pid == OV2640_PID ? 0x30 : 0x3C;
+  s_sensor.xclk_freq_hz = config->xclk_freq_hz;
+  s_sensor.pixformat = g_camsim.pixformat >= 0 ? (pixformat_t)g_camsim.pixformat : config->pixel_format;
+  s_sensor.status.framesize = config->frame_size;
+  s_sensor.status.quality = config->jpeg_quality;
+  s_sensor.init_status = init_status;
+  s_sensor.reset = reset;
+  s_sensor.set_pixformat = set_pixformat;
+  s_sensor.set_framesize = set_framesize;
+  s_sensor.set_contrast = set_contrast;
+  s_sensor.set_brightness = set_brightness;
+  s_sensor.set_saturation = set_saturation;
+  s_sensor.set_sharpness = set_sharpness;
+  s_sensor.set_denoise = set_denoise;
+  s_sensor.set_gainceiling = set_gainceiling;
+  s_sensor.set_quality = set_quality;
+  s_sensor.set_colorbar = set_colorbar;
+  s_sensor.set_whitebal = set_whitebal;
+  s_sensor.set_gain_ctrl = set_gain_ctrl;
+  s_sensor.set_exposure_ctrl = set_exposure_ctrl;
+  s_sensor.set_hmirror = set_hmirror;
+  s_sensor.set_vflip = set_vflip;
+  s_sensor.set_aec2 = set_aec2;
+  s_sensor.set_awb_gain = set_awb_gain;
+  s_sensor.set_agc_gain = set_agc_gain;
+  s_sensor.set_aec_value = set_aec_value;
+  s_sensor.set_special_effect = set_special_effect;
+  s_sensor.set_wb_mode = set_wb_mode;
+  s_sensor.set_ae_level = set_ae_level;
+  s_sensor.set_dcw = set_dcw;
+  s_sensor.set_bpc = set_bpc;
+  s_sensor.set_wpc = set_wpc;
+  s_sensor.set_raw_gma = set_raw_gma;
+  s_sensor.set_lenc = set_lenc;
+  s_sensor.get_reg = get_reg;
+  s_sensor.set_reg = set_reg;
+  s_sensor.set_res_raw = set_res_raw;
+  s_sensor.set_pll = set_pll;
+  s_sensor.set_xclk = set_xclk;
+  init_status(&s_sensor);
+  s_out_w = resolution[config->frame_size].width;
+  s_out_h = resolution[config->frame_size].height;
+
+  s_fbs = std::vector<sim_fb>(config->fb_count);
+  for (sim_fb &f : s_fbs) {
+    f.state = FB_FREE;
+  }
+  s_ready.clear();
+  s_grab_mode = config->grab_mode;
+  s_settle = 0;
+  s_running = true;
+  // 센서 감지와 레지스터 초기화에 걸리는 시간
+  touch_regs(200);
+  std::thread(capture_task).detach();
+  return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit(void) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  s_running = false;
+  s_ready_cv.notify_all();
+  return ESP_OK;
+}
@@ -0,0 +1,134 @@
+// esp_timer 타이머 API 의 호스트용 가짜 구현
+// ESP-IDF 처럼 "esp_timer" 스레드 하나가 만료 시각 순서대로 콜백을 부른다.
+// esp_timer_get_time() 은 fake_arduino.cpp 에 있다.
+#include "esp_timer.h"
+
+#include <pthread.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  int64_t alarm_us;   // 다음 만료 시각 (0: 멈춤)
+  uint64_t period_us; // 0 이면 한 번만
+  esp_timer *next;    // 만료 시각 순 목록
+};
+
+static std::mutex s_lock;
+static std::condition_variable s_cv;
+static esp_timer *s_list = nullptr;
+static bool s_started = false;
+
+static void unlink_locked(esp_timer *t) {
+  for (esp_timer **p = &s_list; *p; p = &(*p)->next) {
+    if (*p == t) {
+      *p = t->next;
+      break;
+    }
+  }
+  t->next = nullptr;
+  t->alarm_us = 0;
+}
+
+static void insert_locked(esp_timer *t, int64_t alarm_us) {
+  t->alarm_us = alarm_us;
+  esp_timer **p = &s_list;
+  while (*p && (*p)->alarm_us <= alarm_us) {
+    p = &(*p)->next;
+  }
+  t->next = *p;
+  *p = t;
+  s_cv.notify_all();
+}
+
+static void timer_thread(void) {
+  pthread_setname_np(pthread_self(), "esp_timer");
+  std::unique_lock<std::mutex> lock(s_lock);
+  for (;;) {
+    if (!s_list) {
+      s_cv.wait(lock);
+      continue;
+    }
+    int64_t now = esp_timer_get_time();
+    esp_timer *t = s_list;
+    if (t->alarm_us > now) {
+      s_cv.wait_for(lock, std::chrono::microseconds(t->alarm_us - now));
+      continue;
+    }
+    unlink_locked(t);
+    if (t->period_us) {
+      insert_locked(t, now + t->period_us);
+    }
+    // 콜백 안에서 다시 start/stop 할 수 있도록 잠금을 풀고 부른다.
+    lock.unlock();
+    t->callback(t->arg);
+    lock.lock();
+  }
+}
+
+extern "C" esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+  if (!create_args || !create_args->callback || !out_handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (!s_started) {
+    std::thread(timer_thread).detach();
+    s_started = true;
+  }
+  *out_handle = new esp_timer{create_args->callback, create_args->arg, 0, 0, nullptr};
+  return ESP_OK;
+}
+
+static esp_err_t start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (timer->alarm_us) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->period_us = period_us;
+  // alarm_us 0 은 "멈춤" 이므로 최소 1us 뒤로 잡는다.
+  insert_locked(timer, esp_timer_get_time() + (int64_t)(timeout_us ? timeout_us : 1));
+  return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  return start(timer, timeout_us, 0);
+}
+
+extern "C" esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+  return start(timer, period, period);
+}
+
+extern "C" esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (!timer->alarm_us) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  unlink_locked(timer);
+  return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (timer->alarm_us) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  delete timer;
+  return ESP_OK;
+}
+
+extern "C" bool esp_timer_is_active(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  return timer && timer->alarm_us != 0;
+}
@@ -0,0 +1,150 @@
+// FreeRTOS 태스크/세마포어 API 의 호스트용 가짜 구현 (태스크 하나 = POSIX 스레드 하나)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct sim_task {
+  TaskFunction_t fn;
+  void *arg;
+  BaseType_t core;
+  char name[16];
+};
+
+static thread_local sim_task *t_current = nullptr;
+
+static void *task_entry(void *p) {
+  sim_task *task = (sim_task *)p;
+  t_current = task;
+  task->fn(task->arg);
+  // FreeRTOS 에서 태스크 함수가 그냥 반환하는 것은 오류지만, 호스트에서는 스레드 종료로 처리한다.
+  return nullptr;
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t,
+                                              void *pvParameters, UBaseType_t, TaskHandle_t *pvCreatedTask,
+                                              BaseType_t xCoreID) {
+  sim_task *task = new sim_task{pvTaskCode, pvParameters, xCoreID, {0}};
+  strncpy(task->name, pcName ? pcName : "", sizeof(task->name) - 1);
+
+  pthread_t th;
+  if (pthread_create(&th, nullptr, task_entry, task) != 0) {
+    delete task;
+    return pdFAIL;
+  }
+  pthread_setname_np(th, task->name);
+  // 코어 고정은 호스트 CPU 가 둘 이상일 때만 흉내 낸다.
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  if (xCoreID != tskNO_AFFINITY && ncpu > 1) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(xCoreID % ncpu, &set);
+    pthread_setaffinity_np(th, sizeof(set), &set);
+  }
+  pthread_detach(th);
+  if (pvCreatedTask) {
+    *pvCreatedTask = task;
+  }
+  return pdPASS;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t xTaskToDelete) {
+  if (xTaskToDelete == nullptr || xTaskToDelete == t_current) {
+    pthread_exit(nullptr);
+  }
+  // 다른 태스크를 강제로 지우는 기능은 스케치에서 쓰지 않는다.
+}
+
+extern "C" void vTaskDelay(TickType_t xTicksToDelay) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+extern "C" BaseType_t xTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement) {
+  *pxPreviousWakeTime += xTimeIncrement;
+  TickType_t now = xTaskGetTickCount();
+  // FreeRTOS 와 같이 이미 지난 시각이면 기다리지 않고 pdFALSE 를 돌려준다.
+  if ((int32_t)(*pxPreviousWakeTime - now) <= 0) {
+    return pdFALSE;
+  }
+  vTaskDelay(*pxPreviousWakeTime - now);
+  return pdTRUE;
+}
+
+extern "C" TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return t_current;
+}
+
+extern "C" char *pcTaskGetName(TaskHandle_t xTaskToQuery) {
+  static char main_name[] = "main";
+  sim_task *task = xTaskToQuery ? xTaskToQuery : t_current;
+  return task ? task->name : main_name;  // 태스크로 만들지 않은 스레드 (호스트 main 등)
+}
+
+extern "C" BaseType_t xPortGetCoreID(void) {
+  if (t_current && t_current->core != tskNO_AFFINITY) {
+    return t_current->core;
+  }
+  // Arduino 의 loopTask 와 같이 고정되지 않은 스레드는 코어 1 로 본다.
+  return 1;
+}
+
+// ===========================
+// 세마포어
+// ===========================
+struct sim_semaphore {
+  std::mutex lock;
+  std::condition_variable cv;
+  UBaseType_t count;
+  UBaseType_t max;
+};
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+  sim_semaphore *sem = new sim_semaphore();
+  sem->count = uxInitialCount;
+  sem->max = uxMaxCount;
+  return sem;
+}
+
+extern "C" BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+  std::unique_lock<std::mutex> lock(xSemaphore->lock);
+  auto available = [xSemaphore] { return xSemaphore->count > 0; };
+  if (xBlockTime == portMAX_DELAY) {
+    xSemaphore->cv.wait(lock, available);
+  } else if (!xSemaphore->cv.wait_for(lock, std::chrono::milliseconds(xBlockTime * portTICK_PERIOD_MS), available)) {
+    return pdFALSE;
+  }
+  xSemaphore->count--;
+  return pdTRUE;
+}
+
+extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+  std::lock_guard<std::mutex> lock(xSemaphore->lock);
+  if (xSemaphore->count >= xSemaphore->max) {
+    return pdFALSE;
+  }
+  xSemaphore->count++;
+  xSemaphore->cv.notify_one();
+  return pdTRUE;
+}
+
+extern "C" UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore) {
+  std::lock_guard<std::mutex> lock(xSemaphore->lock);
+  return xSemaphore->count;
+}
+
+extern "C" void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) {
+  delete xSemaphore;
+}
@@ -0,0 +1,1166 @@
+// esp_http_server 의 호스트용 구현 (POSIX 소켓)
+// ESP-IDF 와 같이 서버마다 태스크 하나가 select 로 모든 세션을 돌며, 요청 하나를 읽으면 그 태스크
+// 안에서 핸들러를 끝까지 실행한다. 따라서 끝나지 않는 핸들러(/stream)는 같은 서버의 다른 요청을 막는다.
+// 헤더/청크 전송도 ESP-IDF 의 httpd_txrx.c 와 같은 단위로 나누어 보낸다.
+#include "esp_http_server.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "camsim.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define RECV_CHUNK 1460
+#define SIM_TCP_SND_BUF 5760  // CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+
+struct sim_session {
+  int fd;
+  std::string inbuf;
+  int64_t last_used;
+  bool async_busy;  // 비동기 핸들러가 소켓을 쓰는 동안 select 에서 뺀다
+  bool ws = false;  // WebSocket 핸드셰이크를 마친 세션
+  httpd_uri_t ws_uri = {};
+  httpd_send_func_t send_fn = nullptr;  // httpd_sess_set_send_override 로 바꾼 송신 함수
+  void *transport_ctx = nullptr;
+  httpd_free_func_t transport_ctx_free = nullptr;
+};
+
+struct sim_server {
+  httpd_config_t cfg;
+  int listen_fd;
+  int ctrl_pipe[2];
+  std::vector<httpd_uri_t> uris;
+  std::deque<std::string> uri_names;  // push_back 해도 c_str() 이 유지된다
+  std::vector<sim_session *> sessions;
+  std::mutex sessions_lock;  // 다른 태스크에서 세션을 찾을 때. 목록을 바꾸는 쪽은 서버 태스크뿐이다.
+  std::mutex work_lock;
+  std::deque<std::pair<httpd_work_fn_t, void *>> work;
+  std::atomic<bool> running;
+  std::mutex done_lock;
+  std::condition_variable done_cv;
+  bool done;
+};
+
+// 보드의 lwIP 소켓 수. 모든 서버의 listen/ctrl 소켓과 세션을 센다.
+static std::atomic<int> s_lwip_sockets{0};
+
+struct sim_req_aux {
+  sim_server *server;
+  sim_session *sess;
+  std::vector<std::pair<std::string, std::string>> req_hdrs;
+  size_t body_remaining;
+  const char *status;
+  const char *content_type;
+  std::vector<std::pair<const char *, const char *>> resp_hdrs;
+  bool headers_sent;
+  bool chunked;
+  bool close_after;
+  // 읽는 중인 WebSocket 프레임
+  bool ws_hdr_read = false;
+  bool ws_payload_read = false;
+  httpd_ws_type_t ws_type = HTTPD_WS_TYPE_CONTINUE;
+  bool ws_final = false;
+  bool ws_masked = false;
+  uint8_t ws_mask[4] = {};
+  size_t ws_len = 0;
+  size_t ws_left = 0;  // 아직 읽지 않은 본문 바이트 수
+};
+
+// ===========================
+// 소켓 송신
+// ===========================
+static int send_all(int fd, const char *buf, size_t len) {
+  size_t sent = 0;
+  while (sent < len) {
+    ssize_t n = send(fd, buf + sent, len - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    sent += n;
+  }
+  return (int)sent;
+}
+
+// ESP-IDF 의 httpd_send_all 처럼 세션의 송신 함수를 다 보낼 때까지 부른다.
+static int sess_send_all(sim_server *server, sim_session *sess, const char *buf, size_t len) {
+  if (!sess->send_fn) {
+    return send_all(sess->fd, buf, len);
+  }
+  size_t sent = 0;
+  while (sent < len) {
+    int n = sess->send_fn(server, sess->fd, buf + sent, len - sent, 0);
+    if (n < 0) {
+      return n;
+    }
+    sent += n;
+  }
+  return (int)sent;
+}
+
+static esp_err_t req_send(httpd_req_t *r, const char *buf, size_t len) {
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  if (len == 0) {
+    return ESP_OK;
+  }
+  if (sess_send_all(aux->server, aux->sess, buf, len) < 0) {
+    aux->close_after = true;
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  return ESP_OK;
+}
+
+// 상태 줄과 기본 헤더를 한 번에 보내고, 사용자 헤더는 ESP-IDF 처럼 조각마다 따로 보낸다.
+static esp_err_t send_headers(httpd_req_t *r, const char *length_hdr) {
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  char head[256];
+  int n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n%s", aux->status, aux->content_type, length_hdr);
+  if (req_send(r, head, n) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_HDR;
+  }
+  for (auto &h : aux->resp_hdrs) {
+    if (req_send(r, h.first, strlen(h.first)) != ESP_OK || req_send(r, ": ", 2) != ESP_OK ||
+        req_send(r, h.second, strlen(h.second)) != ESP_OK || req_send(r, "\r\n", 2) != ESP_OK) {
+      return ESP_ERR_HTTPD_RESP_HDR;
+    }
+  }
+  if (req_send(r, "\r\n", 2) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_HDR;
+  }
+  aux->headers_sent = true;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+  if (!r || !r->aux) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (buf_len == HTTPD_RESP_USE_STRLEN) {
+    buf_len = buf ? strlen(buf) : 0;
+  }
+  char len_hdr[48];
+  snprintf(len_hdr, sizeof(len_hdr), "Content-Length: %d\r\n", (int)buf_len);
+  esp_err_t err = send_headers(r, len_hdr);
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (buf && buf_len && req_send(r, buf, buf_len) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+  if (!r || !r->aux) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  if (buf_len == HTTPD_RESP_USE_STRLEN) {
+    buf_len = buf ? strlen(buf) : 0;
+  }
+  if (!aux->headers_sent) {
+    aux->chunked = true;
+    esp_err_t err = send_headers(r, "Transfer-Encoding: chunked\r\n");
+    if (err != ESP_OK) {
+      return err;
+    }
+  }
+  char len_str[10];
+  snprintf(len_str, sizeof(len_str), "%x\r\n", (unsigned)buf_len);
+  if (req_send(r, len_str, strlen(len_str)) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  if (buf && buf_len && req_send(r, buf, buf_len) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  if (req_send(r, "\r\n", 2) != ESP_OK) {
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *usr_msg) {
+  const char *status, *msg;
+  switch (error) {
+    case HTTPD_501_METHOD_NOT_IMPLEMENTED: status = "501 Method Not Implemented"; msg = "Request method is not supported by server"; break;
+    case HTTPD_505_VERSION_NOT_SUPPORTED: status = "505 Version Not Supported"; msg = "HTTP version not supported by server"; break;
+    case HTTPD_400_BAD_REQUEST: status = "400 Bad Request"; msg = "Bad request syntax"; break;
+    case HTTPD_401_UNAUTHORIZED: status = "401 Unauthorized"; msg = "No permission -- see authorization schemes"; break;
+    case HTTPD_403_FORBIDDEN: status = "403 Forbidden"; msg = "Request forbidden -- authorization will not help"; break;
+    case HTTPD_404_NOT_FOUND: status = "404 Not Found"; msg = "Nothing matches the given URI"; break;
+    case HTTPD_405_METHOD_NOT_ALLOWED: status = "405 Method Not Allowed"; msg = "Specified method is invalid for this resource"; break;
+    case HTTPD_408_REQ_TIMEOUT: status = "408 Request Timeout"; msg = "Server closed this connection"; break;
+    case HTTPD_411_LENGTH_REQUIRED: status = "411 Length Required"; msg = "Client must specify Content-Length"; break;
+    case HTTPD_414_URI_TOO_LONG: status = "414 URI Too Long"; msg = "URI is too long"; break;
+    case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE: status = "431 Request Header Fields Too Large"; msg = "Header fields are too long"; break;
+    case HTTPD_500_INTERNAL_SERVER_ERROR:
+    default: status = "500 Internal Server Error"; msg = "Server has encountered an unexpected error"; break;
+  }
+  if (usr_msg) {
+    msg = usr_msg;
+  }
+  httpd_resp_set_status(req, status);
+  httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+  return httpd_resp_send(req, msg, strlen(msg));
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+  if (!r || !r->aux || !status) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ((sim_req_aux *)r->aux)->status = status;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+  if (!r || !r->aux || !type) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ((sim_req_aux *)r->aux)->content_type = type;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+  if (!r || !r->aux || !field || !value) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  if (aux->resp_hdrs.size() >= aux->server->cfg.max_resp_headers) {
+    return ESP_ERR_HTTPD_RESP_HDR;
+  }
+  aux->resp_hdrs.emplace_back(field, value);
+  return ESP_OK;
+}
+
+// ===========================
+// 요청 정보
+// ===========================
+int httpd_req_to_sockfd(httpd_req_t *r) {
+  if (!r || !r->aux) {
+    return -1;
+  }
+  return ((sim_req_aux *)r->aux)->sess->fd;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  if (aux->body_remaining == 0) {
+    return 0;
+  }
+  size_t want = std::min(buf_len, aux->body_remaining);
+  std::string &in = aux->sess->inbuf;
+  if (!in.empty()) {
+    size_t n = std::min(want, in.size());
+    memcpy(buf, in.data(), n);
+    in.erase(0, n);
+    aux->body_remaining -= n;
+    return (int)n;
+  }
+  ssize_t n = recv(aux->sess->fd, buf, want, 0);
+  if (n < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+  }
+  if (n == 0) {
+    return HTTPD_SOCK_ERR_FAIL;
+  }
+  aux->body_remaining -= n;
+  return (int)n;
+}
+
+static const std::string *find_hdr(httpd_req_t *r, const char *field) {
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  for (auto &h : aux->req_hdrs) {
+    if (!strcasecmp(h.first.c_str(), field)) {
+      return &h.second;
+    }
+  }
+  return nullptr;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field) {
+  const std::string *v = find_hdr(r, field);
+  return v ? v->size() : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size) {
+  const std::string *v = find_hdr(r, field);
+  if (!v) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  if (val_size == 0) {
+    return ESP_ERR_HTTPD_RESULT_TRUNC;
+  }
+  size_t n = std::min(v->size(), val_size - 1);
+  memcpy(val, v->data(), n);
+  val[n] = 0;
+  return v->size() + 1 > val_size ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r) {
+  const char *q = strchr(r->uri, '?');
+  return q ? strlen(q + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len) {
+  const char *q = strchr(r->uri, '?');
+  if (!q) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  q++;
+  size_t len = strlen(q);
+  if (buf_len == 0) {
+    return ESP_ERR_HTTPD_RESULT_TRUNC;
+  }
+  size_t n = std::min(len, buf_len - 1);
+  memcpy(buf, q, n);
+  buf[n] = 0;
+  return len + 1 > buf_len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size) {
+  if (!qry || !key || !val) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const char *qry_ptr = qry;
+  const size_t key_len = strlen(key);
+  while (strlen(qry_ptr)) {
+    const char *val_ptr = strchr(qry_ptr, '=');
+    if (!val_ptr) {
+      break;
+    }
+    size_t offset = val_ptr - qry_ptr;
+    if (offset != key_len || strncasecmp(qry_ptr, key, offset)) {
+      qry_ptr = strchr(val_ptr, '&');
+      if (!qry_ptr) {
+        break;
+      }
+      qry_ptr++;
+      continue;
+    }
+    val_ptr++;
+    const char *end = strchr(val_ptr, '&');
+    size_t val_len = end ? (size_t)(end - val_ptr) : strlen(val_ptr);
+    if (val_size == 0) {
+      return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    size_t n = std::min(val_len, val_size - 1);
+    memcpy(val, val_ptr, n);
+    val[n] = 0;
+    return val_size < val_len + 1 ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool httpd_uri_match_wildcard(const char *tpl, const char *uri, size_t len) {
+  const size_t tpl_len = strlen(tpl);
+  size_t exact_match_chars = tpl_len;
+  const char last = (const char)(tpl_len > 0 ? tpl[tpl_len - 1] : 0);
+  const char prevlast = (const char)(tpl_len > 1 ? tpl[tpl_len - 2] : 0);
+  const bool asterisk = last == '*' || (prevlast == '*' && last == '?');
+  const bool quest = last == '?' || (prevlast == '?' && last == '*');
+  if (exact_match_chars < (size_t)(asterisk + quest * 2)) {
+    return false;
+  }
+  exact_match_chars -= asterisk + quest * 2;
+  if (len < exact_match_chars) {
+    return false;
+  }
+  if (!quest) {
+    if (!asterisk && len != exact_match_chars) {
+      return false;
+    }
+    return strncmp(tpl, uri, exact_match_chars) == 0;
+  }
+  if (len > exact_match_chars && tpl[exact_match_chars] != uri[exact_match_chars]) {
+    return false;
+  }
+  if (strncmp(tpl, uri, exact_match_chars) != 0) {
+    return false;
+  }
+  return asterisk || len <= exact_match_chars + 1;
+}
+
+// ===========================
+// 세션 / 요청 처리
+// ===========================
+static void close_session(sim_server *server, sim_session *sess);
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out) {
+  if (!r || !r->aux || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  httpd_req_t *copy = (httpd_req_t *)malloc(sizeof(httpd_req_t));
+  sim_req_aux *aux = new sim_req_aux(*(sim_req_aux *)r->aux);
+  if (!copy) {
+    delete aux;
+    return ESP_ERR_NO_MEM;
+  }
+  memcpy((void *)copy, r, sizeof(httpd_req_t));
+  copy->aux = aux;
+  aux->sess->async_busy = true;
+  *out = copy;
+  return ESP_OK;
+}
+
+struct async_done_work {
+  sim_server *server;
+  sim_session *sess;
+  bool close;
+};
+
+static void async_done_fn(void *arg) {
+  async_done_work *w = (async_done_work *)arg;
+  auto &list = w->server->sessions;
+  if (std::find(list.begin(), list.end(), w->sess) != list.end()) {
+    w->sess->async_busy = false;
+    w->sess->last_used = esp_timer_get_time();
+    if (w->close) {
+      close_session(w->server, w->sess);
+    }
+  }
+  delete w;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r) {
+  if (!r || !r->aux) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_req_aux *aux = (sim_req_aux *)r->aux;
+  // 세션 목록은 서버 태스크만 건드리므로 정리는 작업 큐로 넘긴다.
+  esp_err_t err = httpd_queue_work(aux->server, async_done_fn, new async_done_work{aux->server, aux->sess, aux->close_after});
+  delete aux;
+  free(r);
+  return err;
+}
+
+static void close_session(sim_server *server, sim_session *sess) {
+  {
+    std::lock_guard<std::mutex> lock(server->sessions_lock);
+    auto it = std::find(server->sessions.begin(), server->sessions.end(), sess);
+    if (it != server->sessions.end()) {
+      server->sessions.erase(it);
+    }
+  }
+  if (sess->transport_ctx && sess->transport_ctx_free) {
+    sess->transport_ctx_free(sess->transport_ctx);
+  }
+  if (server->cfg.close_fn) {
+    server->cfg.close_fn(server, sess->fd);
+  } else {
+    close(sess->fd);
+  }
+  s_lwip_sockets--;
+  delete sess;
+}
+
+static int parse_method(const char *m) {
+  static const struct {
+    const char *name;
+    int method;
+  } methods[] = {
+    {"GET", HTTP_GET}, {"POST", HTTP_POST}, {"PUT", HTTP_PUT}, {"DELETE", HTTP_DELETE},
+    {"HEAD", HTTP_HEAD}, {"OPTIONS", HTTP_OPTIONS},
+  };
+  for (auto &e : methods) {
+    if (!strcmp(m, e.name)) {
+      return e.method;
+    }
+  }
+  return -1;
+}
+
+// ===========================
+// WebSocket (RFC 6455)
+// ===========================
+static void sha1(const uint8_t *data, size_t len, uint8_t out[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  std::string msg((const char *)data, len);
+  msg += (char)0x80;
+  while (msg.size() % 64 != 56) {
+    msg += (char)0;
+  }
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 7; i >= 0; i--) {
+    msg += (char)(bits >> (i * 8));
+  }
+  auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+  for (size_t off = 0; off < msg.size(); off += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t *p = (const uint8_t *)msg.data() + off + i * 4;
+      w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+    for (int i = 16; i < 80; i++) {
+      w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d), k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d, k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d, k = 0xCA62C1D6;
+      }
+      uint32_t t = rol(a, 5) + f + e + k + w[i];
+      e = d, d = c, c = rol(b, 30), b = a, a = t;
+    }
+    h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+  }
+  for (int i = 0; i < 20; i++) {
+    out[i] = (uint8_t)(h[i / 4] >> (24 - (i % 4) * 8));
+  }
+}
+
+static std::string base64(const uint8_t *data, size_t len) {
+  static const char tbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)data[i] << 16 | (i + 1 < len ? data[i + 1] << 8 : 0) | (i + 2 < len ? data[i + 2] : 0);
+    out += tbl[(v >> 18) & 63];
+    out += tbl[(v >> 12) & 63];
+    out += i + 1 < len ? tbl[(v >> 6) & 63] : '=';
+    out += i + 2 < len ? tbl[v & 63] : '=';
+  }
+  return out;
+}
+
+// 세션 입력 버퍼에 남은 것부터 읽고, 모자라면 소켓에서 막혀 가며 읽는다.
+static bool sess_read_exact(sim_session *sess, uint8_t *buf, size_t len) {
+  size_t n = std::min(len, sess->inbuf.size());
+  memcpy(buf, sess->inbuf.data(), n);
+  sess->inbuf.erase(0, n);
+  while (n < len) {
+    ssize_t r = recv(sess->fd, buf + n, len - n, 0);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      return false;
+    }
+    n += r;
+  }
+  return true;
+}
+
+static esp_err_t ws_read_header(sim_req_aux *aux) {
+  uint8_t hdr[2];
+  if (!sess_read_exact(aux->sess, hdr, 2)) {
+    return ESP_FAIL;
+  }
+  aux->ws_final = hdr[0] & 0x80;
+  aux->ws_type = (httpd_ws_type_t)(hdr[0] & 0x0F);
+  aux->ws_masked = hdr[1] & 0x80;
+  aux->ws_len = hdr[1] & 0x7F;
+  if (aux->ws_len >= 126) {
+    uint8_t ext[8];
+    size_t n = aux->ws_len == 126 ? 2 : 8;
+    if (!sess_read_exact(aux->sess, ext, n)) {
+      return ESP_FAIL;
+    }
+    aux->ws_len = 0;
+    for (size_t i = 0; i < n; i++) {
+      aux->ws_len = aux->ws_len << 8 | ext[i];
+    }
+  }
+  if (aux->ws_masked && !sess_read_exact(aux->sess, aux->ws_mask, 4)) {
+    return ESP_FAIL;
+  }
+  aux->ws_left = aux->ws_len;
+  aux->ws_hdr_read = true;
+  aux->ws_payload_read = false;
+  return ESP_OK;
+}
+
+// ESP-IDF 와 같이 pkt->len 이 0 이면 헤더부터 읽어 본문 길이를 채우고, 0 이 아니면 이미 헤더를
+// 읽은 것으로 보고 본문을 pkt->len 바이트만 읽는다. 그래서 긴 본문도 여러 번에 나눠 읽을 수 있다.
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len) {
+  if (!req || !req->aux || !pkt) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_req_aux *aux = (sim_req_aux *)req->aux;
+  if (pkt->len == 0 || !aux->ws_hdr_read) {
+    if (!aux->ws_hdr_read && ws_read_header(aux) != ESP_OK) {
+      return ESP_FAIL;
+    }
+    pkt->final = aux->ws_final;
+    pkt->fragmented = !aux->ws_final || aux->ws_type == HTTPD_WS_TYPE_CONTINUE;
+    pkt->type = aux->ws_type;
+    pkt->len = aux->ws_left;
+    if (max_len == 0) {
+      return ESP_OK;
+    }
+  }
+  if (pkt->len > aux->ws_left) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!pkt->payload || max_len < pkt->len) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (!sess_read_exact(aux->sess, pkt->payload, pkt->len)) {
+    return ESP_FAIL;
+  }
+  if (aux->ws_masked) {
+    size_t off = aux->ws_len - aux->ws_left;
+    for (size_t i = 0; i < pkt->len; i++) {
+      pkt->payload[i] ^= aux->ws_mask[(off + i) % 4];
+    }
+  }
+  aux->ws_left -= pkt->len;
+  if (aux->ws_left == 0) {
+    aux->ws_hdr_read = false;
+    aux->ws_payload_read = true;
+  }
+  return ESP_OK;
+}
+
+// 서버가 보내는 프레임은 마스크를 쓰지 않는다. 헤더와 본문을 따로 보내는 것은 ESP-IDF 와 같다.
+static esp_err_t ws_send(int fd, httpd_ws_frame_t *frame) {
+  uint8_t hdr[10];
+  size_t n = 2;
+  hdr[0] = (frame->final || !frame->fragmented ? 0x80 : 0) | (frame->type & 0x0F);
+  if (frame->len < 126) {
+    hdr[1] = (uint8_t)frame->len;
+  } else if (frame->len < 65536) {
+    hdr[1] = 126;
+    hdr[2] = (uint8_t)(frame->len >> 8);
+    hdr[3] = (uint8_t)frame->len;
+    n = 4;
+  } else {
+    hdr[1] = 127;
+    for (int i = 0; i < 8; i++) {
+      hdr[2 + i] = (uint8_t)((uint64_t)frame->len >> (56 - i * 8));
+    }
+    n = 10;
+  }
+  if (send_all(fd, (const char *)hdr, n) < 0) {
+    return ESP_FAIL;
+  }
+  if (frame->len && send_all(fd, (const char *)frame->payload, frame->len) < 0) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt) {
+  if (!req || !req->aux || !pkt) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return ws_send(((sim_req_aux *)req->aux)->sess->fd, pkt);
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame) {
+  if (!hd || !frame) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return ws_send(fd, frame);
+}
+
+static bool ws_is_upgrade(httpd_req_t *req) {
+  const std::string *upgrade = find_hdr(req, "Upgrade");
+  return upgrade && !strcasecmp(upgrade->c_str(), "websocket") && find_hdr(req, "Sec-WebSocket-Key");
+}
+
+static bool ws_respond_handshake(httpd_req_t *req, const httpd_uri_t *uri) {
+  std::string key = *find_hdr(req, "Sec-WebSocket-Key") + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t digest[20];
+  sha1((const uint8_t *)key.data(), key.size(), digest);
+  std::string resp = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n";
+  const std::string *proto = find_hdr(req, "Sec-WebSocket-Protocol");
+  if (proto && uri->supported_subprotocol && strstr(proto->c_str(), uri->supported_subprotocol)) {
+    resp += std::string("Sec-WebSocket-Protocol: ") + uri->supported_subprotocol + "\r\n";
+  }
+  resp += "\r\n";
+  return req_send(req, resp.data(), resp.size()) == ESP_OK;
+}
+
+// 핸드셰이크를 마친 세션에서 프레임 하나를 처리한다. false 를 반환하면 세션을 닫는다.
+// handle_ws_control_frames 가 꺼져 있으면 PING/PONG/CLOSE 는 핸들러에 넘기지 않고 여기서 처리한다.
+static bool ws_process_frame(sim_server *server, sim_session *sess) {
+  httpd_req_t *req = (httpd_req_t *)calloc(1, sizeof(httpd_req_t));
+  sim_req_aux aux{server, sess, {}, 0, HTTPD_200, HTTPD_TYPE_TEXT, {}, true, false, false};
+  req->handle = server;
+  req->aux = &aux;
+  req->method = 0;
+  strncpy((char *)req->uri, sess->ws_uri.uri, HTTPD_MAX_URI_LEN);
+  req->user_ctx = sess->ws_uri.user_ctx;
+
+  bool keep = ws_read_header(&aux) == ESP_OK;
+  if (keep && aux.ws_type >= HTTPD_WS_TYPE_CLOSE && !sess->ws_uri.handle_ws_control_frames) {
+    uint8_t payload[125];
+    httpd_ws_frame_t frame = {};
+    frame.payload = payload;
+    keep = aux.ws_len <= sizeof(payload) && httpd_ws_recv_frame(req, &frame, sizeof(payload)) == ESP_OK;
+    if (keep && frame.type == HTTPD_WS_TYPE_PING) {
+      frame.type = HTTPD_WS_TYPE_PONG;
+      keep = ws_send(sess->fd, &frame) == ESP_OK;
+    } else if (keep && frame.type == HTTPD_WS_TYPE_CLOSE) {
+      frame.len = std::min<size_t>(frame.len, 2);  // 상태 코드만 돌려준다
+      ws_send(sess->fd, &frame);
+      keep = false;
+    }
+  } else if (keep) {
+    keep = sess->ws_uri.handler(req) == ESP_OK;
+    if (keep && !sess->async_busy && !aux.ws_payload_read) {
+      // 핸들러가 읽지 않은 본문은 버린다.
+      uint8_t discard[256];
+      size_t left = aux.ws_left;
+      while (keep && left > 0) {
+        size_t n = std::min(left, sizeof(discard));
+        keep = sess_read_exact(sess, discard, n);
+        left -= n;
+      }
+    }
+  }
+  free(req);
+  sess->last_used = esp_timer_get_time();
+  return keep;
+}
+
+// 헤더 블록 하나를 처리한다. false 를 반환하면 세션을 닫는다.
+static bool process_request(sim_server *server, sim_session *sess, size_t hdr_end) {
+  std::string head = sess->inbuf.substr(0, hdr_end);
+  sess->inbuf.erase(0, hdr_end + 4);
+
+  // 요청 구조체는 ESP-IDF 와 같이 매 요청마다 새로 만든다.
+  httpd_req_t *req = (httpd_req_t *)calloc(1, sizeof(httpd_req_t));
+  sim_req_aux aux{server, sess, {}, 0, HTTPD_200, HTTPD_TYPE_TEXT, {}, false, false, false};
+  req->handle = server;
+  req->aux = &aux;
+
+  size_t line_end = head.find("\r\n");
+  std::string line = head.substr(0, line_end);
+  char method[16] = {0}, uri[HTTPD_MAX_URI_LEN + 2] = {0}, version[16] = {0};
+  bool ok = sscanf(line.c_str(), "%15s %513s %15s", method, uri, version) == 3;
+  if (ok && strlen(uri) > HTTPD_MAX_URI_LEN) {
+    httpd_resp_send_err(req, HTTPD_414_URI_TOO_LONG, NULL);
+    free(req);
+    return false;
+  }
+  strcpy((char *)req->uri, uri);
+  req->method = parse_method(method);
+
+  size_t pos = line_end == std::string::npos ? head.size() : line_end + 2;
+  while (pos < head.size()) {
+    size_t end = head.find("\r\n", pos);
+    if (end == std::string::npos) {
+      end = head.size();
+    }
+    size_t colon = head.find(':', pos);
+    if (colon != std::string::npos && colon < end) {
+      size_t vstart = head.find_first_not_of(' ', colon + 1);
+      aux.req_hdrs.emplace_back(head.substr(pos, colon - pos), vstart < end ? head.substr(vstart, end - vstart) : "");
+    }
+    pos = end + 2;
+  }
+  const std::string *cl = find_hdr(req, "Content-Length");
+  req->content_len = cl ? strtoul(cl->c_str(), NULL, 10) : 0;
+  aux.body_remaining = req->content_len;
+  const std::string *conn = find_hdr(req, "Connection");
+  aux.close_after = conn && !strcasecmp(conn->c_str(), "close");
+
+  if (!ok || req->method < 0) {
+    httpd_resp_send_err(req, ok ? HTTPD_501_METHOD_NOT_IMPLEMENTED : HTTPD_400_BAD_REQUEST, NULL);
+    free(req);
+    return false;
+  }
+
+  // URI 매칭은 '?' 앞부분까지만 본다.
+  size_t match_len = strcspn(req->uri, "?#");
+  const httpd_uri_t *found = nullptr;
+  bool uri_matched = false;
+  for (const httpd_uri_t &u : server->uris) {
+    bool match = server->cfg.uri_match_fn ? server->cfg.uri_match_fn(u.uri, req->uri, match_len)
+                                          : (strlen(u.uri) == match_len && !strncmp(u.uri, req->uri, match_len));
+    if (match) {
+      uri_matched = true;
+      if (u.method == req->method) {
+        found = &u;
+        break;
+      }
+    }
+  }
+
+  esp_err_t ret;
+  if (!found) {
+    httpd_resp_send_err(req, uri_matched ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND, NULL);
+    ret = ESP_FAIL;
+  } else {
+    req->user_ctx = found->user_ctx;
+    if (found->is_websocket && req->method == HTTP_GET && ws_is_upgrade(req)) {
+      // ESP-IDF 와 같이 핸드셰이크 응답을 보낸 뒤 핸들러를 GET 으로 한 번 부른다.
+      if (!ws_respond_handshake(req, found)) {
+        free(req);
+        return false;
+      }
+      sess->ws = true;
+      sess->ws_uri = *found;
+    }
+    ret = found->handler(req);
+  }
+
+  if (sess->async_busy) {
+    // 응답은 다른 태스크가 이어서 쓴다. 세션은 httpd_req_async_handler_complete() 때 돌려받는다.
+    free(req);
+    return true;
+  }
+  // 핸들러가 읽지 않은 본문은 버린다.
+  char discard[256];
+  while (aux.body_remaining > 0 && httpd_req_recv(req, discard, sizeof(discard)) > 0) {
+  }
+  bool keep = ret == ESP_OK && !aux.close_after;
+  free(req);
+  sess->last_used = esp_timer_get_time();
+  return keep;
+}
+
+static void session_readable(sim_server *server, sim_session *sess) {
+  char buf[RECV_CHUNK];
+  ssize_t n = recv(sess->fd, buf, sizeof(buf), 0);
+  if (n <= 0) {
+    close_session(server, sess);
+    return;
+  }
+  sess->inbuf.append(buf, n);
+  while (sess->ws && !sess->async_busy && !sess->inbuf.empty()) {
+    if (!ws_process_frame(server, sess)) {
+      close_session(server, sess);
+      return;
+    }
+  }
+  size_t hdr_end;
+  while (!sess->ws && !sess->async_busy && (hdr_end = sess->inbuf.find("\r\n\r\n")) != std::string::npos) {
+    if (!process_request(server, sess, hdr_end)) {
+      close_session(server, sess);
+      return;
+    }
+  }
+  if (sess->inbuf.size() > HTTPD_MAX_REQ_HDR_LEN * 4) {
+    close_session(server, sess);
+  }
+}
+
+static void accept_session(sim_server *server) {
+  int fd = accept(server->listen_fd, NULL, NULL);
+  if (fd < 0) {
+    return;
+  }
+  // lwIP 는 소켓을 잡지 못하면 httpd 가 세션 수를 보기 전에 accept 에서 실패한다 (LRU 정리도 못 함).
+  if (s_lwip_sockets >= CONFIG_LWIP_MAX_SOCKETS) {
+    fprintf(stderr, "camsim: httpd port %u accept failed: all %d lwIP sockets in use\n", server->cfg.server_port,
+            CONFIG_LWIP_MAX_SOCKETS);
+    close(fd);
+    return;
+  }
+  if (server->sessions.size() >= server->cfg.max_open_sockets) {
+    if (!server->cfg.lru_purge_enable) {
+      close(fd);
+      return;
+    }
+    sim_session *lru = nullptr;
+    for (sim_session *s : server->sessions) {
+      if (!s->async_busy && (!lru || s->last_used < lru->last_used)) {
+        lru = s;
+      }
+    }
+    if (!lru) {
+      close(fd);
+      return;
+    }
+    close_session(server, lru);
+  }
+  struct timeval tv;
+  tv.tv_sec = server->cfg.recv_wait_timeout;
+  tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  tv.tv_sec = server->cfg.send_wait_timeout;
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  // 송신 버퍼를 lwIP 의 TCP_SND_BUF 기본값 정도로 줄여, 느린 클라이언트에서 보드처럼 send 가 막히게 한다.
+  int sndbuf = SIM_TCP_SND_BUF;
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  if (server->cfg.open_fn && server->cfg.open_fn(server, fd) != ESP_OK) {
+    close(fd);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(server->sessions_lock);
+  server->sessions.push_back(new sim_session{fd, std::string(), esp_timer_get_time(), false});
+  s_lwip_sockets++;
+}
+
+static void run_work(sim_server *server) {
+  char drain[64];
+  while (read(server->ctrl_pipe[0], drain, sizeof(drain)) > 0) {
+  }
+  std::deque<std::pair<httpd_work_fn_t, void *>> todo;
+  {
+    std::lock_guard<std::mutex> lock(server->work_lock);
+    todo.swap(server->work);
+  }
+  for (auto &w : todo) {
+    w.first(w.second);
+  }
+}
+
+static void server_task(void *arg) {
+  sim_server *server = (sim_server *)arg;
+  while (server->running) {
+    fd_set rd;
+    FD_ZERO(&rd);
+    FD_SET(server->listen_fd, &rd);
+    FD_SET(server->ctrl_pipe[0], &rd);
+    int maxfd = std::max(server->listen_fd, server->ctrl_pipe[0]);
+    for (sim_session *s : server->sessions) {
+      if (!s->async_busy) {
+        FD_SET(s->fd, &rd);
+        maxfd = std::max(maxfd, s->fd);
+      }
+    }
+    if (select(maxfd + 1, &rd, NULL, NULL, NULL) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (FD_ISSET(server->ctrl_pipe[0], &rd)) {
+      run_work(server);
+    }
+    // 핸들러 안에서 세션 목록이 바뀔 수 있으므로 복사본을 돈다.
+    std::vector<sim_session *> ready;
+    for (sim_session *s : server->sessions) {
+      if (!s->async_busy && FD_ISSET(s->fd, &rd)) {
+        ready.push_back(s);
+      }
+    }
+    for (sim_session *s : ready) {
+      if (std::find(server->sessions.begin(), server->sessions.end(), s) != server->sessions.end()) {
+        session_readable(server, s);
+      }
+    }
+    if (FD_ISSET(server->listen_fd, &rd)) {
+      accept_session(server);
+    }
+  }
+  while (!server->sessions.empty()) {
+    close_session(server, server->sessions.back());
+  }
+  std::lock_guard<std::mutex> lock(server->done_lock);
+  server->done = true;
+  server->done_cv.notify_all();
+}
+
+// ===========================
+// 서버 수명 / 작업 큐
+// ===========================
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) {
+  if (!handle || !config) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (config->max_open_sockets > CONFIG_LWIP_MAX_SOCKETS - 3) {
+    fprintf(stderr, "camsim: httpd max_open_sockets %u exceeds CONFIG_LWIP_MAX_SOCKETS - 3\n",
+            (unsigned)config->max_open_sockets);
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_server *server = new sim_server();
+  server->cfg = *config;
+  server->running = true;
+  server->done = false;
+
+  int port = config->server_port + g_camsim.port_offset;
+  server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(server->listen_fd, config->backlog_conn) < 0) {
+    fprintf(stderr, "camsim: httpd cannot listen on port %d: %s\n", port, strerror(errno));
+    close(server->listen_fd);
+    delete server;
+    return ESP_ERR_HTTPD_TASK;
+  }
+  if (pipe(server->ctrl_pipe) < 0) {
+    close(server->listen_fd);
+    delete server;
+    return ESP_ERR_HTTPD_TASK;
+  }
+  fcntl(server->ctrl_pipe[0], F_SETFL, O_NONBLOCK);
+  fprintf(stderr, "camsim: httpd port %u listening on %d\n", config->server_port, port);
+
+  if (xTaskCreatePinnedToCore(server_task, "httpd", config->stack_size, server, config->task_priority, NULL,
+                              config->core_id) != pdPASS) {
+    close(server->listen_fd);
+    close(server->ctrl_pipe[0]);
+    close(server->ctrl_pipe[1]);
+    delete server;
+    return ESP_ERR_HTTPD_TASK;
+  }
+  s_lwip_sockets += 2;  // listen 소켓과 ctrl 소켓
+  *handle = server;
+  return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+  sim_server *server = (sim_server *)handle;
+  if (!server) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  server->running = false;
+  (void)!write(server->ctrl_pipe[1], "x", 1);
+  {
+    std::unique_lock<std::mutex> lock(server->done_lock);
+    server->done_cv.wait(lock, [server] { return server->done; });
+  }
+  close(server->listen_fd);
+  close(server->ctrl_pipe[0]);
+  close(server->ctrl_pipe[1]);
+  s_lwip_sockets -= 2;
+  if (server->cfg.global_user_ctx_free_fn) {
+    server->cfg.global_user_ctx_free_fn(server->cfg.global_user_ctx);
+  }
+  delete server;
+  return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler) {
+  sim_server *server = (sim_server *)handle;
+  if (!server || !uri_handler) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (const httpd_uri_t &u : server->uris) {
+    if (!strcmp(u.uri, uri_handler->uri) && u.method == uri_handler->method) {
+      return ESP_ERR_HTTPD_HANDLER_EXISTS;
+    }
+  }
+  if (server->uris.size() >= server->cfg.max_uri_handlers) {
+    return ESP_ERR_HTTPD_HANDLERS_FULL;
+  }
+  // 호출자의 uri 문자열 수명에 기대지 않도록 복사해 둔다.
+  server->uri_names.push_back(uri_handler->uri);
+  httpd_uri_t copy = *uri_handler;
+  copy.uri = server->uri_names.back().c_str();
+  server->uris.push_back(copy);
+  return ESP_OK;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg) {
+  sim_server *server = (sim_server *)handle;
+  if (!server || !work) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  {
+    std::lock_guard<std::mutex> lock(server->work_lock);
+    server->work.emplace_back(work, arg);
+  }
+  if (write(server->ctrl_pipe[1], "w", 1) != 1) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+struct close_work {
+  sim_server *server;
+  int fd;
+};
+
+static void close_work_fn(void *arg) {
+  close_work *w = (close_work *)arg;
+  for (sim_session *s : w->server->sessions) {
+    if (s->fd == w->fd) {
+      close_session(w->server, s);
+      break;
+    }
+  }
+  delete w;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+  if (!handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return httpd_queue_work(handle, close_work_fn, new close_work{(sim_server *)handle, sockfd});
+}
+
+// 세션의 송신 함수와 transport ctx. 스트림 전송 태스크처럼 서버 밖의 태스크도 부를 수 있다.
+static sim_session *find_session_locked(sim_server *server, int sockfd) {
+  for (sim_session *s : server->sessions) {
+    if (s->fd == sockfd) {
+      return s;
+    }
+  }
+  return nullptr;
+}
+
+esp_err_t httpd_sess_set_send_override(httpd_handle_t hd, int sockfd, httpd_send_func_t send_func) {
+  if (!hd) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sim_server *server = (sim_server *)hd;
+  std::lock_guard<std::mutex> lock(server->sessions_lock);
+  sim_session *sess = find_session_locked(server, sockfd);
+  if (!sess) {
+    return ESP_FAIL;
+  }
+  sess->send_fn = send_func;
+  return ESP_OK;
+}
+
+void *httpd_sess_get_transport_ctx(httpd_handle_t handle, int sockfd) {
+  if (!handle) {
+    return NULL;
+  }
+  sim_server *server = (sim_server *)handle;
+  std::lock_guard<std::mutex> lock(server->sessions_lock);
+  sim_session *sess = find_session_locked(server, sockfd);
+  return sess ? sess->transport_ctx : NULL;
+}
+
+void httpd_sess_set_transport_ctx(httpd_handle_t handle, int sockfd, void *ctx, httpd_free_func_t free_fn) {
+  if (!handle) {
+    return;
+  }
+  sim_server *server = (sim_server *)handle;
+  std::lock_guard<std::mutex> lock(server->sessions_lock);
+  sim_session *sess = find_session_locked(server, sockfd);
+  if (!sess) {
+    return;
+  }
+  if (sess->transport_ctx && sess->transport_ctx_free && sess->transport_ctx != ctx) {
+    sess->transport_ctx_free(sess->transport_ctx);
+  }
+  sess->transport_ctx = ctx;
+  sess->transport_ctx_free = free_fn;
+}
+
+int httpd_socket_send(httpd_handle_t, int sockfd, const char *buf, size_t buf_len, int flags) {
+  ssize_t n = send(sockfd, buf, buf_len, flags | MSG_NOSIGNAL);
+  if (n < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+  }
+  return (int)n;
+}
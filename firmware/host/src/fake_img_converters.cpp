@@ -0,0 +1,373 @@
+// img_converters.h 의 호스트용 구현 (libjpeg 사용)
+// 버퍼 배치는 esp32-camera 와 같게 맞춘다: RGB888 은 B,G,R 순서, RGB565 는 빅엔디언.
+#include "img_converters.h"
+#include "esp_jpg_decode.h"
+#include "camsim.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jpeglib.h>
+
+// ===========================
+// libjpeg 래퍼
+// ===========================
+struct camsim_jpeg_err {
+  jpeg_error_mgr pub;
+  jmp_buf jump;
+};
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+  camsim_jpeg_err *err = (camsim_jpeg_err *)cinfo->err;
+  longjmp(err->jump, 1);
+}
+
+static void jpeg_silent(j_common_ptr, int) {}
+
+bool camsim_jpeg_decode(const uint8_t *src, size_t len, int scale_denom, std::vector<uint8_t> &rgb, int *w, int *h) {
+  jpeg_decompress_struct cinfo;
+  camsim_jpeg_err jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error_exit;
+  jerr.pub.emit_message = jpeg_silent;
+  if (setjmp(jerr.jump)) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, (unsigned char *)src, (unsigned long)len);
+  if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  cinfo.out_color_space = JCS_RGB;
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = scale_denom;
+  jpeg_start_decompress(&cinfo);
+  *w = cinfo.output_width;
+  *h = cinfo.output_height;
+  size_t stride = (size_t)cinfo.output_width * 3;
+  rgb.resize(stride * cinfo.output_height);
+  while (cinfo.output_scanline < cinfo.output_height) {
+    JSAMPROW row = rgb.data() + stride * cinfo.output_scanline;
+    jpeg_read_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+
+bool camsim_jpeg_encode(const uint8_t *rgb, int w, int h, int quality, std::vector<uint8_t> &out) {
+  jpeg_compress_struct cinfo;
+  camsim_jpeg_err jerr;
+  unsigned char *mem = NULL;
+  unsigned long mem_len = 0;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error_exit;
+  if (setjmp(jerr.jump)) {
+    jpeg_destroy_compress(&cinfo);
+    free(mem);
+    return false;
+  }
+  jpeg_create_compress(&cinfo);
+  jpeg_mem_dest(&cinfo, &mem, &mem_len);
+  cinfo.image_width = w;
+  cinfo.image_height = h;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, quality, TRUE);
+  jpeg_start_compress(&cinfo, TRUE);
+  size_t stride = (size_t)w * 3;
+  while (cinfo.next_scanline < cinfo.image_height) {
+    JSAMPROW row = (JSAMPROW)(rgb + stride * cinfo.next_scanline);
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  out.assign(mem, mem + mem_len);
+  jpeg_destroy_compress(&cinfo);
+  free(mem);
+  return true;
+}
+
+// ===========================
+// 픽셀 포맷 변환
+// ===========================
+static inline uint8_t clamp8(int v) {
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+bool camsim_to_rgb(const uint8_t *src, size_t len, int w, int h, pixformat_t format, std::vector<uint8_t> &rgb) {
+  size_t n = (size_t)w * h;
+  if (format == PIXFORMAT_JPEG) {
+    int dw, dh;
+    return camsim_jpeg_decode(src, len, 1, rgb, &dw, &dh);
+  }
+  rgb.resize(n * 3);
+  uint8_t *o = rgb.data();
+  switch (format) {
+    case PIXFORMAT_RGB565:
+      if (len < n * 2) {
+        return false;
+      }
+      for (size_t i = 0; i < n; i++) {
+        uint16_t c = (src[i * 2] << 8) | src[i * 2 + 1];
+        o[i * 3 + 0] = (c >> 8) & 0xF8;
+        o[i * 3 + 1] = (c >> 3) & 0xFC;
+        o[i * 3 + 2] = (c << 3) & 0xF8;
+      }
+      return true;
+    case PIXFORMAT_GRAYSCALE:
+      if (len < n) {
+        return false;
+      }
+      for (size_t i = 0; i < n; i++) {
+        o[i * 3 + 0] = o[i * 3 + 1] = o[i * 3 + 2] = src[i];
+      }
+      return true;
+    case PIXFORMAT_RGB888:
+      if (len < n * 3) {
+        return false;
+      }
+      for (size_t i = 0; i < n; i++) {
+        o[i * 3 + 0] = src[i * 3 + 2];
+        o[i * 3 + 1] = src[i * 3 + 1];
+        o[i * 3 + 2] = src[i * 3 + 0];
+      }
+      return true;
+    case PIXFORMAT_YUV422:
+      if (len < n * 2) {
+        return false;
+      }
+      for (size_t i = 0; i + 1 < n; i += 2) {
+        int y0 = src[i * 2], u = src[i * 2 + 1] - 128, y1 = src[i * 2 + 2], v = src[i * 2 + 3] - 128;
+        int ys[2] = {y0, y1};
+        for (int k = 0; k < 2; k++) {
+          o[(i + k) * 3 + 0] = clamp8(ys[k] + ((359 * v) >> 8));
+          o[(i + k) * 3 + 1] = clamp8(ys[k] - ((88 * u + 183 * v) >> 8));
+          o[(i + k) * 3 + 2] = clamp8(ys[k] + ((454 * u) >> 8));
+        }
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool camsim_from_rgb(const uint8_t *rgb, int w, int h, pixformat_t format, std::vector<uint8_t> &out) {
+  size_t n = (size_t)w * h;
+  switch (format) {
+    case PIXFORMAT_RGB565:
+      out.resize(n * 2);
+      for (size_t i = 0; i < n; i++) {
+        uint16_t c = ((rgb[i * 3] & 0xF8) << 8) | ((rgb[i * 3 + 1] & 0xFC) << 3) | (rgb[i * 3 + 2] >> 3);
+        out[i * 2] = c >> 8;
+        out[i * 2 + 1] = c & 0xFF;
+      }
+      return true;
+    case PIXFORMAT_GRAYSCALE:
+      out.resize(n);
+      for (size_t i = 0; i < n; i++) {
+        out[i] = (77 * rgb[i * 3] + 150 * rgb[i * 3 + 1] + 29 * rgb[i * 3 + 2]) >> 8;
+      }
+      return true;
+    case PIXFORMAT_RGB888:
+      out.resize(n * 3);
+      for (size_t i = 0; i < n; i++) {
+        out[i * 3 + 0] = rgb[i * 3 + 2];
+        out[i * 3 + 1] = rgb[i * 3 + 1];
+        out[i * 3 + 2] = rgb[i * 3 + 0];
+      }
+      return true;
+    case PIXFORMAT_YUV422:
+      out.resize(n * 2);
+      for (size_t i = 0; i + 1 < n; i += 2) {
+        const uint8_t *p = rgb + i * 3;
+        int y0 = (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+        int y1 = (77 * p[3] + 150 * p[4] + 29 * p[5]) >> 8;
+        int u = ((-43 * p[0] - 85 * p[1] + 128 * p[2]) >> 8) + 128;
+        int v = ((128 * p[0] - 107 * p[1] - 21 * p[2]) >> 8) + 128;
+        out[i * 2] = y0;
+        out[i * 2 + 1] = clamp8(u);
+        out[i * 2 + 2] = y1;
+        out[i * 2 + 3] = clamp8(v);
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+// ===========================
+// img_converters.h
+// ===========================
+// esp32-camera 의 JPEG 인코더는 1KB 단위로 콜백을 부른다.
+#define JPG_CB_CHUNK 1024
+
+bool fmt2jpg_cb(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, jpg_out_cb cb, void *arg) {
+  std::vector<uint8_t> rgb, jpg;
+  if (format == PIXFORMAT_JPEG || !camsim_to_rgb(src, src_len, width, height, format, rgb)) {
+    return false;
+  }
+  if (!camsim_jpeg_encode(rgb.data(), width, height, quality, jpg)) {
+    return false;
+  }
+  for (size_t index = 0; index < jpg.size(); index += JPG_CB_CHUNK) {
+    size_t n = jpg.size() - index < JPG_CB_CHUNK ? jpg.size() - index : JPG_CB_CHUNK;
+    if (cb(arg, index, jpg.data() + index, n) != n) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool frame2jpg_cb(camera_fb_t *fb, uint8_t quality, jpg_out_cb cb, void *arg) {
+  return fmt2jpg_cb(fb->buf, fb->len, fb->width, fb->height, fb->format, quality, cb, arg);
+}
+
+bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, uint8_t **out, size_t *out_len) {
+  std::vector<uint8_t> rgb, jpg;
+  if (format == PIXFORMAT_JPEG || !camsim_to_rgb(src, src_len, width, height, format, rgb)) {
+    return false;
+  }
+  if (!camsim_jpeg_encode(rgb.data(), width, height, quality, jpg)) {
+    return false;
+  }
+  *out = (uint8_t *)malloc(jpg.size());
+  if (!*out) {
+    return false;
+  }
+  memcpy(*out, jpg.data(), jpg.size());
+  *out_len = jpg.size();
+  return true;
+}
+
+bool frame2jpg(camera_fb_t *fb, uint8_t quality, uint8_t **out, size_t *out_len) {
+  return fmt2jpg(fb->buf, fb->len, fb->width, fb->height, fb->format, quality, out, out_len);
+}
+
+#define BMP_HEADER_LEN 54
+
+typedef struct {
+  uint32_t filesize;
+  uint32_t reserved;
+  uint32_t fileoffset_to_pixelarray;
+  uint32_t dibheadersize;
+  int32_t width;
+  int32_t height;
+  uint16_t planes;
+  uint16_t bitsperpixel;
+  uint32_t compression;
+  uint32_t imagesize;
+  uint32_t ypixelpermeter;
+  uint32_t xpixelpermeter;
+  uint32_t numcolorspallette;
+  uint32_t mostimpcolor;
+} __attribute__((packed)) bmp_header_t;
+
+bool fmt2bmp(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t **out, size_t *out_len) {
+  size_t pix_count = (size_t)width * height;
+  size_t out_size = pix_count * 3 + BMP_HEADER_LEN;
+  uint8_t *out_buf = (uint8_t *)malloc(out_size);
+  if (!out_buf) {
+    return false;
+  }
+  out_buf[0] = 'B';
+  out_buf[1] = 'M';
+  bmp_header_t *bitmap = (bmp_header_t *)&out_buf[2];
+  bitmap->reserved = 0;
+  bitmap->filesize = out_size;
+  bitmap->fileoffset_to_pixelarray = BMP_HEADER_LEN;
+  bitmap->dibheadersize = 40;
+  bitmap->width = width;
+  bitmap->height = -height;  // 위에서 아래로 저장
+  bitmap->planes = 1;
+  bitmap->bitsperpixel = 24;
+  bitmap->compression = 0;
+  bitmap->imagesize = pix_count * 3;
+  bitmap->ypixelpermeter = 0x0B13;
+  bitmap->xpixelpermeter = 0x0B13;
+  bitmap->numcolorspallette = 0;
+  bitmap->mostimpcolor = 0;
+
+  if (!fmt2rgb888(src, src_len, format, out_buf + BMP_HEADER_LEN)) {
+    free(out_buf);
+    return false;
+  }
+  *out = out_buf;
+  *out_len = out_size;
+  return true;
+}
+
+bool frame2bmp(camera_fb_t *fb, uint8_t **out, size_t *out_len) {
+  return fmt2bmp(fb->buf, fb->len, fb->width, fb->height, fb->format, out, out_len);
+}
+
+// 호출자가 크기를 알고 버퍼를 잡았다고 가정한다 (esp32-camera 와 같음).
+bool fmt2rgb888(const uint8_t *src_buf, size_t src_len, pixformat_t format, uint8_t *rgb_buf) {
+  std::vector<uint8_t> rgb;
+  int w = 0, h = 0;
+  if (format == PIXFORMAT_JPEG) {
+    if (!camsim_jpeg_decode(src_buf, src_len, 1, rgb, &w, &h)) {
+      return false;
+    }
+  } else {
+    // 원시 포맷은 크기 정보가 없으므로 바이트 단위로 변환한다.
+    size_t bpp = format == PIXFORMAT_GRAYSCALE ? 1 : (format == PIXFORMAT_RGB888 ? 3 : 2);
+    if (!camsim_to_rgb(src_buf, src_len, (int)(src_len / bpp), 1, format, rgb)) {
+      return false;
+    }
+  }
+  size_t n = rgb.size() / 3;
+  for (size_t i = 0; i < n; i++) {
+    rgb_buf[i * 3 + 0] = rgb[i * 3 + 2];
+    rgb_buf[i * 3 + 1] = rgb[i * 3 + 1];
+    rgb_buf[i * 3 + 2] = rgb[i * 3 + 0];
+  }
+  return true;
+}
+
+bool jpg2rgb565(const uint8_t *src, size_t src_len, uint8_t *out, jpg_scale_t scale) {
+  std::vector<uint8_t> rgb, rgb565;
+  int w = 0, h = 0;
+  if (!camsim_jpeg_decode(src, src_len, 1 << scale, rgb, &w, &h)) {
+    return false;
+  }
+  camsim_from_rgb(rgb.data(), w, h, PIXFORMAT_RGB565, rgb565);
+  memcpy(out, rgb565.data(), rgb565.size());
+  return true;
+}
+
+// ===========================
+// esp_jpg_decode.h
+// ===========================
+#define JPG_MCU 16
+
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void *arg) {
+  std::vector<uint8_t> src(len);
+  if (reader(arg, 0, src.data(), len) != len) {
+    return ESP_FAIL;
+  }
+  std::vector<uint8_t> rgb;
+  int w = 0, h = 0;
+  if (!camsim_jpeg_decode(src.data(), len, 1 << scale, rgb, &w, &h)) {
+    return ESP_FAIL;
+  }
+  writer(arg, 0, 0, w, h, NULL);
+  uint8_t block[JPG_MCU * JPG_MCU * 3];
+  for (int y = 0; y < h; y += JPG_MCU) {
+    for (int x = 0; x < w; x += JPG_MCU) {
+      int bw = w - x < JPG_MCU ? w - x : JPG_MCU;
+      int bh = h - y < JPG_MCU ? h - y : JPG_MCU;
+      for (int r = 0; r < bh; r++) {
+        memcpy(block + r * bw * 3, rgb.data() + ((size_t)(y + r) * w + x) * 3, bw * 3);
+      }
+      if (!writer(arg, x, y, bw, bh, block)) {
+        return ESP_FAIL;
+      }
+    }
+  }
+  writer(arg, w, h, w, h, NULL);
+  return ESP_OK;
+}
@@ -0,0 +1,208 @@
+// GPIO 출력과 RMT 수신 드라이버의 호스트용 가짜 구현
+// RMT 수신이 걸린 핀에서 1ms 이상의 LOW 뒤에 선을 놓으면 DHT22 가 응답한 것처럼
+// 센서 트레이스 값을 40 비트 펄스로 만들어, 실제 프레임 길이만큼 지난 뒤 수신 완료 콜백을 부른다.
+#include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "esp_timer.h"
+#include "camsim.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define DHT_START_MIN_US 1000
+
+struct rmt_channel_t {
+  gpio_num_t gpio;
+  uint32_t resolution_hz;
+  size_t mem_symbols;
+  rmt_rx_done_callback_t on_recv_done;
+  void *user_ctx;
+  bool enabled;
+  rmt_symbol_word_t *buf;  // rmt_receive 로 건 버퍼 (NULL: 대기 중인 수신 없음)
+  size_t buf_symbols;
+  unsigned gen;            // 수신을 끊으면 증가해, 이미 떠난 응답 스레드가 버퍼를 건드리지 않게 함
+};
+
+static std::mutex s_lock;
+static std::map<gpio_num_t, int64_t> s_low_since;  // 핀별 LOW 를 시작한 시각
+static std::vector<rmt_channel_t *> s_channels;
+
+// DHT22 가 보내는 펄스 (레벨, us). 선을 놓은 뒤 20~40us 후 응답, 80us LOW/80us HIGH, 40 비트, 끝의 50us LOW.
+static void dht_waveform(float temperature, float humidity, std::vector<std::pair<int, uint32_t>> &pulses) {
+  uint16_t h10 = (uint16_t)lroundf(humidity * 10);
+  int t10 = (int)lroundf(temperature * 10);
+  uint16_t t_raw = t10 < 0 ? (uint16_t)(0x8000 | -t10) : (uint16_t)t10;
+  uint8_t data[5] = {(uint8_t)(h10 >> 8), (uint8_t)h10, (uint8_t)(t_raw >> 8), (uint8_t)t_raw, 0};
+  data[4] = data[0] + data[1] + data[2] + data[3];
+
+  pulses.push_back({1, 30});
+  pulses.push_back({0, 80});
+  pulses.push_back({1, 80});
+  for (int b = 0; b < 40; b++) {
+    pulses.push_back({0, 50});
+    pulses.push_back({1, (data[b / 8] & (0x80 >> (b % 8))) ? 70u : 27u});
+  }
+  pulses.push_back({0, 50});
+}
+
+static void dht_respond(rmt_channel_t *ch, unsigned gen, camsim_sensor_sample s) {
+  pthread_setname_np(pthread_self(), "dht_sim");
+  if (isnan(s.temperature) || isnan(s.humidity)) {
+    return;  // 센서가 응답하지 않음 -> 수신 대기가 시간 초과로 끝난다
+  }
+  std::vector<std::pair<int, uint32_t>> pulses;
+  dht_waveform(s.temperature, s.humidity, pulses);
+  uint32_t total_us = 0;
+  for (auto &p : pulses) {
+    total_us += p.second;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(total_us));
+
+  std::unique_lock<std::mutex> lock(s_lock);
+  if (ch->gen != gen || !ch->buf) {
+    return;
+  }
+  // RMT 는 (level0, duration0, level1, duration1) 쌍으로 기록하고, 끝의 HIGH 유휴 구간은 길이 0 으로 닫는다.
+  size_t n = 0;
+  for (size_t i = 0; i < pulses.size() && n < ch->buf_symbols; i += 2) {
+    rmt_symbol_word_t sym;
+    sym.val = 0;
+    sym.level0 = pulses[i].first;
+    sym.duration0 = pulses[i].second * (ch->resolution_hz / 1000000);
+    sym.level1 = !pulses[i].first;
+    sym.duration1 = i + 1 < pulses.size() ? pulses[i + 1].second * (ch->resolution_hz / 1000000) : 0;
+    ch->buf[n++] = sym;
+  }
+  rmt_rx_done_event_data_t evt = {ch->buf, n};
+  ch->buf = NULL;
+  rmt_rx_done_callback_t cb = ch->on_recv_done;
+  void *ctx = ch->user_ctx;
+  lock.unlock();
+  if (cb) {
+    cb(ch, &evt, ctx);
+  }
+}
+
+// ===========================
+// GPIO
+// ===========================
+extern "C" esp_err_t gpio_set_direction(gpio_num_t, gpio_mode_t) {
+  return ESP_OK;
+}
+
+extern "C" esp_err_t gpio_pullup_en(gpio_num_t) {
+  return ESP_OK;
+}
+
+extern "C" esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  int64_t now = esp_timer_get_time();
+  if (!level) {
+    s_low_since.emplace(gpio_num, now);
+    return ESP_OK;
+  }
+  auto it = s_low_since.find(gpio_num);
+  if (it == s_low_since.end()) {
+    return ESP_OK;
+  }
+  bool start_signal = now - it->second >= DHT_START_MIN_US;
+  s_low_since.erase(it);
+  if (!start_signal) {
+    return ESP_OK;
+  }
+  for (rmt_channel_t *ch : s_channels) {
+    if (ch->gpio == gpio_num && ch->enabled && ch->buf) {
+      std::thread(dht_respond, ch, ch->gen, camsim_sensor_at((uint32_t)(now / 1000))).detach();
+    }
+  }
+  return ESP_OK;
+}
+
+extern "C" int gpio_get_level(gpio_num_t gpio_num) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  return s_low_since.count(gpio_num) ? 0 : 1;
+}
+
+// ===========================
+// RMT 수신
+// ===========================
+extern "C" esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+  if (!config || !ret_chan || config->resolution_hz < 1000000) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  rmt_channel_t *ch = new rmt_channel_t();
+  ch->gpio = config->gpio_num;
+  ch->resolution_hz = config->resolution_hz;
+  ch->mem_symbols = config->mem_block_symbols;
+  std::lock_guard<std::mutex> lock(s_lock);
+  s_channels.push_back(ch);
+  *ret_chan = ch;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t rx_channel, const rmt_rx_event_callbacks_t *cbs,
+                                                     void *user_data) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (rx_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  rx_channel->on_recv_done = cbs->on_recv_done;
+  rx_channel->user_ctx = user_data;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  channel->enabled = true;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (!channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  channel->enabled = false;
+  channel->buf = NULL;
+  channel->gen++;
+  return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  for (auto it = s_channels.begin(); it != s_channels.end(); ++it) {
+    if (*it == channel) {
+      s_channels.erase(it);
+      break;
+    }
+  }
+  // 떠난 응답 스레드가 있을 수 있으므로 채널 메모리는 돌려주지 않는다.
+  return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_receive(rmt_channel_handle_t rx_channel, void *buffer, size_t buffer_size,
+                                 const rmt_receive_config_t *) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  if (!rx_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  size_t n = buffer_size / sizeof(rmt_symbol_word_t);
+  if (n > rx_channel->mem_symbols) {
+    n = rx_channel->mem_symbols;  // DMA 없는 채널은 채널 메모리 크기까지만 받는다.
+  }
+  rx_channel->buf = (rmt_symbol_word_t *)buffer;
+  rx_channel->buf_symbols = n;
+  return ESP_OK;
+}
@@ -0,0 +1,141 @@
+// 호스트 시뮬레이션 진입점: Arduino 코어처럼 loopTask 에서 setup() 한 번, loop() 를 반복 호출한다.
+// loop() 가 vTaskDelete(NULL) 로 loopTask 를 끝내도 다른 태스크는 --duration 까지 계속 돈다.
+#include "Arduino.h"
+#include "camsim.h"
+#include "esp_system.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+static void loop_task(void *) {
+  setup();
+  for (;;) {
+    loop();
+  }
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --frames DIR       replay *.jpg files in DIR (default: synthetic pattern)\n"
+          "  --sensors FILE     DHT/flame trace, lines of \"ms temperature humidity flame\"\n"
+          "  --port-offset N    added to every httpd port (default %d: 80 -> %d)\n"
+          "  --fps N            sensor frame rate up to SVGA (default %d)\n"
+          "  --sensor NAME      ov2640 | ov3660 | ov5640 (default ov2640)\n"
+          "  --pixformat NAME   jpeg | rgb565 | yuv422 | grayscale | rgb888 (default: sketch setting)\n"
+          "  --sccb-us N        cost of one SCCB register access (default %d)\n"
+          "  --wifi-ms N        WiFi association delay (default %d)\n"
+          "  --wifi-scan-ms N   channel scan before association, skipped for a known AP (default %d)\n"
+          "  --dhcp-ms N        DHCP delay, skipped with a static IP (default %d)\n"
+          "  --wifi-channel N   AP channel (default %d)\n"
+          "  --nvs FILE         persist Preferences (NVS) in FILE across runs\n"
+          "  --reset-reason R   poweron | sw | panic | wdt | brownout (default poweron)\n"
+          "  --no-psram         behave like a board without PSRAM\n"
+          "  --duration S       exit after S seconds (default: run forever)\n",
+          prog, g_camsim.port_offset, 80 + g_camsim.port_offset, g_camsim.fps, g_camsim.sccb_us,
+          g_camsim.wifi_assoc_ms, g_camsim.wifi_scan_ms, g_camsim.dhcp_ms, g_camsim.wifi_channel);
+  exit(2);
+}
+
+static void parse_args(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!strcmp(a, "--no-psram")) {
+      g_camsim.psram = false;
+      continue;
+    }
+    if (!v) {
+      usage(argv[0]);
+    }
+    if (!strcmp(a, "--frames")) {
+      g_camsim.frames_dir = v;
+    } else if (!strcmp(a, "--sensors")) {
+      g_camsim.sensor_trace = v;
+    } else if (!strcmp(a, "--port-offset")) {
+      g_camsim.port_offset = atoi(v);
+    } else if (!strcmp(a, "--fps")) {
+      g_camsim.fps = atoi(v);
+    } else if (!strcmp(a, "--sensor")) {
+      if (!strcmp(v, "ov2640")) {
+        g_camsim.sensor_pid = OV2640_PID;
+      } else if (!strcmp(v, "ov3660")) {
+        g_camsim.sensor_pid = OV3660_PID;
+      } else if (!strcmp(v, "ov5640")) {
+        g_camsim.sensor_pid = OV5640_PID;
+      } else {
+        usage(argv[0]);
+      }
+    } else if (!strcmp(a, "--pixformat")) {
+      static const struct { const char *name; pixformat_t format; } formats[] = {
+        {"jpeg", PIXFORMAT_JPEG}, {"rgb565", PIXFORMAT_RGB565}, {"yuv422", PIXFORMAT_YUV422},
+        {"grayscale", PIXFORMAT_GRAYSCALE}, {"rgb888", PIXFORMAT_RGB888},
+      };
+      for (const auto &f : formats) {
+        if (!strcmp(v, f.name)) {
+          g_camsim.pixformat = f.format;
+        }
+      }
+      if (g_camsim.pixformat < 0) {
+        usage(argv[0]);
+      }
+    } else if (!strcmp(a, "--sccb-us")) {
+      g_camsim.sccb_us = atoi(v);
+    } else if (!strcmp(a, "--wifi-ms")) {
+      g_camsim.wifi_assoc_ms = atoi(v);
+    } else if (!strcmp(a, "--wifi-scan-ms")) {
+      g_camsim.wifi_scan_ms = atoi(v);
+    } else if (!strcmp(a, "--dhcp-ms")) {
+      g_camsim.dhcp_ms = atoi(v);
+    } else if (!strcmp(a, "--wifi-channel")) {
+      g_camsim.wifi_channel = atoi(v);
+    } else if (!strcmp(a, "--nvs")) {
+      g_camsim.nvs_path = v;
+    } else if (!strcmp(a, "--reset-reason")) {
+      static const char *const reasons[] = {"poweron", "sw", "panic", "wdt", "brownout"};
+      static const int values[] = {ESP_RST_POWERON, ESP_RST_SW, ESP_RST_PANIC, ESP_RST_TASK_WDT, ESP_RST_BROWNOUT};
+      int found = -1;
+      for (int k = 0; k < 5; k++) {
+        if (!strcmp(v, reasons[k])) {
+          found = values[k];
+        }
+      }
+      if (found < 0) {
+        usage(argv[0]);
+      }
+      g_camsim.reset_reason = found;
+    } else if (!strcmp(a, "--duration")) {
+      g_camsim.duration_s = atof(v);
+    } else {
+      usage(argv[0]);
+    }
+    i++;
+  }
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+  signal(SIGPIPE, SIG_IGN);
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  if (g_camsim.sensor_trace) {
+    camsim_sensor_trace_load(g_camsim.sensor_trace);
+  }
+
+  xTaskCreatePinnedToCore(loop_task, "loopTask", 8192, NULL, 1, NULL, 1);
+  if (g_camsim.duration_s > 0) {
+    delay((uint32_t)(g_camsim.duration_s * 1000));
+  } else {
+    for (;;) {
+      pause();
+    }
+  }
+  // 다른 태스크 스레드가 아직 돌고 있으므로 정적 객체(조건 변수 등) 소멸자를 부르지 않고 끝낸다.
+  fflush(stdout);
+  _exit(0);
+}
@@ -0,0 +1,3 @@
+// Arduino 빌더가 .ino 앞에 Arduino.h 를 붙여 C++ 로 컴파일하는 것과 같은 방식으로 스케치를 포함한다.
+#include <Arduino.h>
+#include "CameraWebServer.ino"
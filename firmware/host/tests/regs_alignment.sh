@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# /regs 의 작업 버퍼는 쿼리 길이에 따라 잡힌다. 길이가 홀수/짝수인 쿼리를 모두 보내 reg_op_t 가
+# 정렬되지 않은 주소에 놓이지 않는지 본다 (camsim 은 정렬되지 않은 접근에서 멈춘다).
+set -u
+CAMSIM=$1
+OFFSET=${CAMSIM_TEST_PORT_OFFSET:-9300}
+PORT=$((80 + OFFSET))
+
+"$CAMSIM" --port-offset "$OFFSET" --duration 30 > /dev/null 2>&1 &
+PID=$!
+trap 'kill $PID 2> /dev/null; wait $PID 2> /dev/null' EXIT
+
+# GET 한 번의 상태 줄을 출력한다.
+get() {
+  exec 3<> "/dev/tcp/127.0.0.1/$PORT" || return 1
+  printf 'GET %s HTTP/1.1\r\nHost: camsim\r\nConnection: close\r\n\r\n' "$1" >&3
+  head -n 1 <&3 | tr -d '\r'
+  exec 3<&-
+}
+
+for i in $(seq 50); do
+  get /status > /dev/null 2>&1 && break
+  sleep 0.1
+done
+
+fail=0
+for q in "read=0x308" "read=0x3008" "read=0x3008,0x3009" "read=0x3008,0x309" \
+         "write=0xff:0xff:1" "write=0xff:0xff:12" "write=0xff:0xff:1&read=0x3008" "write=0xff:0xff:12&read=0x3008"; do
+  status=$(get "/regs?$q" 2> /dev/null)
+  if [[ $status != "HTTP/1.1 200"* ]]; then
+    echo "FAIL /regs?$q (query length ${#q}): ${status:-no response}"
+    fail=1
+  fi
+done
+if ! kill -0 $PID 2> /dev/null; then
+  echo "FAIL camsim exited"
+  fail=1
+fi
+[ $fail = 0 ] && echo "ok"
+exit $fail
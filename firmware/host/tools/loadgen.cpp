@@ -0,0 +1,439 @@
+// camsim 부하 생성기
+//
+// /stream 클라이언트 N 개를 동시에 열어 T 초 동안 받은 멀티파트 프레임 수와 바이트 수를 센다.
+// 클라이언트별 fps 와 합계를 출력하므로 브로드캐스터의 팬아웃 비용을 비교할 수 있다.
+// --ws 를 주면 /ws 에 WebSocket 으로 접속해 프레임/센서 메시지를 센다. 두 방식 모두 캡처 시각을
+// 읽어 프레임 지연 분위수를 함께 출력한다.
+// --poll 을 주면 그동안 제어 서버의 URI 하나를 keep-alive 연결로 주기적으로 요청해
+// 응답 지연의 분위수(p50/p90/p99/max)를 출력한다. /flame 을 폴링하면 불꽃 에지가 일어난 뒤
+// 처음 응답에 보이기까지 걸린 시간도 함께 출력한다.
+//
+//   camsim_loadgen --streams 4 --duration 10 --poll /flame
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PART_BOUNDARY "--123456789000000000000987654321"
+
+struct options {
+  std::string host = "127.0.0.1";
+  int port = 8080;         // 제어 서버 (보드의 80)
+  int stream_port = 8081;  // 스트림 서버 (보드의 81)
+  std::string stream_path = "/stream";
+  int streams = 1;
+  int duration_s = 10;
+  bool ws = false;         // --ws: /ws 로 접속해 WebSocket 메시지를 센다
+  int rate_kbps = 0;       // 스트림 클라이언트별 수신 속도 제한 (0: 제한 없음)
+  std::string poll_path;   // 비어 있으면 폴링하지 않음
+  int poll_ms = 50;
+};
+
+struct stream_result {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  uint64_t sensors = 0;         // WebSocket 센서 패킷 수
+  std::vector<int64_t> delays;  // 프레임을 다 받은 시각 - 캡처 시각 (시계 기준점은 다름)
+  bool connected = false;
+};
+
+static std::atomic<bool> g_stop(false);
+
+static int connect_to(const options &opt, int port, int rcvbuf = 0) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (rcvbuf > 0) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  }
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr);
+  if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  struct timeval tv = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+static int64_t now_us(void) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// HTTP 응답 헤더를 건너뛰고, 청크 인코딩이면 풀어서 본문만 넘긴다.
+struct body_reader {
+  std::string head;
+  bool in_body = false;
+  bool chunked = false;
+  size_t chunk_left = 0;
+  std::string size_line;
+  bool skip_crlf = false;
+
+  // 본문 바이트를 out 에 덧붙인다.
+  void feed(const char *p, size_t n, std::string &out) {
+    if (!in_body) {
+      head.append(p, n);
+      size_t end = head.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        return;
+      }
+      in_body = true;
+      chunked = strcasestr(head.substr(0, end).c_str(), "Transfer-Encoding: chunked") != NULL;
+      std::string rest = head.substr(end + 4);
+      head.clear();
+      feed(rest.data(), rest.size(), out);
+      return;
+    }
+    if (!chunked) {
+      out.append(p, n);
+      return;
+    }
+    for (size_t i = 0; i < n;) {
+      if (chunk_left > 0) {
+        size_t k = std::min(chunk_left, n - i);
+        out.append(p + i, k);
+        chunk_left -= k;
+        i += k;
+        skip_crlf = chunk_left == 0;
+        continue;
+      }
+      char c = p[i++];
+      if (skip_crlf) {
+        skip_crlf = c != '\n';
+        continue;
+      }
+      if (c == '\n') {
+        chunk_left = strtoul(size_line.c_str(), NULL, 16);
+        size_line.clear();
+      } else if (c != '\r') {
+        size_line += c;
+      }
+    }
+  }
+};
+
+static int64_t parse_le64(const std::string &b, size_t off) {
+  int64_t v = 0;
+  for (int i = 7; i >= 0; i--) {
+    v = v << 8 | (uint8_t)b[off + i];
+  }
+  return v;
+}
+
+static void stream_client(const options &opt, stream_result *res) {
+  // 속도를 제한할 때는 수신 버퍼도 작게 잡아야 커널 버퍼가 혼잡을 가리지 않는다.
+  int fd = connect_to(opt, opt.stream_port, opt.rate_kbps > 0 ? 8192 : 0);
+  if (fd < 0) {
+    return;
+  }
+  std::string req = "GET " + opt.stream_path + " HTTP/1.1\r\nHost: " + opt.host + "\r\n";
+  if (opt.ws) {
+    req += "Upgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+           "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n";
+  }
+  req += "\r\n";
+  send(fd, req.data(), req.size(), 0);
+  res->connected = true;
+
+  body_reader reader;
+  std::string body;
+  // 멀티파트: 파트 헤더를 찾은 뒤 Content-Length 만큼 건너뛴다. WebSocket: 메시지 길이만큼 건너뛴다.
+  size_t part_left = 0;
+  bool in_part = false;
+  int64_t part_ts = 0;
+  std::string msg_head;  // WebSocket 메시지 앞부분 (종류, 순번, 캡처 시각)
+
+  char buf[16384];
+  size_t chunk = opt.rate_kbps > 0 ? 1460 : sizeof(buf);
+  int64_t start = now_us();
+  while (!g_stop) {
+    if (opt.rate_kbps > 0) {
+      // 지금까지 받은 양이 제한 속도를 넘으면 그만큼 쉰다 (느린 WiFi 링크 흉내).
+      int64_t due = start + (int64_t)(res->bytes * 8 * 1000 / opt.rate_kbps);
+      int64_t wait = due - now_us();
+      if (wait > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(wait));
+      }
+    }
+    ssize_t n = recv(fd, buf, chunk, 0);
+    if (n == 0) {
+      break;
+    }
+    if (n < 0) {
+      continue;  // 수신 시간 초과: 정지 플래그 확인
+    }
+    res->bytes += n;
+    reader.feed(buf, n, body);
+
+    for (;;) {
+      if (in_part) {
+        size_t k = std::min(part_left, body.size());
+        if (opt.ws && msg_head.size() < 16) {
+          msg_head.append(body, 0, std::min(k, 16 - msg_head.size()));
+        }
+        body.erase(0, k);
+        part_left -= k;
+        if (part_left > 0) {
+          break;
+        }
+        in_part = false;
+        if (opt.ws) {
+          if (msg_head.size() >= 16 && msg_head[0] == 0x01) {
+            part_ts = parse_le64(msg_head, 8);
+          } else {
+            if (!msg_head.empty() && msg_head[0] == 0x02) {
+              res->sensors++;
+            }
+            continue;
+          }
+        }
+        res->frames++;
+        res->delays.push_back(now_us() - part_ts);
+        continue;
+      }
+      if (opt.ws) {
+        if (body.size() < 2) {
+          break;
+        }
+        size_t len = (uint8_t)body[1] & 0x7F, hlen = 2;
+        if (len == 126) {
+          hlen = 4;
+        } else if (len == 127) {
+          hlen = 10;
+        }
+        if (body.size() < hlen) {
+          break;
+        }
+        if (hlen > 2) {
+          len = 0;
+          for (size_t i = 2; i < hlen; i++) {
+            len = len << 8 | (uint8_t)body[i];
+          }
+        }
+        body.erase(0, hlen);
+        msg_head.clear();
+        part_left = len;
+        in_part = true;
+        continue;
+      }
+      size_t hdr = body.find(PART_BOUNDARY);
+      size_t end = hdr == std::string::npos ? hdr : body.find("\r\n\r\n", hdr);
+      if (end == std::string::npos) {
+        break;
+      }
+      std::string part_hdr = body.substr(hdr, end - hdr);
+      const char *cl = strcasestr(part_hdr.c_str(), "Content-Length:");
+      const char *ts = strcasestr(part_hdr.c_str(), "X-Timestamp:");
+      part_left = cl ? strtoul(cl + 15, NULL, 10) : 0;
+      part_ts = ts ? (int64_t)(strtod(ts + 12, NULL) * 1000000) : 0;
+      body.erase(0, end + 4);
+      in_part = true;
+    }
+  }
+  close(fd);
+}
+
+// 응답 하나(헤더 + Content-Length 만큼의 본문)를 끝까지 읽는다. 실패하면 false.
+static bool read_response(int fd, std::string &inbuf, std::string *body_out = NULL) {
+  for (;;) {
+    size_t hdr_end = inbuf.find("\r\n\r\n");
+    if (hdr_end != std::string::npos) {
+      size_t body = 0;
+      size_t cl = inbuf.find("Content-Length:");
+      if (cl != std::string::npos && cl < hdr_end) {
+        body = strtoul(inbuf.c_str() + cl + 15, NULL, 10);
+      }
+      if (inbuf.size() >= hdr_end + 4 + body) {
+        if (body_out) {
+          body_out->assign(inbuf, hdr_end + 4, body);
+        }
+        inbuf.erase(0, hdr_end + 4 + body);
+        return true;
+      }
+    }
+    char buf[4096];
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      return false;
+    }
+    inbuf.append(buf, n);
+  }
+}
+
+static long long json_int(const std::string &body, const char *key) {
+  size_t at = body.find(key);
+  return at == std::string::npos ? -1 : strtoll(body.c_str() + at + strlen(key), NULL, 10);
+}
+
+// /flame 응답이면 새 에지(seq 증가)가 처음 보인 응답에서 에지가 몇 us 전에 일어났는지 기록한다.
+// 보드 시계(now_us - last_edge_us)만 쓰므로 호스트와 시계를 맞출 필요가 없다.
+static void track_flame_edge(const std::string &body, long long *last_seq, std::vector<int64_t> *ages) {
+  long long seq = json_int(body, "\"seq\":");
+  long long edge = json_int(body, "\"last_edge_us\":");
+  long long now = json_int(body, "\"now_us\":");
+  if (seq < 0 || edge < 0 || now < 0) {
+    return;
+  }
+  if (*last_seq >= 0 && seq > *last_seq) {
+    ages->push_back(now - edge);
+  }
+  *last_seq = seq;
+}
+
+static void poll_client(const options &opt, std::vector<int64_t> *latencies, std::vector<int64_t> *edge_ages,
+                        int *failures) {
+  int fd = -1;
+  std::string inbuf, body;
+  long long flame_seq = -1;
+  std::string req = "GET " + opt.poll_path + " HTTP/1.1\r\nHost: " + opt.host + "\r\n\r\n";
+  int64_t next = now_us();
+  while (!g_stop) {
+    if (fd < 0) {
+      fd = connect_to(opt, opt.port);
+      inbuf.clear();
+    }
+    int64_t start = now_us();
+    if (fd < 0 || send(fd, req.data(), req.size(), 0) < 0 || !read_response(fd, inbuf, &body)) {
+      (*failures)++;
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    } else {
+      latencies->push_back(now_us() - start);
+      track_flame_edge(body, &flame_seq, edge_ages);
+    }
+    next += opt.poll_ms * 1000;
+    int64_t wait = next - now_us();
+    if (wait > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(wait));
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+static double percentile_ms(std::vector<int64_t> &v, double p) {
+  size_t i = std::min(v.size() - 1, (size_t)(p / 100.0 * v.size()));
+  return v[i] / 1000.0;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--host H] [--port P] [--stream-port P] [--path /stream] [--streams N]\n"
+          "          [--duration S] [--ws] [--rate-kbps N] [--poll URI] [--poll-ms MS]\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  options opt;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+    if (a == "--host" && v) {
+      opt.host = v, i++;
+    } else if (a == "--port" && v) {
+      opt.port = atoi(v), i++;
+    } else if (a == "--stream-port" && v) {
+      opt.stream_port = atoi(v), i++;
+    } else if (a == "--ws") {
+      opt.ws = true;
+      if (opt.stream_path == "/stream") {
+        opt.stream_path = "/ws";
+      }
+    } else if (a == "--rate-kbps" && v) {
+      opt.rate_kbps = atoi(v), i++;
+    } else if (a == "--poll" && v) {
+      opt.poll_path = v, i++;
+    } else if (a == "--poll-ms" && v) {
+      opt.poll_ms = atoi(v), i++;
+    } else if (a == "--path" && v) {
+      opt.stream_path = v, i++;
+    } else if (a == "--streams" && v) {
+      opt.streams = atoi(v), i++;
+    } else if (a == "--duration" && v) {
+      opt.duration_s = atoi(v), i++;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<stream_result> results(opt.streams);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < opt.streams; i++) {
+    threads.emplace_back(stream_client, std::cref(opt), &results[i]);
+  }
+  std::vector<int64_t> latencies, edge_ages;
+  int poll_failures = 0;
+  if (!opt.poll_path.empty()) {
+    // 스트림이 자리를 잡은 뒤부터 잰다.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    threads.emplace_back(poll_client, std::cref(opt), &latencies, &edge_ages, &poll_failures);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(opt.duration_s));
+  g_stop = true;
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  uint64_t total_frames = 0, total_bytes = 0;
+  std::vector<int64_t> delays;
+  for (int i = 0; i < opt.streams; i++) {
+    const stream_result &r = results[i];
+    printf("stream %d: %s%llu frames, %.1f fps, %.1f KB/s", i, r.connected ? "" : "(connect failed) ",
+           (unsigned long long)r.frames, (double)r.frames / opt.duration_s, r.bytes / 1024.0 / opt.duration_s);
+    if (opt.ws) {
+      printf(", %llu sensor packets", (unsigned long long)r.sensors);
+    }
+    printf("\n");
+    total_frames += r.frames;
+    total_bytes += r.bytes;
+    delays.insert(delays.end(), r.delays.begin(), r.delays.end());
+  }
+  printf("total: %d streams, %.1f fps, %.1f KB/s\n", opt.streams, (double)total_frames / opt.duration_s,
+         total_bytes / 1024.0 / opt.duration_s);
+  if (!delays.empty()) {
+    // 캡처 시각은 보드 가동 시간 기준이라 절대 지연은 모른다. 가장 빨리 도착한 프레임을 0 으로 둔
+    // 상대 지연(캡처 후 다 받기까지 더 걸린 시간)을 출력한다.
+    std::sort(delays.begin(), delays.end());
+    int64_t base = delays.front();
+    for (auto &d : delays) {
+      d -= base;
+    }
+    printf("frame delay over fastest: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           percentile_ms(delays, 50), percentile_ms(delays, 90), percentile_ms(delays, 99), delays.back() / 1000.0);
+  }
+  if (!opt.poll_path.empty()) {
+    if (latencies.empty()) {
+      printf("poll %s: no responses, %d failures\n", opt.poll_path.c_str(), poll_failures);
+      return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    printf("poll %s: %zu requests, %d failures, p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           opt.poll_path.c_str(), latencies.size(), poll_failures, percentile_ms(latencies, 50),
+           percentile_ms(latencies, 90), percentile_ms(latencies, 99), latencies.back() / 1000.0);
+  }
+  if (!edge_ages.empty()) {
+    std::sort(edge_ages.begin(), edge_ages.end());
+    printf("flame edge -> visible: %zu edges, p50 %.2f ms, max %.2f ms\n", edge_ages.size(),
+           percentile_ms(edge_ages, 50), edge_ages.back() / 1000.0);
+  }
+  return 0;
+}